@@ -0,0 +1,85 @@
+#pragma once
+
+/* Host-Stub: Teilmenge von driver/uart.h (ohne Treiber, nur Konfiguration und ISR) */
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef int uart_port_t;
+
+#define UART_NUM_0 0
+#define UART_NUM_1 1
+#define UART_NUM_2 2
+#define UART_NUM_MAX 3
+
+#define UART_PIN_NO_CHANGE (-1)
+
+#define UART_INTR_RXFIFO_FULL (0x1 << 0)
+#define UART_INTR_TXFIFO_EMPTY (0x1 << 1)
+#define UART_INTR_PARITY_ERR (0x1 << 2)
+#define UART_INTR_FRAM_ERR (0x1 << 3)
+#define UART_INTR_RXFIFO_OVF (0x1 << 4)
+#define UART_INTR_RXFIFO_TOUT (0x1 << 8)
+
+typedef enum
+{
+    UART_DATA_5_BITS,
+    UART_DATA_6_BITS,
+    UART_DATA_7_BITS,
+    UART_DATA_8_BITS,
+} uart_word_length_t;
+
+typedef enum
+{
+    UART_PARITY_DISABLE = 0,
+    UART_PARITY_EVEN = 2,
+    UART_PARITY_ODD = 3,
+} uart_parity_t;
+
+typedef enum
+{
+    UART_STOP_BITS_1 = 1,
+    UART_STOP_BITS_1_5 = 2,
+    UART_STOP_BITS_2 = 3,
+} uart_stop_bits_t;
+
+typedef enum
+{
+    UART_HW_FLOWCTRL_DISABLE = 0,
+} uart_hw_flowcontrol_t;
+
+typedef enum
+{
+    UART_SCLK_APB = 0,
+    UART_SCLK_REF_TICK,
+} uart_sclk_t;
+
+typedef struct
+{
+    int baud_rate;
+    uart_word_length_t data_bits;
+    uart_parity_t parity;
+    uart_stop_bits_t stop_bits;
+    uart_hw_flowcontrol_t flow_ctrl;
+    uint8_t rx_flow_ctrl_thresh;
+    uart_sclk_t source_clk;
+} uart_config_t;
+
+typedef struct
+{
+    uint32_t intr_enable_mask;
+    uint8_t rx_timeout_thresh;
+    uint8_t txfifo_empty_intr_thresh;
+    uint8_t rxfifo_full_thresh;
+} uart_intr_config_t;
+
+typedef void *uart_isr_handle_t;
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config);
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num);
+esp_err_t uart_intr_config(uart_port_t uart_num, const uart_intr_config_t *intr_conf);
+esp_err_t uart_enable_intr_mask(uart_port_t uart_num, uint32_t enable_mask);
+esp_err_t uart_disable_intr_mask(uart_port_t uart_num, uint32_t disable_mask);
+esp_err_t uart_clear_intr_status(uart_port_t uart_num, uint32_t clr_mask);
+esp_err_t uart_isr_register(uart_port_t uart_num, void (*fn)(void *), void *arg,
+                            int intr_alloc_flags, uart_isr_handle_t *handle);
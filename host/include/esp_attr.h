@@ -0,0 +1,9 @@
+#pragma once
+
+/* Host-Stub: Linker-Attribute haben auf dem Host keine Bedeutung */
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define DMA_ATTR
+#define WORD_ALIGNED_ATTR __attribute__((aligned(4)))
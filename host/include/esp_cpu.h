@@ -0,0 +1,21 @@
+#pragma once
+
+/* Host-Stub: Zyklenzähler, hier der TSC (x86) bzw. Nanosekunden */
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint32_t esp_cpu_get_ccount(void)
+{
+    return (uint32_t)__rdtsc();
+}
+#else
+static inline uint32_t esp_cpu_get_ccount(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+/* Host-Stub: FreeRTOS-Typen mit der Konfiguration aus sdkconfig */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define configTICK_RATE_HZ 100
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+
+#define pdMS_TO_TICKS(xTimeInMs) \
+    ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+
+/* Kein Scheduler auf dem Host: ISRs laufen synchron im Simulator */
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+/* Spinlock zwischen ISR und Task auf dem anderen Core, auf dem Host ohne Wirkung */
+typedef struct
+{
+    int owner;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
@@ -0,0 +1,12 @@
+#pragma once
+
+/* Host-Stub: Mutex ohne Scheduler, ein Take auf einen belegten Mutex ist ein Fehler */
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct SemaphoreDefinition *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
@@ -0,0 +1,30 @@
+#pragma once
+
+/*
+ * Host-Stub: Tick-Zähler und Delay laufen gegen die virtuelle Uhr.
+ *
+ * Tasks sind Koroutinen mit eigenem Stack. Ein Task läuft, sobald er
+ * erzeugt oder per xTaskNotifyGive() geweckt wird, und gibt die Kontrolle
+ * erst in ulTaskNotifyTake() zurück – wie ein Task höherer Priorität auf
+ * dem anderen Kern, nur ohne echte Parallelität.
+ */
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct tskTaskControlBlock *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(const TickType_t xTicksToDelay);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char *pcName,
+                                   const uint32_t usStackDepth, void *pvParameters,
+                                   UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask,
+                                   const BaseType_t xCoreID);
+
+/* Nur portMAX_DELAY oder 0 als Timeout */
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+
+/* Bytes wie bei ESP-IDF; für NULL (Hauptprogramm) 0 */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask);
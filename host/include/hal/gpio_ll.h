@@ -0,0 +1,20 @@
+#pragma once
+
+/* Host-Stub: GPIO-Low-Level-Zugriffe, wie auf dem Target ISR-tauglich */
+
+#include "driver/gpio.h"
+
+typedef struct gpio_dev_s gpio_dev_t;
+extern gpio_dev_t GPIO;
+
+static inline void gpio_ll_set_intr_type(gpio_dev_t *hw, gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    (void)hw;
+    gpio_set_intr_type(gpio_num, intr_type);
+}
+
+static inline int gpio_ll_get_level(gpio_dev_t *hw, gpio_num_t gpio_num)
+{
+    (void)hw;
+    return gpio_get_level(gpio_num);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+/* Host-Stub: UART-Low-Level-Zugriffe auf das simulierte RX-FIFO (sim_hal.c) */
+
+#include <stdint.h>
+#include "driver/uart.h"
+
+typedef struct sim_uart_dev uart_dev_t;
+
+uart_dev_t *sim_uart_hw(int num);
+
+#define UART_LL_GET_HW(num) sim_uart_hw(num)
+
+uint32_t uart_ll_get_rxfifo_len(uart_dev_t *hw);
+void uart_ll_read_rxfifo(uart_dev_t *hw, uint8_t *buf, uint32_t rd_len);
+uint32_t uart_ll_get_intsts_mask(uart_dev_t *hw);
+void uart_ll_clr_intsts_mask(uart_dev_t *hw, uint32_t mask);
+void uart_ll_rxfifo_rst(uart_dev_t *hw);
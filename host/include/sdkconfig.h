@@ -0,0 +1,9 @@
+#pragma once
+
+/* Host-Stub: die für main/ relevanten Werte aus sdkconfig */
+
+#define CONFIG_FREERTOS_HZ 100
+#define CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ 160
+#define CONFIG_PM_ENABLE 1
+#define CONFIG_FREERTOS_USE_TICKLESS_IDLE 1
+#define CONFIG_FREERTOS_IDLE_TIME_BEFORE_SLEEP 3
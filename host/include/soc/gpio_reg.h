@@ -0,0 +1,7 @@
+#pragma once
+
+/* Host-Stub: Adressen wie im ESP32-TRM, gelesen über sim_reg_read() */
+
+#define DR_REG_GPIO_BASE 0x3ff44000
+#define GPIO_IN_REG (DR_REG_GPIO_BASE + 0x003c)  // GPIO0-31
+#define GPIO_IN1_REG (DR_REG_GPIO_BASE + 0x0040) // GPIO32-39, Bits 0-7
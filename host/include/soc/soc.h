@@ -0,0 +1,9 @@
+#pragma once
+
+/* Host-Stub: Registerzugriffe gehen an den Simulator */
+
+#include <stdint.h>
+
+uint32_t sim_reg_read(uint32_t addr);
+
+#define REG_READ(_r) sim_reg_read((uint32_t)(_r))
@@ -0,0 +1,2468 @@
+/*
+ * playbox_sim - Host-Simulation von main/playbox.c
+ *
+ * Linkt die unveränderten Mode-Handler, den Sequenzer und den Orb-Code gegen
+ * sim_hal.c und treibt die Hauptschleife mit einer virtuellen Uhr an.
+ *
+ *   playbox_sim [-v] [--load US] [--poll MS] [songs|session|quiz|synth|idle|bounce|library|midiin|notes|voices|record|players|analog|profile|boot|bench]
+ *               [--script FILE] [--wav FILE] [--trace FILE] [--lib FILE] [--bytes FILE] [--json FILE]
+ *               [--rec FILE] [--rec-out FILE]
+ *
+ *   songs    spielt alle Tabellen aus songs.c und misst Tonlängenfehler
+ *   session  geskriptete Tastendrücke durch alle Modi, misst Latenz
+ *   quiz     Quizmaster-Arbitrierung mit injizierten Zeitstempeln
+ *   synth    Akkord, Basslinie und Effekte auf dem DAC-Synth mischen
+ *   idle     eine Minute Leerlauf im IDLE_MODE, für den Energiebericht
+ *   bounce   prellende Tastendrücke und Störimpulse gegen den Entprerller
+ *   library  alle Einträge der Liederbibliothek abspielen, gepackte und
+ *            als SMF erzeugte Lieder gegen ihre Tabelle in songs.c prüfen
+ *   midiin   MIDI-Parser mit Byte-Strömen prüfen, dann live über den
+ *            simulierten UART spielen und Note-On-bis-Ton messen
+ *   notes    Timer-Tabelle aller 128 MIDI-Noten gegen die gleichstufige
+ *            Tonhöhe und den alten 10-Bit-Weg, jede Note über PlayTone()
+ *            spielen und die Kosten des Tonwechsels berichten
+ *   voices   Prioritätsklassen des Sequenzers: Warten, Verdrängen und
+ *            Fortsetzen, Anhängen; jede Note auf 1 ms genau geprüft
+ *   record   BeepMode-Session aufnehmen, nach NVS schreiben und zurücklesen,
+ *            im IDLE_MODE wiedergeben und gegen die Live-Töne prüfen, dann
+ *            die Aufnahme als Eingabe-Trace erneut spielen
+ *   players  acht Spieler mit Schieberegister-Kette: Quiz-Runden mit
+ *            Gleichständen, Gewinnerton und LEDs, Ketten-Buzzer im BeepMode
+ *            samt Aufnahme, SPI-Abtastung nur in den Spieler-Modi
+ *   analog   Filterkette mit synthetischen Signalen prüfen, dann die
+ *            Abtastung mit verrauschten ADC-Werten laufen lassen
+ *   profile  Session mit dem Laufzeit-Profiler, Zähler gegen die Messungen
+ *            des Simulators prüfen, dann Bericht per Feuertaster-Griff
+ *   boot     Startphasen: erster Ton des Startsongs im Budget, RGB-LEDs und
+ *            ADC erst mit dem ersten Mode, der sie braucht
+ *   bench    Regressionslauf: alle Lieder und eine Session pro Mode,
+ *            Timing, Aussetzer, Latenz und CPU-Kosten als JSON; Exit-Code
+ *            1, wenn eine BENCH_*-Schwelle gerissen wird
+ *   --wav    Mixer-Ausgabe des synth-Szenarios als WAV schreiben
+ *   --script Zeilen "<ms> <gpio> <hold_ms>" statt der eingebauten Session
+ *   --trace  aufgezeichnete Pegel "<us> <gpio> <level>" im bounce-Szenario
+ *            abspielen statt der eingebauten Prellmuster
+ *   --load   zusätzliche virtuelle Rechenzeit pro Schleifendurchlauf (µs),
+ *            z.B. für langsame Handler oder Log-Ausgaben
+ *   --poll   Schleife alle MS Millisekunden statt ereignisgesteuert
+ *            (playbox_wait) durchlaufen, wie die alte 10-ms-Superloop
+ *   --lib    Image für die songs-Partition (tools/songlib.py) statt des
+ *            beim Build erzeugten
+ *   --bytes  roher MIDI-Bytestrom für das midiin-Szenario: dekodiert
+ *            ausgeben und über den UART abspielen
+ *   --json   Ergebnis des bench-Szenarios in diese Datei statt auf stdout
+ *   --rec    Aufnahme-Image (recorder.h, tools/recdump.py) als Eingabe des
+ *            record-Szenarios statt der eingebauten Session
+ *   --rec-out Image der Live-Aufnahme des record-Szenarios schreiben
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "playbox.h"
+#include "songs_packed.h"
+#include "input.h"
+#include "synth.h"
+#include "audio.h"
+#include "led.h"
+#include "songlib.h"
+#include "midi_parser.h"
+#include "midi_in.h"
+#include "analog.h"
+#include "profiler.h"
+#include "note_timer.h"
+#include "dlog.h"
+#include "smf.h"
+#include "recorder.h"
+#include "chain.h"
+#include "boot.h"
+#include "envelope.h"
+#include "sim_hal.h"
+
+#define SIM_SONG_START_OFFSET_US 3700
+#define SIM_NOTE_CENTS 1.0 // so nah muss eine gespielte Note an ihrer Tonhöhe liegen
+#define SIM_PACK_CENTS (5.0 + SIM_NOTE_CENTS) // songpack.py legt bis 5 Cent auf die Note (Default)
+#define SIM_IDLE_MS 60000
+#define SIM_LATENCY_US 1000 // Taster bis Ton: die ISR meldet die erste Flanke sofort
+
+/* Stromaufnahme ESP32 laut Datenblatt (grob): aktiv 160 MHz / Light Sleep */
+#define SIM_ACTIVE_MA 30.0
+#define SIM_LIGHT_SLEEP_MA 0.8
+
+typedef struct
+{
+    const char *name;
+    const tone_step_t *steps; // Original aus songs.c als Referenz
+    const int *len;
+    const song_t *packed;     // was der Sequenzer tatsächlich spielt
+} sim_song_t;
+
+static const sim_song_t sim_songs[] = {
+    {"beep_mode_tones", beep_mode_tones, &beep_mode_len, &beep_mode_tones_song},
+    {"midi_mode_tones", midi_mode_tones, &midi_mode_len, &midi_mode_tones_song},
+    {"quizmaster_mode_tones", quizmaster_mode_tones, &quizmaster_mode_len, &quizmaster_mode_tones_song},
+    {"tonleiter_mode_tones", tonleiter_mode_tones, &tonleiter_mode_len, &tonleiter_mode_tones_song},
+    {"boot_sequence", boot_sequence, &boot_sequence_len, &boot_sequence_song},
+    {"boot_sequence_fancy", boot_sequence_fancy, &boot_sequence_fancy_len, &boot_sequence_fancy_song},
+    {"boot_sequence_fancy2", boot_sequence_fancy2, &boot_sequence_fancy2_len, &boot_sequence_fancy2_song},
+    {"boot_sequence_short", boot_sequence_short, &boot_sequence_short_len, &boot_sequence_short_song},
+    {"win95_boot", win95_boot, &win95_boot_len, &win95_boot_song},
+    {"win95_speak_boot", win95_speak_boot, &win95_speak_boot_len, &win95_speak_boot_song},
+    {"win95_true_boot", win95_true_boot, &win95_true_boot_len, &win95_true_boot_song},
+    {"custom_boot", custom_boot, &custom_boot_len, &custom_boot_song},
+    {"ode_an_die_freude", ode_an_die_freude, &ode_an_die_freude_len, &ode_an_die_freude_song},
+    {"melody_happy_birthday", melody_happy_birthday, &melody_happy_birthday_len, &melody_happy_birthday_song},
+    {"melody_hallelujah_motif", melody_hallelujah_motif, &melody_hallelujah_motif_len, &melody_hallelujah_motif_song},
+    {"alle_meine_entchen", alle_meine_entchen, &alle_meine_entchen_len, &alle_meine_entchen_song},
+};
+
+#define SIM_SONG_COUNT (int)(sizeof(sim_songs) / sizeof(sim_songs[0]))
+
+/* ===================== Schleifenkosten ===================== */
+
+static struct
+{
+    uint64_t loops;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} loop_cost;
+
+static uint32_t sim_load_us = 0;
+static uint32_t sim_poll_ms = 0; // 0 = ereignisgesteuert
+
+static uint64_t host_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Hauptschleife wie in app_main(), aber für @ms virtuelle Millisekunden */
+static void sim_run_ms(uint32_t ms)
+{
+    uint64_t end_us = sim_now_us() + (uint64_t)ms * 1000;
+
+    while (sim_now_us() < end_us)
+    {
+        uint64_t t0 = host_ns();
+        playbox_loop_once();
+        uint64_t dt = host_ns() - t0;
+
+        sim_advance_us(sim_load_us);
+
+        loop_cost.loops++;
+        loop_cost.total_ns += dt;
+        if (dt > loop_cost.max_ns)
+            loop_cost.max_ns = dt;
+
+        if (sim_now_us() >= end_us)
+            break;
+
+        TickType_t left = pdMS_TO_TICKS((end_us - sim_now_us() + 999) / 1000);
+        if (sim_poll_ms)
+            input_wait(pdMS_TO_TICKS(sim_poll_ms));
+        else
+            playbox_wait(left ? left : 1);
+    }
+}
+
+/* Gleichstufige Frequenz einer MIDI-Note, A4 = 69 = 440 Hz */
+static double note_freq(int note)
+{
+    return 440.0 * pow(2.0, (note - 69) / 12.0);
+}
+
+/* Abstand zweier Frequenzen in Cent, ohne Vorzeichen */
+static double pitch_cents(double hz, double ref_hz)
+{
+    return fabs(1200.0 * log2(hz / ref_hz));
+}
+
+static uint32_t song_length_ms(const tone_step_t *steps, int len)
+{
+    uint32_t total = 0;
+    for (int i = 0; i < len; i++)
+        total += steps[i].duration_ms;
+    return total;
+}
+
+/* ===================== Szenario: songs ===================== */
+
+#define SIM_TRUNCATED_US 1000 // so viel kürzer als geplant: Schritt abgeschnitten
+
+/* Gespielte Noten eines Lieds gegen seine Tabelle */
+typedef struct
+{
+    int notes;     // Töne laut Tabelle (ohne Pausen)
+    int played;    // am Buzzer angekommen
+    int compared;
+    int truncated; // deutlich kürzer als geplant
+    int64_t sum_abs_us;
+    int64_t max_abs_us;
+    double max_cents;
+} song_result_t;
+
+/* Noten ab sim_notes()[@first] mit @steps vergleichen, Pausen (0 Hz) klingen nicht */
+static void song_compare(const tone_step_t *steps, int len, int first, song_result_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    r->played = sim_note_count() - first;
+
+    for (int i = 0; i < len; i++)
+    {
+        if (steps[i].freq_hz == 0)
+            continue;
+
+        r->notes++;
+        if (r->compared >= r->played)
+            continue;
+
+        const sim_note_t *n = &sim_notes()[first + r->compared++];
+        int64_t actual = (int64_t)(n->end_us - n->start_us);
+        int64_t err = actual - (int64_t)steps[i].duration_ms * 1000;
+        int64_t abs_err = err < 0 ? -err : err;
+
+        r->sum_abs_us += abs_err;
+        if (abs_err > r->max_abs_us)
+            r->max_abs_us = abs_err;
+        if (err < -SIM_TRUNCATED_US)
+            r->truncated++;
+
+        double cents = pitch_cents(n->freq_hz, steps[i].freq_hz);
+        if (cents > r->max_cents)
+            r->max_cents = cents;
+    }
+}
+
+/* Lied wie nach einem Tastendruck starten und ganz ausspielen */
+static void song_play(const sim_song_t *song, song_result_t *r)
+{
+    int first = sim_note_count();
+
+    // Start irgendwo zwischen zwei Ticks
+    sim_advance_us(SIM_SONG_START_OFFSET_US);
+
+    StopToneSequence(SEQ_PRIO_MUSIC);
+    PlayToneSequence(SEQ_PRIO_MUSIC, song->packed);
+    sim_run_ms(2 * song_length_ms(song->steps, *song->len) + 500);
+
+    song_compare(song->steps, *song->len, first, r);
+}
+
+static void run_songs(void)
+{
+    // Startsong ausklingen lassen
+    sim_run_ms(song_length_ms(win95_true_boot, win95_true_boot_len) + 500);
+
+    printf("%-26s %5s %6s %9s %9s %7s %9s\n",
+           "song", "notes", "played", "mean_err", "max_err", "pitch", "bytes");
+
+    for (int s = 0; s < SIM_SONG_COUNT; s++)
+    {
+        const sim_song_t *song = &sim_songs[s];
+        song_result_t r;
+
+        song_play(song, &r);
+
+        printf("%-26s %5d %6d %7.2fms %7.2fms %6.1fc %4u/%4u\n",
+               song->name, r.notes, r.played,
+               r.compared ? (double)r.sum_abs_us / r.compared / 1000.0 : 0.0,
+               (double)r.max_abs_us / 1000.0, r.max_cents,
+               (unsigned)(song->packed->words * 2), (unsigned)(*song->len * sizeof(tone_step_t)));
+    }
+
+    const tone_timing_t *tt = Tone_timing_stats();
+    printf("sequencer boundaries: n=%u mean=%.1fus max=%lldus\n",
+           tt->boundaries,
+           tt->boundaries ? (double)tt->total_abs_err_us / tt->boundaries : 0.0,
+           (long long)tt->max_abs_err_us);
+    // Duty-Sprünge am Buzzer, die keine Rampe sind: Knackser
+    printf("buzzer clicks: %u\n", sim_buzzer_clicks());
+}
+
+/* ===================== Szenario: session ===================== */
+
+static void schedule_session(uint64_t t0)
+{
+    const gpio_num_t beep_pins[10] = {
+        IN_P1_TOP_PIN, IN_P1_DOWN_PIN, IN_P1_LEFT_PIN, IN_P1_RIGHT_PIN, IN_P1_FIRE_PIN,
+        IN_P2_TOP_PIN, IN_P2_DOWN_PIN, IN_P2_LEFT_PIN, IN_P2_RIGHT_PIN, IN_P2_FIRE_PIN};
+
+    uint64_t t = t0;
+
+    // IDLE -> BEEP
+    sim_press(t, IN_LED_PIN, 80, true);
+    t += 1000000;
+
+    // Alle Noten einmal, Abstand 333 ms (nicht auf den Loop-Takt ausgerichtet)
+    for (int i = 0; i < 10; i++)
+    {
+        sim_press(t, beep_pins[i], 60, true);
+        t += 333000;
+    }
+
+    // Kurzer Tipp (5 ms) zwischen zwei Loop-Durchläufen
+    sim_press(t + 2000, IN_P1_FIRE_PIN, 5, true);
+    t += 1000000;
+
+    // BEEP -> MIDI, vor und zurück
+    sim_press(t, IN_LED_PIN, 80, true);
+    t += 1000000;
+    sim_press(t, IN_P1_RIGHT_PIN, 80, true);
+    t += 1500000;
+    sim_press(t, IN_P1_LEFT_PIN, 80, true);
+    t += 1500000;
+
+    // MIDI -> QUIZMASTER, beide Spieler fast gleichzeitig
+    sim_press(t, IN_LED_PIN, 80, true);
+    t += 1000000;
+    sim_press(t + 4000, IN_P2_TOP_PIN, 200, true);
+    sim_press(t + 6000, IN_P1_TOP_PIN, 200, false);
+    t += 2000000;
+
+    // QUIZMASTER -> TONLEITER -> IDLE
+    sim_press(t, IN_LED_PIN, 80, true);
+    t += 1000000;
+    sim_press(t, IN_LED_PIN, 80, false);
+}
+
+static int load_script(const char *path, uint64_t t0)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        perror(path);
+        return -1;
+    }
+
+    char line[128];
+    while (fgets(line, sizeof(line), f))
+    {
+        unsigned long ms, hold;
+        int pin;
+
+        if (line[0] == '#')
+            continue;
+        if (sscanf(line, "%lu %d %lu", &ms, &pin, &hold) == 3)
+            sim_press(t0 + (uint64_t)ms * 1000, (gpio_num_t)pin, (uint32_t)hold, true);
+    }
+
+    fclose(f);
+    return 0;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Gibt die größte Latenz zurück, 0 ohne Messung */
+static uint64_t report_latency(void)
+{
+    const sim_latency_t *lat = sim_latency();
+    uint64_t sorted[SIM_MAX_LATENCIES];
+    uint64_t sum = 0;
+
+    memcpy(sorted, lat->latency_us, (size_t)lat->count * sizeof(uint64_t));
+    qsort(sorted, (size_t)lat->count, sizeof(uint64_t), cmp_u64);
+    for (int i = 0; i < lat->count; i++)
+        sum += sorted[i];
+
+    printf("input-to-sound: n=%d missed=%d", lat->count, lat->missed);
+    if (lat->count > 0)
+    {
+        printf(" mean=%.3fms p50=%.3fms max=%.3fms",
+               (double)sum / lat->count / 1000.0,
+               (double)sorted[lat->count / 2] / 1000.0,
+               (double)sorted[lat->count - 1] / 1000.0);
+    }
+    printf("\n");
+    return lat->count > 0 ? sorted[lat->count - 1] : 0;
+}
+
+static int run_session(const char *script)
+{
+    uint64_t t0 = sim_now_us() + 3000000; // nach dem Startsong
+
+    if (script)
+    {
+        if (load_script(script, t0) != 0)
+            exit(1);
+    }
+    else
+    {
+        schedule_session(t0);
+    }
+
+    sim_run_ms(3000 + 20000);
+
+    printf("notes played: %d\n", sim_note_count());
+    uint64_t max_lat = report_latency();
+    return sim_latency()->missed || max_lat >= SIM_LATENCY_US;
+}
+
+/* LEDC-Zugriffe pro Sekunde: Maß für die CPU-Last der Beleuchtung */
+static void report_leds(void)
+{
+    double s = (double)sim_now_us() / 1e6;
+
+    printf("leds: writes=%u (%.1f/s) fade_conflicts=%u\n",
+           led_writes(), s > 0 ? led_writes() / s : 0.0, sim_ledc_fade_conflicts());
+}
+
+/* ===================== Szenario: quiz ===================== */
+
+typedef struct
+{
+    const char *name;
+    int64_t p1_us;  // < 0: Spieler drückt nicht
+    int64_t p2_us;
+    bool p2_first;  // Einreichungsreihenfolge umdrehen
+    int expect_winner;
+    quiz_result_t expect_second;
+} quiz_case_t;
+
+static int run_quiz(void)
+{
+    static const quiz_case_t cases[] = {
+        {"p1 clearly first", 1000, 9000, false, 0, QUIZ_LATE},
+        {"p2 first, same loop pass", 6000, 4000, false, 1, QUIZ_FIRST},
+        {"p2 first, reported late", 5000, 4990, false, 1, QUIZ_FIRST},
+        {"tie, reported out of order", 2000, 2000 + QUIZ_TIE_WINDOW_US, true, 0, QUIZ_FIRST},
+        {"tie inside window", 2000, 2000 + QUIZ_TIE_WINDOW_US, false, 0, QUIZ_TIE},
+        {"just outside window", 2000, 2001 + QUIZ_TIE_WINDOW_US, false, 0, QUIZ_LATE},
+        {"only p2", -1, 700, false, 1, QUIZ_FIRST},
+    };
+    int failed = 0;
+    quiz_arbiter_t arb;
+
+    quiz_arbiter_init(&arb, QUIZ_TIE_WINDOW_US);
+
+    // 1) Arbiter direkt mit injizierten Zeitstempeln
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        const quiz_case_t *c = &cases[i];
+        int order[2] = {c->p2_first ? 1 : 0, c->p2_first ? 0 : 1};
+        int64_t t[2] = {c->p1_us, c->p2_us};
+        quiz_result_t last = QUIZ_IGNORED;
+
+        quiz_arbiter_reset(&arb);
+        for (int k = 0; k < 2; k++)
+        {
+            if (t[order[k]] >= 0)
+                last = quiz_submit(&arb, order[k], t[order[k]]);
+        }
+
+        bool ok = quiz_winner(&arb) == c->expect_winner && last == c->expect_second;
+        failed += !ok;
+        printf("%-28s winner=P%d margin=%6lldus tie=%d %s\n",
+               c->name, quiz_winner(&arb) + 1, (long long)arb.stats.last_margin_us,
+               arb.tie, ok ? "ok" : "FAIL");
+    }
+
+    quiz_arbiter_reset(&arb); // letzte Runde abschließen
+    printf("stats: rounds=%u ties=%u wins=P1:%u P2:%u min_margin=%lldus\n",
+           arb.stats.rounds, arb.stats.ties, arb.stats.wins[0], arb.stats.wins[1],
+           (long long)arb.stats.min_margin_us);
+
+    // P1 und P3 fast gleichzeitig, dann P2 davor zugestellt: der vorläufige
+    // Abstand P1 -> P3 hat es nie gegeben, min_margin ist P2 -> P1
+    quiz_arbiter_init(&arb, QUIZ_TIE_WINDOW_US);
+    quiz_submit(&arb, 0, 5000);
+    quiz_submit(&arb, 2, 5003);
+    quiz_submit(&arb, 1, 4990);
+    quiz_arbiter_reset(&arb);
+    bool ok = arb.stats.min_margin_us == 10;
+    failed += !ok;
+    printf("reordered round: min_margin=%lldus %s\n", (long long)arb.stats.min_margin_us, ok ? "ok" : "FAIL");
+
+    // 2) Über GPIO-ISR und Hauptschleife: P2 drückt 2 ms vor P1
+    uint64_t t = sim_now_us() + 3000000;
+    for (int m = 0; m < QUIZMASTER_MODE; m++)
+        sim_press(t + (uint64_t)m * 1000000, IN_LED_PIN, 80, false);
+    t += (uint64_t)QUIZMASTER_MODE * 1000000 + 1000000;
+    sim_press(t + 4000, IN_P2_TOP_PIN, 200, false);
+    sim_press(t + 6000, IN_P1_TOP_PIN, 200, false);
+
+    sim_run_ms((uint32_t)((t - sim_now_us()) / 1000) + 500);
+
+    const quiz_stats_t *st = Quizmaster_stats();
+    ok = st->last_winner == 1 && st->last_margin_us == 2000;
+    failed += !ok;
+    printf("live: winner=P%d margin=%lldus %s\n",
+           st->last_winner + 1, (long long)st->last_margin_us, ok ? "ok" : "FAIL");
+
+    return failed;
+}
+
+/* ===================== Szenario: idle ===================== */
+
+static void run_idle(void)
+{
+    sim_run_ms(3000); // Startsong ausklingen lassen
+    sim_power_reset();
+    loop_cost.loops = 0;
+    sim_run_ms(SIM_IDLE_MS);
+}
+
+/* ===================== Szenario: bounce ===================== */
+
+#define SIM_BOUNCE_PRESSES 10
+#define SIM_BOUNCE_WINDOW_US 50000 // Ton muss so bald nach dem Druck kommen
+
+/* Buzzer-Töne, die in [from_us, from_us + SIM_BOUNCE_WINDOW_US) beginnen */
+static int notes_after(uint64_t from_us)
+{
+    const sim_note_t *notes = sim_notes();
+    int n = 0;
+
+    for (int i = 0; i < sim_note_count(); i++)
+        n += notes[i].start_us >= from_us && notes[i].start_us < from_us + SIM_BOUNCE_WINDOW_US;
+    return n;
+}
+
+static int load_trace(const char *path, uint64_t t0)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        perror(path);
+        return -1;
+    }
+
+    char line[128];
+    while (fgets(line, sizeof(line), f))
+    {
+        unsigned long long us;
+        int pin, level;
+
+        if (line[0] == '#')
+            continue;
+        if (sscanf(line, "%llu %d %d", &us, &pin, &level) == 3)
+            sim_schedule_pin(t0 + us, (gpio_num_t)pin, level);
+    }
+
+    fclose(f);
+    return 0;
+}
+
+static int run_bounce(const char *trace)
+{
+    static const gpio_num_t pins[SIM_BOUNCE_PRESSES] = {
+        IN_P1_TOP_PIN, IN_P1_DOWN_PIN, IN_P1_LEFT_PIN, IN_P1_RIGHT_PIN, IN_P1_FIRE_PIN,
+        IN_P2_TOP_PIN, IN_P2_DOWN_PIN, IN_P2_LEFT_PIN, IN_P2_RIGHT_PIN, IN_P2_FIRE_PIN};
+    uint64_t press_us[SIM_BOUNCE_PRESSES];
+    uint64_t t = sim_now_us() + 3000000; // nach dem Startsong
+    int failed = 0;
+
+    if (trace)
+    {
+        // Aufzeichnung: nur zählen, was der Entpreller daraus macht
+        if (load_trace(trace, t) != 0)
+            exit(1);
+        sim_run_ms(3000 + 10000);
+        printf("bounce: trace edges=%u changes=%u dropped=%u\n",
+               input_stats()->edges, input_stats()->changes, input_stats()->dropped);
+        return 0;
+    }
+
+    // IDLE -> BEEP: ein prellender Druck darf nur einen Mode weiter schalten
+    sim_press_bounce(t, IN_LED_PIN, 80, 4, false);
+    t += 1000000;
+
+    for (int i = 0; i < SIM_BOUNCE_PRESSES; i++)
+    {
+        press_us[i] = t;
+        sim_press_bounce(t, pins[i], 60, 1 + i % 4, true);
+        t += 333000;
+    }
+
+    // Störimpuls: entprellt wird an der ersten Flanke, er zählt also als ein
+    // kurzer Druck; die Sperre lässt ihn danach sauber los
+    uint64_t glitch_us = t;
+    sim_schedule_pin(glitch_us, IN_P1_FIRE_PIN, 0);
+    sim_schedule_pin(glitch_us + 300, IN_P1_FIRE_PIN, 1);
+    t += 500000;
+
+    sim_run_ms((uint32_t)((t - sim_now_us()) / 1000));
+
+    const input_stats_t *st = input_stats();
+    int doubled = 0, missed = 0;
+    for (int i = 0; i < SIM_BOUNCE_PRESSES; i++)
+    {
+        int n = notes_after(press_us[i]);
+        doubled += n > 1;
+        missed += n == 0;
+    }
+    int glitch_notes = notes_after(glitch_us);
+    uint64_t max_lat = report_latency();
+
+    printf("bounce: mode=%d edges=%u changes=%u dropped=%u doubled=%d missed=%d glitch_notes=%d\n",
+           playbox_mode(), st->edges, st->changes, st->dropped, doubled, missed, glitch_notes);
+
+    // Je Druck und für den Störimpuls genau ein Wechsel nach unten und einer nach oben
+    if (playbox_mode() != BEEP_MODE || st->changes != 2 * (SIM_BOUNCE_PRESSES + 2) ||
+        doubled || missed || glitch_notes != 1 || sim_latency()->missed || max_lat >= SIM_LATENCY_US)
+        failed++;
+
+    return failed;
+}
+
+/* ===================== Szenario: library ===================== */
+
+static const sim_song_t *find_song(const char *name, size_t len)
+{
+    for (int s = 0; s < SIM_SONG_COUNT; s++)
+    {
+        if (strlen(sim_songs[s].name) == len && memcmp(sim_songs[s].name, name, len) == 0)
+            return &sim_songs[s];
+    }
+    return NULL;
+}
+
+/* Tonhöhe, wie tools/songlib.py sie im SMF ablegt: nächste MIDI-Note */
+static int nearest_note(uint32_t hz)
+{
+    int best = 1;
+    for (int n = 2; n < 128; n++)
+    {
+        int f = song_note_hz((uint8_t)n);
+        if (abs(f - (int)hz) < abs((int)song_note_hz((uint8_t)best) - (int)hz))
+            best = n;
+    }
+    return best;
+}
+
+static int run_library(void)
+{
+    int failed = 0;
+
+    sim_run_ms(song_length_ms(win95_true_boot, win95_true_boot_len) + 500);
+
+    printf("%-26s %6s %5s %6s %9s %9s %8s\n",
+           "entry", "kind", "notes", "played", "mean_err", "max_err", "pitch");
+
+    for (int id = 0; id < songlib_count(); id++)
+    {
+        songlib_entry_t e;
+
+        if (!songlib_get(id, &e))
+        {
+            printf("entry %d: missing\n", id);
+            failed++;
+            continue;
+        }
+
+        bool smf = e.kind == SONGLIB_KIND_SMF;
+        const sim_song_t *ref = find_song(e.name, e.name_len);
+        uint32_t length_ms = ref ? song_length_ms(ref->steps, *ref->len) : 60000;
+        int first = sim_note_count();
+
+        sim_advance_us(SIM_SONG_START_OFFSET_US);
+        StopToneSequence(SEQ_PRIO_MUSIC);
+        if (smf)
+            PlayMidiFile(SEQ_PRIO_MUSIC, e.data, e.length);
+        else
+            PlayToneSequence(SEQ_PRIO_MUSIC, &(song_t){.data = e.data, .words = (uint16_t)(e.length / 2)});
+        sim_run_ms(2 * length_ms + 500);
+
+        int played = sim_note_count() - first;
+        char name[27];
+        snprintf(name, sizeof(name), "%.*s", (int)e.name_len, e.name);
+
+        if (!ref)
+        {
+            // Eigenes Lied ohne Referenz: nur abspielen
+            printf("%-26s %6s %5s %6d\n", name, smf ? "smf" : "packed", "-", played);
+            continue;
+        }
+
+        int notes = 0;
+        int compared = 0;
+        int wrong_pitch = 0;
+        double max_cents = 0.0;
+        int64_t sum_abs = 0;
+        int64_t max_abs = 0;
+
+        for (int i = 0; i < *ref->len; i++)
+        {
+            const tone_step_t *st = &ref->steps[i];
+            if (st->freq_hz == 0 || st->duration_ms == 0)
+                continue;
+
+            notes++;
+            if (compared >= played)
+                continue;
+
+            const sim_note_t *n = &sim_notes()[first + compared++];
+            int64_t err = (int64_t)(n->end_us - n->start_us) - (int64_t)st->duration_ms * 1000;
+            int64_t abs_err = err < 0 ? -err : err;
+
+            sum_abs += abs_err;
+            if (abs_err > max_abs)
+                max_abs = abs_err;
+
+            // SMF kennt nur MIDI-Noten, gepackte Songs quantisieren auf Cent
+            if (smf)
+            {
+                if (pitch_cents(n->freq_hz, note_freq(nearest_note(st->freq_hz))) > SIM_NOTE_CENTS)
+                    wrong_pitch++;
+            }
+            else
+            {
+                double cents = pitch_cents(n->freq_hz, st->freq_hz);
+                if (cents > max_cents)
+                    max_cents = cents;
+                if (cents > SIM_PACK_CENTS)
+                    wrong_pitch++;
+            }
+        }
+
+        char pitch[16];
+        if (wrong_pitch)
+            snprintf(pitch, sizeof(pitch), "WRONG");
+        else if (smf)
+            snprintf(pitch, sizeof(pitch), "ok");
+        else
+            snprintf(pitch, sizeof(pitch), "%.1fct", max_cents);
+
+        printf("%-26s %6s %5d %6d %7.2fms %7.2fms %8s\n",
+               name, smf ? "smf" : "packed", notes, played,
+               compared ? (double)sum_abs / compared / 1000.0 : 0.0,
+               (double)max_abs / 1000.0, pitch);
+
+        // Exakte Dauern: nur die Sequenzer-Latenz darf abweichen
+        if (played != notes || wrong_pitch || max_abs > 1000)
+            failed++;
+    }
+
+    if (songlib_count() == 0)
+    {
+        printf("empty song library\n");
+        failed++;
+    }
+
+    return failed;
+}
+
+/* ===================== Szenario: midiin ===================== */
+
+#define SIM_MIDI_MAX_MSGS 8
+
+typedef struct
+{
+    const char *name;
+    uint8_t bytes[16];
+    int len;
+    midi_msg_t expect[SIM_MIDI_MAX_MSGS];
+    int count;
+} midi_case_t;
+
+#define ON(ch, n, v) {.type = MIDI_MSG_NOTE_ON, .channel = ch, .note = n, .velocity = v}
+#define OFF(ch, n, v) {.type = MIDI_MSG_NOTE_OFF, .channel = ch, .note = n, .velocity = v}
+#define ALL_OFF(ch) {.type = MIDI_MSG_ALL_OFF, .channel = ch}
+
+static const midi_case_t midi_cases[] = {
+    {"note on/off", {0x90, 60, 100, 0x80, 60, 64}, 6, {ON(0, 60, 100), OFF(0, 60, 64)}, 2},
+    {"running status, vel 0", {0x90, 60, 100, 62, 100, 60, 0, 62, 0}, 9,
+     {ON(0, 60, 100), ON(0, 62, 100), OFF(0, 60, 0), OFF(0, 62, 0)}, 4},
+    {"realtime inside message", {0x90, 0xf8, 60, 0xfe, 100}, 5, {ON(0, 60, 100)}, 1},
+    {"sysex cancels running", {0x90, 60, 100, 0xf0, 0x7e, 0x7f, 0x09, 0x01, 0xf7, 62, 100}, 11,
+     {ON(0, 60, 100)}, 1},
+    {"system common skipped", {0xf2, 0x10, 0x20, 60, 100, 0x91, 64, 80}, 8, {ON(1, 64, 80)}, 1},
+    {"all notes off", {0xb3, 123, 0, 0xb3, 7, 100}, 6, {ALL_OFF(3)}, 1},
+    {"program change", {0xc0, 5, 6, 0x90, 60, 100}, 6, {ON(0, 60, 100)}, 1},
+    {"data without status", {60, 100, 0x9f, 60, 100}, 5, {ON(15, 60, 100)}, 1},
+    {"status interrupts", {0x90, 60, 0x80, 60, 64}, 5, {OFF(0, 60, 64)}, 1},
+};
+
+#undef ON
+#undef OFF
+#undef ALL_OFF
+
+static bool midi_msg_equal(const midi_msg_t *a, const midi_msg_t *b)
+{
+    return a->type == b->type && a->channel == b->channel &&
+           (a->type == MIDI_MSG_ALL_OFF || (a->note == b->note && a->velocity == b->velocity));
+}
+
+static int midi_parser_cases(void)
+{
+    int failed = 0;
+
+    for (size_t c = 0; c < sizeof(midi_cases) / sizeof(midi_cases[0]); c++)
+    {
+        const midi_case_t *mc = &midi_cases[c];
+        midi_parser_t p;
+        midi_msg_t got[SIM_MIDI_MAX_MSGS];
+        int n = 0;
+        bool ok = true;
+
+        midi_parser_init(&p);
+        for (int i = 0; i < mc->len; i++)
+        {
+            midi_msg_t msg;
+            if (!midi_parse(&p, mc->bytes[i], &msg))
+                continue;
+            if (n < SIM_MIDI_MAX_MSGS)
+                got[n] = msg;
+            n++;
+        }
+
+        ok = n == mc->count;
+        for (int i = 0; ok && i < n; i++)
+            ok = midi_msg_equal(&got[i], &mc->expect[i]);
+
+        printf("parser: %-24s %s\n", mc->name, ok ? "ok" : "FAIL");
+        failed += !ok;
+    }
+
+    return failed;
+}
+
+static void midi_print_stream(const uint8_t *data, size_t n)
+{
+    static const char *const names[] = {"on", "off", "all-off"};
+    midi_parser_t p;
+    midi_msg_t msg;
+
+    midi_parser_init(&p);
+    for (size_t i = 0; i < n; i++)
+    {
+        if (midi_parse(&p, data[i], &msg))
+            printf("byte %5zu: %-7s ch=%u note=%u vel=%u\n",
+                   i, names[msg.type], msg.channel + 1, msg.note, msg.velocity);
+    }
+}
+
+/* Eine Note live: Note-On mit Latenzmessung, Note-Off nach @hold_ms */
+static uint64_t midi_send_note(uint64_t t, uint8_t note, uint32_t hold_ms)
+{
+    const uint8_t on[3] = {0x90, note, 100};
+    const uint8_t off[3] = {0x80, note, 0};
+
+    sim_uart_send(t, IN_MIDI_RX_PIN, MIDI_IN_BAUD, on, 3, true);
+    sim_uart_send(t + (uint64_t)hold_ms * 1000, IN_MIDI_RX_PIN, MIDI_IN_BAUD, off, 3, false);
+    return t + (uint64_t)hold_ms * 1000;
+}
+
+static int run_midiin(const char *bytes_path)
+{
+    static const uint8_t scale[8] = {60, 62, 64, 65, 67, 69, 71, 72};
+    int failed = midi_parser_cases();
+    uint8_t *stream = NULL;
+    size_t stream_len = 0;
+
+    if (bytes_path)
+    {
+        FILE *f = fopen(bytes_path, "rb");
+        if (!f)
+        {
+            fprintf(stderr, "cannot open %s\n", bytes_path);
+            return 1;
+        }
+        stream = malloc(64 * 1024);
+        stream_len = fread(stream, 1, 64 * 1024, f);
+        fclose(f);
+        midi_print_stream(stream, stream_len);
+    }
+
+    // IDLE -> BEEP -> MIDI, Intro ausklingen lassen
+    uint64_t t = sim_now_us() + 3000000;
+    sim_press(t, IN_LED_PIN, 80, false);
+    sim_press(t + 500000, IN_LED_PIN, 80, false);
+    sim_run_ms(3000 + 500 + 3000);
+    if (playbox_mode() != MIDI_MODE)
+    {
+        printf("not in MIDI mode\n");
+        return failed + 1;
+    }
+
+    int first = sim_note_count();
+    t = sim_now_us() + 10000;
+
+    // Tonleiter, Abstand nicht auf den Tick ausgerichtet
+    for (int i = 0; i < 8; i++)
+        t = midi_send_note(t, scale[i], 200) + 37000;
+
+    // Akkord mit Running Status: Buzzer folgt der höchsten gehaltenen Note
+    const uint8_t chord_on[5] = {0x90, 60, 100, 67, 100}; // C4, dann G4
+    const uint8_t g_off[3] = {0x90, 67, 0};
+    const uint8_t c_off[3] = {0x80, 60, 0};
+    uint64_t g_on = sim_uart_send(t, IN_MIDI_RX_PIN, MIDI_IN_BAUD, chord_on, 5, true);
+    sim_uart_send(t + 300000, IN_MIDI_RX_PIN, MIDI_IN_BAUD, g_off, 3, false);
+    sim_uart_send(t + 500000, IN_MIDI_RX_PIN, MIDI_IN_BAUD, c_off, 3, false);
+    t += 500000;
+
+    if (stream)
+        t = sim_uart_send(t + 100000, IN_MIDI_RX_PIN, MIDI_IN_BAUD, stream, stream_len, false);
+    free(stream);
+
+    sim_run_ms((uint32_t)((t - sim_now_us()) / 1000) + 1000);
+
+    // Erwartet: 8 Töne der Tonleiter, dann C (kurz), G, C. Note-Off startet
+    // die Release, der Ton klingt also um deren Länge nach
+    const sim_note_t *notes = sim_notes() + first;
+    int played = sim_note_count() - first;
+    int wrong = 0;
+    int64_t release_us = BUZZER_ENV_DEFAULT.release_ms * 1000;
+
+    for (int i = 0; i < 8 && i < played; i++)
+    {
+        int64_t len = (int64_t)(notes[i].end_us - notes[i].start_us);
+        if (pitch_cents(notes[i].freq_hz, note_freq(scale[i])) > SIM_NOTE_CENTS || len < 199000 ||
+            len > 201000 + release_us)
+            wrong++;
+    }
+
+    if (played >= 11)
+    {
+        const sim_note_t *g = &notes[9];
+        const sim_note_t *c = &notes[10];
+        if (pitch_cents(notes[8].freq_hz, note_freq(60)) > SIM_NOTE_CENTS ||
+            pitch_cents(g->freq_hz, note_freq(67)) > SIM_NOTE_CENTS ||
+            pitch_cents(c->freq_hz, note_freq(60)) > SIM_NOTE_CENTS || g->start_us < g_on ||
+            c->start_us < g_on + 299000 || c->end_us > t + release_us + 1000)
+            wrong++;
+    }
+
+    const midi_in_stats_t *st = midi_in_stats();
+    const sim_latency_t *lat = sim_latency();
+    uint64_t max_lat = 0;
+    for (int i = 0; i < lat->count; i++)
+        if (lat->latency_us[i] > max_lat)
+            max_lat = lat->latency_us[i];
+
+    printf("live: notes=%d wrong=%d bytes=%u msgs=%u dropped=%u overflows=%u\n",
+           played, wrong, (unsigned)st->bytes, (unsigned)st->messages,
+           (unsigned)st->dropped, (unsigned)st->overflows);
+    report_latency();
+
+    if ((!bytes_path && played != 11) || wrong || st->dropped || st->overflows ||
+        lat->missed || max_lat >= 1000)
+        failed++;
+
+    return failed;
+}
+
+/* ===================== Szenario: notes ===================== */
+
+/* Was ledc_set_freq() mit fester 10-Bit-Auflösung träfe, 0 ohne gültigen Teiler */
+static double notes_fixed_res_hz(uint32_t hz)
+{
+    uint64_t div = ((uint64_t)NOTE_TIMER_CLK_HZ << 8) / hz / (1u << BUZZER_PWM_RES);
+
+    if (div < NOTE_TIMER_DIV_MIN || div > NOTE_TIMER_DIV_MAX)
+        return 0.0;
+    return (double)NOTE_TIMER_CLK_HZ * 256.0 / ((double)div * (1u << BUZZER_PWM_RES));
+}
+
+static int run_notes(void)
+{
+    const tone_env_t env = BUZZER_ENV_DEFAULT;
+    double worst = 0.0;
+    int unreachable = 0;
+    int played = 0;
+    int wrong = 0;
+    unsigned clicks_total = 0;
+    prof_report_t r;
+
+    // Startsong abbrechen: ein Effekt wartet sonst auf sein Ende
+    sim_run_ms(500);
+    StopToneSequence(SEQ_PRIO_CHIME);
+    sim_run_ms(100);
+    prof_reset();
+
+    printf("%4s %10s %3s %7s %10s %8s %8s %s\n",
+           "note", "exact_hz", "res", "div", "timer_hz", "cents", "10bit", "played");
+
+    for (int n = 0; n < NOTE_TIMER_NOTES; n++)
+    {
+        const note_timer_t *t = &note_timers[n];
+        uint32_t hz = song_note_hz((uint8_t)n);
+        double exact = note_freq(n);
+        double actual = note_timer_millihz(t) / 1000.0;
+        double cents = 1200.0 * log2(actual / exact);
+        double fixed = hz ? notes_fixed_res_hz(hz) : 0.0;
+        char fixed_col[16] = "-";
+        const char *result = "-";
+
+        if (fabs(cents) > worst)
+            worst = fabs(cents);
+        if (fixed > 0.0)
+            snprintf(fixed_col, sizeof(fixed_col), "%+.2f", 1200.0 * log2(fixed / exact));
+        else
+            unreachable++;
+
+        // Gerundete Frequenzen unter ~20 Hz sind mehrdeutig, die tiefere Note gewinnt
+        if (n > 0 && song_hz_note(hz) == n)
+        {
+            int first = sim_note_count();
+
+            // 40 ms, tiefe Töne so lang, dass Attack und Release ganz hineinpassen (env_ramp_us())
+            uint32_t peak = BUZZER_DUTY_MAX << (t->res - BUZZER_PWM_RES); // obere Schranke
+            uint32_t ramps_us = env_ramp_us(env.attack_ms * 1000u, peak, t->hz) +
+                                env_ramp_us(env.release_ms * 1000u, peak, t->hz);
+            uint32_t note_ms = ramps_us > 40000 ? (ramps_us + 999) / 1000 : 40;
+            unsigned clicks = sim_buzzer_clicks();
+            PlayTone(SEQ_PRIO_SFX, hz, note_ms);
+            sim_run_ms(note_ms + env.release_ms + 20);
+
+            const sim_note_t *note = sim_note_count() > first ? &sim_notes()[first] : NULL;
+            bool ok = note && pitch_cents(note->freq_hz, exact) <= SIM_NOTE_CENTS;
+            clicks = sim_buzzer_clicks() - clicks;
+
+            clicks_total += clicks;
+            ok = ok && clicks == 0;
+            result = ok ? "ok" : "FAIL";
+            played++;
+            wrong += !ok;
+        }
+
+        printf("%4d %10.3f %3u %#7x %10.3f %+8.3f %8s %s\n", n, exact, (unsigned)t->res,
+               (unsigned)t->div, actual, cents, fixed_col, result);
+    }
+
+    prof_read(&r);
+    const prof_cycles_t *c = &r.section[PROF_SEQ_NOTE];
+    printf("table: max_err=%.3fc (limit %.1fc), 10-bit path unreachable=%d\n",
+           worst, SIM_NOTE_CENTS, unreachable);
+    printf("played: %d wrong=%d\n", played, wrong);
+    printf("note change: n=%u mean=%llu max=%u cycles\n", (unsigned)c->count,
+           c->count ? (unsigned long long)(c->total_cycles / c->count) : 0ULL,
+           (unsigned)c->max_cycles);
+    printf("clicks: %u\n", clicks_total);
+
+    return (worst > SIM_NOTE_CENTS || wrong || played == 0) ? 1 : 0;
+}
+
+/* ===================== Szenario: voices ===================== */
+
+#define SIM_VOICES_TOL_US 1000
+#define SIM_VOICES_CENTS SIM_PACK_CENTS
+
+typedef struct
+{
+    uint32_t hz;       // wie in songs.c bzw. angefordert
+    uint32_t start_ms; // ab Beginn des Falls
+    uint32_t len_ms;   // bis zum Ende der Release oder bis zur Verdrängung
+} voices_note_t;
+
+/* Pause zwischen zwei Fällen, dann Beginn des nächsten */
+static uint64_t voices_begin(int *first)
+{
+    sim_run_ms(300);
+    *first = sim_note_count();
+    return sim_now_us();
+}
+
+static int voices_check(const char *name, uint64_t t0, int first, const voices_note_t *exp, int count)
+{
+    const sim_note_t *notes = sim_notes() + first;
+    int played = sim_note_count() - first;
+    int wrong = 0;
+
+    for (int i = 0; i < count && i < played; i++)
+    {
+        int64_t start = (int64_t)(notes[i].start_us - t0) - (int64_t)exp[i].start_ms * 1000;
+        int64_t len = (int64_t)(notes[i].end_us - notes[i].start_us) - (int64_t)exp[i].len_ms * 1000;
+
+        if (llabs(start) > SIM_VOICES_TOL_US || llabs(len) > SIM_VOICES_TOL_US ||
+            pitch_cents(notes[i].freq_hz, exp[i].hz) > SIM_VOICES_CENTS)
+            wrong++;
+    }
+
+    bool ok = played == count && wrong == 0;
+    printf("%-14s notes=%d/%d wrong=%d %s\n", name, played, count, wrong, ok ? "ok" : "FAIL");
+    if (!ok)
+    {
+        for (int i = 0; i < played; i++)
+            printf("  %8.1fHz at %6.1fms for %6.1fms\n", notes[i].freq_hz,
+                   (double)(notes[i].start_us - t0) / 1000.0,
+                   (double)(notes[i].end_us - notes[i].start_us) / 1000.0);
+    }
+    return !ok;
+}
+
+#define VOICES_CHECK(name, t0, first, exp) \
+    voices_check(name, t0, first, exp, (int)(sizeof(exp) / sizeof(exp[0])))
+
+static int run_voices(void)
+{
+    // Intro (660, 760) und Lied (1120..1420) je 150 ms pro Note
+    static const voices_note_t chime_music[] = {
+        {660, 0, 150}, {760, 150, 150}, {1120, 300, 150}, {1220, 450, 150}, {1320, 600, 150}, {1420, 750, 150}};
+    static const voices_note_t chime_sfx[] = {
+        {1120, 0, 150}, {1220, 150, 150}, {1320, 300, 150}, {1420, 450, 150}, {880, 600, 100}};
+    static const voices_note_t sfx_music[] = {
+        {1120, 0, 150}, {1220, 150, 70}, {880, 220, 100}, {1220, 320, 80}, {1320, 400, 150}, {1420, 550, 150}};
+    static const voices_note_t sfx_dropped[] = {{880, 0, 100}, {440, 100, 150}};
+    static const voices_note_t chained[] = {{440, 0, 150}, {660, 150, 150}, {760, 300, 150}};
+    static const voices_note_t stop_sfx[] = {
+        {1120, 0, 100}, {880, 100, 216}, {1120, 316, 50}, {1220, 366, 150}, {1320, 516, 150}, {1420, 666, 150}};
+    int failed = 0;
+    int first;
+    uint64_t t0;
+
+    sim_run_ms(song_length_ms(win95_true_boot, win95_true_boot_len) + 500);
+
+    // Zugleich angefordert: das Lied wartet und beginnt an der letzten Grenze des Intros
+    t0 = voices_begin(&first);
+    PlayToneSequence(SEQ_PRIO_CHIME, &midi_mode_tones_song);
+    PlayToneSequence(SEQ_PRIO_MUSIC, &tonleiter_mode_tones_song);
+    sim_run_ms(1200);
+    failed += VOICES_CHECK("chime>music", t0, first, chime_music);
+
+    // Tastendruck während des Intros: das Intro bleibt ganz, der Effekt folgt
+    t0 = voices_begin(&first);
+    PlayToneSequence(SEQ_PRIO_CHIME, &tonleiter_mode_tones_song);
+    sim_run_ms(100);
+    PlayTone(SEQ_PRIO_SFX, 880, 100);
+    sim_run_ms(1000);
+    failed += VOICES_CHECK("chime>sfx", t0, first, chime_sfx);
+
+    // Effekt mitten in der zweiten Note: das Lied spielt danach deren Rest
+    t0 = voices_begin(&first);
+    PlayToneSequence(SEQ_PRIO_MUSIC, &tonleiter_mode_tones_song);
+    sim_run_ms(220);
+    PlayTone(SEQ_PRIO_SFX, 880, 100);
+    sim_run_ms(1000);
+    failed += VOICES_CHECK("sfx>music", t0, first, sfx_music);
+
+    // Intro verdrängt einen Effekt, der danach nicht wiederkommt
+    t0 = voices_begin(&first);
+    PlayTone(SEQ_PRIO_SFX, 880, 400);
+    sim_run_ms(100);
+    PlayToneSequence(SEQ_PRIO_CHIME, &beep_mode_tones_song);
+    sim_run_ms(1000);
+    failed += VOICES_CHECK("chime>sfx drop", t0, first, sfx_dropped);
+
+    // Angehängt: ohne Lücke nach dem ersten Song derselben Klasse
+    t0 = voices_begin(&first);
+    PlayToneSequence(SEQ_PRIO_MUSIC, &beep_mode_tones_song);
+    ChainToneSequence(SEQ_PRIO_MUSIC, &midi_mode_tones_song);
+    sim_run_ms(1000);
+    failed += VOICES_CHECK("chain", t0, first, chained);
+
+    // Gestoppter Effekt: Release, dann der Rest der unterbrochenen Note
+    t0 = voices_begin(&first);
+    PlayToneSequence(SEQ_PRIO_MUSIC, &tonleiter_mode_tones_song);
+    sim_run_ms(100);
+    PlayTone(SEQ_PRIO_SFX, 880, 1000);
+    sim_run_ms(200);
+    StopToneSequence(SEQ_PRIO_SFX);
+    sim_run_ms(1200);
+    failed += VOICES_CHECK("stop sfx", t0, first, stop_sfx);
+
+    printf("buzzer clicks: %u\n", sim_buzzer_clicks());
+    return failed + (sim_buzzer_clicks() != 0);
+}
+
+/* ===================== Szenario: record ===================== */
+
+#define SIM_REC_PRESSES_MAX 2048
+#define SIM_REC_BATCH 200       // Drücke pro Einplanung, SIM_MAX_PIN_EVENTS reicht für zwei
+#define SIM_REC_HOLD_MS 40
+#define SIM_REC_TOL_US 1000     // Abstände der Töne gegen die Abstände der Drücke
+#define SIM_REC_MERGE_US 300000 // Ton (200 ms) samt Release
+#define SIM_REC_IMAGE_MAX (sizeof(rec_header_t) + REC_RING_BYTES)
+#define SIM_REC_BUTTONS 10      // P1 und P2; das Szenario läuft ohne Kette
+
+typedef struct
+{
+    uint64_t at_us;
+    uint8_t button;
+} sim_rec_press_t;
+
+static const gpio_num_t rec_pins[SIM_REC_BUTTONS] = {
+    IN_P1_TOP_PIN, IN_P1_DOWN_PIN, IN_P1_LEFT_PIN, IN_P1_RIGHT_PIN, IN_P1_FIRE_PIN,
+    IN_P2_TOP_PIN, IN_P2_DOWN_PIN, IN_P2_LEFT_PIN, IN_P2_RIGHT_PIN, IN_P2_FIRE_PIN};
+static const uint32_t rec_freqs[SIM_REC_BUTTONS] = {262, 294, 330, 349, 392, 440, 494, 523, 587, 659};
+
+static sim_rec_press_t rec_presses[SIM_REC_PRESSES_MAX];
+static uint8_t rec_image_live[SIM_REC_IMAGE_MAX];
+static uint8_t rec_image_saved[SIM_REC_IMAGE_MAX];
+static uint8_t rec_image_trace[SIM_REC_IMAGE_MAX];
+
+/* Eingebaute Session ab @t0: Tonleiter (3 Byte), Triller (2 Byte), lange Pausen (3 und 4 Byte) */
+static int rec_builtin(uint64_t t0)
+{
+    uint64_t t = t0 + 1000000; // nach dem Intro des BeepMode
+    int n = 0;
+
+    for (int i = 0; i < SIM_REC_BUTTONS; i++)
+    {
+        rec_presses[n++] = (sim_rec_press_t){t, (uint8_t)i};
+        t += 250000 + 1234 * (uint64_t)i; // nicht auf den Tick ausgerichtet
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        rec_presses[n++] = (sim_rec_press_t){t, (uint8_t)(4 + i % 2)};
+        t += 25007;
+    }
+    t += 3000000;
+    rec_presses[n++] = (sim_rec_press_t){t, 9};
+    t += 5000000;
+    rec_presses[n++] = (sim_rec_press_t){t, 0};
+    return n;
+}
+
+/* Image als Tastendrücke, erster Abstand ab @t0 (Mode-Druck); -1 bei ungültigem Image */
+static int rec_from_image(const uint8_t *img, size_t len, uint64_t t0)
+{
+    rec_header_t hdr;
+    rec_event_t ev;
+    uint32_t pos = 0;
+    uint64_t t = t0;
+    int n = 0;
+
+    if (len < sizeof(hdr))
+        return -1;
+    memcpy(&hdr, img, sizeof(hdr));
+    if (hdr.magic != REC_MAGIC || hdr.version != REC_VERSION || hdr.tick_us == 0 ||
+        sizeof(hdr) + hdr.bytes > len)
+        return -1;
+
+    const uint8_t *data = img + sizeof(hdr);
+    while (n < SIM_REC_PRESSES_MAX && rec_decode(data, hdr.bytes, &pos, &ev))
+    {
+        if (ev.button >= SIM_REC_BUTTONS)
+            return -1; // Buzzer der Kette
+        t += (uint64_t)ev.delta_ticks * hdr.tick_us;
+        rec_presses[n++] = (sim_rec_press_t){t, ev.button};
+    }
+    return pos == hdr.bytes && n == hdr.count ? n : -1;
+}
+
+/* Loslassen vor dem nächsten Druck derselben Taste */
+static uint32_t rec_hold_ms(int i, int n)
+{
+    uint32_t hold = SIM_REC_HOLD_MS;
+
+    for (int k = i + 1; k < n; k++)
+    {
+        if (rec_presses[k].button == rec_presses[i].button)
+        {
+            uint64_t half_ms = (rec_presses[k].at_us - rec_presses[i].at_us) / 2000;
+            if (half_ms < hold)
+                hold = half_ms > 5 ? (uint32_t)half_ms : 5;
+            break;
+        }
+    }
+    return hold;
+}
+
+/* Bis kurz vor @at_us laufen; playbox_wait() kann um einen Tick überziehen */
+static void rec_run_until(uint64_t at_us)
+{
+    uint64_t margin = 20000;
+
+    if (at_us > sim_now_us() + margin)
+        sim_run_ms((uint32_t)((at_us - margin - sim_now_us()) / 1000));
+}
+
+/* Mode-Druck IDLE -> BEEP bei @t_mode, die Drücke, dann BEEP -> MIDI */
+static void rec_session(int n, uint64_t t_mode)
+{
+    sim_press(t_mode, IN_LED_PIN, 80, true);
+
+    for (int i = 0; i < n; i += SIM_REC_BATCH)
+    {
+        int end = i + SIM_REC_BATCH < n ? i + SIM_REC_BATCH : n;
+        for (int k = i; k < end; k++)
+            sim_press(rec_presses[k].at_us, rec_pins[rec_presses[k].button], rec_hold_ms(k, n), true);
+        rec_run_until(rec_presses[end - 1].at_us);
+    }
+    sim_run_ms((uint32_t)((rec_presses[n - 1].at_us - sim_now_us()) / 1000) + 1000);
+
+    // Verlassen beendet die Aufnahme und speichert sie
+    sim_press(sim_now_us() + 1000, IN_LED_PIN, 80, true);
+    sim_run_ms(1000);
+    while (rec_saving())
+        sim_run_ms(10);
+}
+
+/* MIDI -> QUIZMASTER -> TONLEITER -> IDLE */
+static void rec_to_idle(void)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        sim_press(sim_now_us() + 1000, IN_LED_PIN, 80, i < 2);
+        sim_run_ms(2000);
+    }
+}
+
+/*
+ * Wiedergabe gegen die aufgenommenen Drücke: Töne im selben Abstand wie die
+ * Drücke. Live ist kein Maßstab, ein Intro kann dort Töne verschieben. Ein
+ * Druck auf dieselbe Taste, solange deren Ton noch klingt, ist für den
+ * Simulator kein neuer Ton.
+ */
+static int rec_compare(int first, int played, int n)
+{
+    const sim_note_t *notes = sim_notes() + first;
+    int64_t worst = 0;
+    int expected = 0, wrong = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        if (i > 0 && rec_presses[i].button == rec_presses[i - 1].button &&
+            rec_presses[i].at_us - rec_presses[i - 1].at_us < SIM_REC_MERGE_US)
+            continue;
+
+        if (expected < played)
+        {
+            const sim_note_t *note = &notes[expected];
+            int64_t want = (int64_t)(rec_presses[i].at_us - rec_presses[0].at_us);
+            int64_t err = llabs((int64_t)(note->start_us - notes[0].start_us) - want);
+
+            if (err > worst)
+                worst = err;
+            // BeepMode-Frequenzen sind gerundete Noten: gegen die Note prüfen
+            double ref_hz = note_freq(nearest_note(rec_freqs[rec_presses[i].button]));
+            if (err > SIM_REC_TOL_US || pitch_cents(note->freq_hz, ref_hz) > SIM_NOTE_CENTS)
+                wrong++;
+        }
+        expected++;
+    }
+
+    bool ok = played == expected && wrong == 0;
+    printf("replay: notes=%d/%d wrong=%d max_skew=%lldus %s\n", played, expected, wrong,
+           (long long)worst, ok ? "ok" : "FAIL");
+    return !ok;
+}
+
+static int run_record(const char *in_path, const char *out_path)
+{
+    const rec_stats_t *st = rec_stats();
+    const sim_nvs_stats_t *nvs = sim_nvs_stats();
+    size_t in_len = 0;
+    int failed = 0;
+    int n;
+
+    sim_run_ms(song_length_ms(win95_true_boot, win95_true_boot_len) + 500);
+
+    // Mode-Druck auf einem Tick: dann ergibt das Image als Trace dieselben Ticks
+    uint64_t t_mode = (sim_now_us() / REC_TICK_US + 1) * REC_TICK_US;
+    if (in_path)
+    {
+        FILE *f = fopen(in_path, "rb");
+        if (!f)
+        {
+            perror(in_path);
+            return 1;
+        }
+        in_len = fread(rec_image_trace, 1, sizeof(rec_image_trace), f);
+        fclose(f);
+        n = rec_from_image(rec_image_trace, in_len, t_mode);
+        if (n <= 0)
+        {
+            fprintf(stderr, "%s: not a recording\n", in_path);
+            return 1;
+        }
+    }
+    else
+    {
+        n = rec_builtin(t_mode);
+    }
+
+    // Live: aufnehmen und beim Verlassen nach NVS schreiben
+    uint32_t chunk_writes = st->chunk_writes;
+    sim_nvs_stats_t nvs_before = *nvs;
+    rec_session(n, t_mode);
+    size_t len = rec_image(rec_image_live, sizeof(rec_image_live));
+    uint32_t events = st->events, bytes = st->bytes;
+    uint32_t chunks = (bytes + REC_NVS_CHUNK - 1) / REC_NVS_CHUNK;
+
+    bool ok = events == (uint32_t)n && st->overwritten == 0 && len > 0;
+    printf("record: presses=%d events=%u bytes=%u (%.2f B/event) %s\n", n, (unsigned)events,
+           (unsigned)bytes, events ? (double)bytes / events : 0.0, ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    // Stücke plus Header, einmal pro Aufnahme; der Verschleiß in 32-Byte-Einträgen
+    ok = st->saves == 1 && st->chunk_writes - chunk_writes == chunks &&
+         nvs->blob_writes - nvs_before.blob_writes == chunks + 1 &&
+         nvs->commits - nvs_before.commits == 1;
+    printf("nvs: chunks=%u blob_writes=%u entries=%llu bytes=%llu %s\n", (unsigned)chunks,
+           (unsigned)(nvs->blob_writes - nvs_before.blob_writes),
+           (unsigned long long)(nvs->entries - nvs_before.entries),
+           (unsigned long long)(nvs->bytes - nvs_before.bytes), ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    // Zurückgelesen wie nach einem Neustart
+    ok = rec_load() && rec_image(rec_image_saved, sizeof(rec_image_saved)) == len &&
+         memcmp(rec_image_saved, rec_image_live, len) == 0;
+    printf("nvs reload: %s\n", ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    if (in_path)
+    {
+        ok = in_len == len && memcmp(rec_image_trace, rec_image_live, len) == 0;
+        printf("trace %s: %s\n", in_path, ok ? "same image" : "FAIL");
+        failed += !ok;
+    }
+
+    // Wiedergabe im IDLE_MODE über denselben Tonweg
+    rec_to_idle();
+    uint64_t span = rec_presses[n - 1].at_us - rec_presses[0].at_us;
+    int replay = sim_note_count();
+    sim_press(sim_now_us() + 1000, IN_P1_TOP_PIN, 80, true);
+    sim_run_ms((uint32_t)(span / 1000) + 1000);
+    ok = !rec_playing();
+    failed += rec_compare(replay, sim_note_count() - replay, n) + !ok;
+
+    // Die Aufnahme als Eingabe-Trace: gleiche Drücke, gleiches Image
+    t_mode = (sim_now_us() / REC_TICK_US + 1) * REC_TICK_US;
+    ok = rec_from_image(rec_image_live, len, t_mode) == n;
+    if (ok)
+    {
+        rec_session(n, t_mode);
+        ok = rec_image(rec_image_saved, sizeof(rec_image_saved)) == len &&
+             memcmp(rec_image_saved, rec_image_live, len) == 0;
+    }
+    printf("trace round trip: %s\n", ok ? "same image" : "FAIL");
+    failed += !ok;
+
+    // Die Aufnahme hängt nichts an den Weg vom Druck zum Ton. Der Median:
+    // Drücke während eines Intros warten zu Recht darauf
+    const sim_latency_t *lat = sim_latency();
+    uint64_t sorted[SIM_MAX_LATENCIES];
+    memcpy(sorted, lat->latency_us, (size_t)lat->count * sizeof(uint64_t));
+    qsort(sorted, (size_t)lat->count, sizeof(uint64_t), cmp_u64);
+    uint64_t p50 = lat->count ? sorted[lat->count / 2] : 0;
+    ok = lat->missed == 0 && p50 < SIM_LATENCY_US;
+    printf("input-to-sound: n=%d missed=%d p50=%.3fms max=%.3fms %s\n", lat->count, lat->missed,
+           (double)p50 / 1000.0, lat->count ? (double)sorted[lat->count - 1] / 1000.0 : 0.0,
+           ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    if (out_path)
+    {
+        FILE *f = fopen(out_path, "wb");
+        if (!f || fwrite(rec_image_live, 1, len, f) != len)
+        {
+            perror(out_path);
+            failed++;
+        }
+        if (f)
+            fclose(f);
+    }
+
+    return failed;
+}
+
+/* ===================== Szenario: players ===================== */
+
+#define SIM_PLAYERS_ROUND_US 5000000 // Orb fadet nach ORB_QUIZ_FADE_MS aus, dann neue Frage
+#define SIM_PLAYERS_LED_US 30000     // so lange nach dem letzten Druck muss die LED stimmen
+#define SIM_PLAYERS_ANY -1           // Gleichstand: jeder der Beteiligten darf gewinnen
+
+typedef struct
+{
+    const char *name;
+    int64_t at_us[QUIZ_MAX_PLAYERS]; // ab Rundenbeginn, < 0: drückt nicht
+    int expect_winner;               // oder SIM_PLAYERS_ANY
+    bool expect_tie;
+} players_round_t;
+
+/* Antworttöne und LEDs wie die Spieler-Tabelle in playbox.c */
+static const uint32_t players_quiz_hz[QUIZ_MAX_PLAYERS] = {523, 659, 698, 784, 880, 988, 1047, 1175};
+static const ledc_channel_t players_led[2] = {LEDC_CHANNEL_1, LEDC_CHANNEL_4}; // P1/P2 rot
+
+/* Buzzer von Spieler @p: P1/P2 am GPIO, ab P3 an der Kette */
+static void players_press(uint64_t at_us, int p, uint32_t hold_ms, bool expect_tone)
+{
+    if (p < 2)
+        sim_press(at_us, p == 0 ? IN_P1_TOP_PIN : IN_P2_TOP_PIN, hold_ms, expect_tone);
+    else
+        sim_chain_press(at_us, p - 2, hold_ms, expect_tone);
+}
+
+/* Letzter Ton, der in [from_us, to_us) beginnt, oder NULL */
+static const sim_note_t *players_last_note(uint64_t from_us, uint64_t to_us)
+{
+    const sim_note_t *notes = sim_notes();
+    const sim_note_t *last = NULL;
+
+    for (int i = 0; i < sim_note_count(); i++)
+    {
+        if (notes[i].start_us >= from_us && notes[i].start_us < to_us)
+            last = &notes[i];
+    }
+    return last;
+}
+
+static int players_round(const players_round_t *r, int players)
+{
+    const quiz_stats_t *st = Quizmaster_stats();
+    uint32_t rounds = st->rounds, ties = st->ties;
+    uint64_t t = sim_now_us() + 100000;
+    int first = -1, last = -1;
+
+    for (int p = 0; p < players; p++)
+    {
+        if (r->at_us[p] >= 0 && (first < 0 || r->at_us[p] < r->at_us[first]))
+            first = p;
+    }
+    for (int p = 0; p < players; p++)
+    {
+        if (r->at_us[p] < 0)
+            continue;
+        players_press(t + (uint64_t)r->at_us[p], p, 150, p == first); // nur der Erste bekommt sicher einen Ton
+        if (last < 0 || r->at_us[p] > r->at_us[last])
+            last = p;
+    }
+
+    sim_run_ms((uint32_t)((t + (uint64_t)r->at_us[last] + SIM_PLAYERS_LED_US - sim_now_us()) / 1000));
+
+    int winner = st->last_winner;
+    bool ok = st->rounds == rounds + 1 && (st->ties != ties) == r->expect_tie &&
+              (r->expect_winner == SIM_PLAYERS_ANY ? r->at_us[winner] >= 0 : winner == r->expect_winner);
+
+    // Antwortton des Gewinners, nur seine LED (Ketten-Spieler haben keine)
+    const sim_note_t *note = players_last_note(t, sim_now_us());
+    ok = ok && note && pitch_cents(note->freq_hz, note_freq(nearest_note(players_quiz_hz[winner]))) <= SIM_NOTE_CENTS;
+    for (int p = 0; p < 2; p++)
+        ok = ok && (sim_get_duty(LED_LEDC_MODE, players_led[p]) > 0) == (winner == p);
+    ok = ok && sim_get_duty(LED_LEDC_MODE, LEDC_CHANNEL_7) > 0;
+
+    printf("%-30s winner=P%d margin=%5lldus +-%4lld tie=%d tone=%4.0fHz %s\n", r->name, winner + 1,
+           (long long)st->last_margin_us, (long long)st->last_margin_err_us, st->ties != ties, note ? note->freq_hz : 0.0, ok ? "ok" : "FAIL");
+
+    sim_run_ms(SIM_PLAYERS_ROUND_US / 1000);
+    return !ok;
+}
+
+static int run_players(void)
+{
+    static const players_round_t rounds[] = {
+        {"chain first, gpio late", {9000, -1, -1, -1, 3000, -1, -1, 12000}, 4, false},
+        {"gpio first, chain late", {-1, 2000, -1, -1, -1, -1, -1, 6000}, 1, false},
+        {"all eight, chain earliest", {7000, 7400, 8000, 9000, 10000, 11000, 12000, 3000}, 7, false},
+        {"chain vs chain 3 ms", {-1, -1, 4000, -1, -1, -1, 1000, -1}, 6, false},
+        {"chain tie, 0.3 ms apart", {-1, -1, -1, 5000, -1, 5300, -1, -1}, 3, true},
+        {"gpio vs chain tie, 0.3 ms", {5000, -1, 5300, -1, -1, -1, -1, -1}, SIM_PLAYERS_ANY, true},
+        // Scan-Phase entscheidet nicht: 1,5 ms an der Kette messen 1 oder 2 ms
+        {"chain vs chain 1.5 ms, tie", {-1, -1, -1, -1, 6500, 5000, -1, -1}, SIM_PLAYERS_ANY, true},
+        {"gpio vs chain 1 ms, tie", {-1, 5000, -1, -1, -1, -1, 6000, -1}, SIM_PLAYERS_ANY, true},
+    };
+    int players = playbox_players();
+    int failed = 0;
+    prof_report_t pr;
+
+    bool ok = chain_bits() == PLAYBOX_CHAIN_PLAYERS && players == 2 + PLAYBOX_CHAIN_PLAYERS;
+    printf("players: %d (chain %d inputs, %d B per read) %s\n", players, chain_bits(),
+           (chain_bits() + 7) / 8, ok ? "ok" : "FAIL");
+    if (!ok)
+        return 1;
+
+    sim_run_ms(song_length_ms(win95_true_boot, win95_true_boot_len) + 500);
+
+    // Ohne Spieler-Mode keine Abtastung der Kette
+    uint32_t reads = sim_spi_transfers();
+    sim_run_ms(1000);
+    ok = sim_spi_transfers() == reads;
+    printf("idle: spi reads=%u %s\n", (unsigned)(sim_spi_transfers() - reads), ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    // IDLE -> QUIZMASTER
+    for (int m = 0; m < QUIZMASTER_MODE; m++)
+    {
+        sim_press(sim_now_us() + 1000, IN_LED_PIN, 80, false);
+        sim_run_ms(1500);
+    }
+    sim_run_ms(2000); // Intro
+
+    prof_reset();
+    uint64_t t_quiz = sim_now_us();
+    reads = sim_spi_transfers();
+    for (size_t i = 0; i < sizeof(rounds) / sizeof(rounds[0]); i++)
+    {
+        if (rounds[i].expect_winner < players)
+            failed += players_round(&rounds[i], players);
+    }
+    double quiz_s = (double)(sim_now_us() - t_quiz) / 1e6;
+    prof_read(&pr);
+    const prof_cycles_t *c = &pr.section[PROF_MODE_QUIZ];
+    ok = sim_spi_transfers() == chain_reads() && sim_spi_transfers() - reads >= (uint32_t)(quiz_s * 990);
+    printf("quiz: spi reads=%.0f/s handler n=%u mean=%llu max=%u cycles %s\n",
+           (sim_spi_transfers() - reads) / quiz_s, (unsigned)c->count,
+           c->count ? (unsigned long long)(c->total_cycles / c->count) : 0ULL, (unsigned)c->max_cycles,
+           ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    // QUIZMASTER -> TONLEITER -> IDLE -> BEEP: jeder Ketten-Buzzer eine Note, aufgenommen
+    for (int m = 0; m < 3; m++)
+    {
+        sim_press(sim_now_us() + 1000, IN_LED_PIN, 80, false);
+        sim_run_ms(1500);
+    }
+    sim_run_ms(1500); // Intro
+
+    uint64_t t = sim_now_us() + 1000;
+    int first = sim_note_count();
+    for (int p = 2; p < players; p++)
+        players_press(t + (uint64_t)(p - 2) * 250000, p, 80, true);
+    players_press(t + (uint64_t)(players - 2) * 250000, 0, 80, true);
+    sim_run_ms((uint32_t)(players - 1) * 250 + 500);
+
+    // Ton und Synth je Druck: Buzzer-Töne in Druckreihenfolge
+    const sim_note_t *notes = sim_notes();
+    int wrong = 0, played = sim_note_count() - first;
+    for (int k = 0; k < played && k < players - 1; k++)
+    {
+        uint32_t hz = k < players - 2 ? players_quiz_hz[k + 2] : 262;
+        wrong += pitch_cents(notes[first + k].freq_hz, note_freq(nearest_note(hz))) > SIM_NOTE_CENTS;
+    }
+    ok = played == players - 1 && wrong == 0;
+    printf("beep: notes=%d/%d wrong=%d %s\n", played, players - 1, wrong, ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    // BEEP -> MIDI: Aufnahme mit den Ketten-Buzzern als Tasten 10, 11, ...
+    sim_press(sim_now_us() + 1000, IN_LED_PIN, 80, false);
+    sim_run_ms(1000);
+    while (rec_saving())
+        sim_run_ms(10);
+
+    size_t len = rec_image(rec_image_live, sizeof(rec_image_live));
+    rec_event_t ev;
+    uint32_t pos = 0;
+    int n = 0;
+    ok = len > sizeof(rec_header_t);
+    while (ok && rec_decode(rec_image_live + sizeof(rec_header_t), (uint32_t)(len - sizeof(rec_header_t)), &pos, &ev))
+    {
+        int want = n < players - 2 ? 2 * 5 + n : 0;
+        ok = ev.button == want;
+        n++;
+    }
+    ok = ok && n == players - 1;
+    printf("record: events=%d buttons=10..%d,0 %s\n", n, 2 * 5 + players - 3, ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    // MIDI-Mode: Abtastung wieder aus
+    sim_run_ms(100);
+    reads = sim_spi_transfers();
+    sim_run_ms(2000);
+    ok = sim_spi_transfers() == reads;
+    printf("midi: spi reads=%u %s\n", (unsigned)(sim_spi_transfers() - reads), ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    const sim_latency_t *lat = sim_latency();
+    uint64_t sorted[SIM_MAX_LATENCIES];
+    memcpy(sorted, lat->latency_us, (size_t)lat->count * sizeof(uint64_t));
+    qsort(sorted, (size_t)lat->count, sizeof(uint64_t), cmp_u64);
+    uint64_t p50 = lat->count ? sorted[lat->count / 2] : 0;
+    ok = lat->missed == 0 && p50 < SIM_LATENCY_US + INPUT_SCAN_US;
+    printf("input-to-sound: n=%d missed=%d p50=%.3fms max=%.3fms %s\n", lat->count, lat->missed,
+           (double)p50 / 1000.0, lat->count ? (double)sorted[lat->count - 1] / 1000.0 : 0.0,
+           ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    return failed;
+}
+
+/* ===================== Szenario: profile ===================== */
+
+/* Profiler gegen die Messungen des Simulators: dieselbe Session wie oben */
+static int run_profile(void)
+{
+    prof_report_t r;
+    int failed = 0;
+
+    schedule_session(sim_now_us() + 3000000);
+    sim_run_ms(3000 + 20000);
+    prof_read(&r);
+
+    // Jeder Abschnitt ist in der Session mindestens einmal gelaufen
+    for (int i = 0; i < PROF_SECTION_COUNT; i++)
+    {
+        const prof_cycles_t *c = &r.section[i];
+        bool ok = c->count > 0 && c->max_cycles > 0;
+        printf("%-15s n=%5u mean=%8llu max=%8u %s\n", prof_section_name(i), (unsigned)c->count,
+               c->count ? (unsigned long long)(c->total_cycles / c->count) : 0ULL,
+               (unsigned)c->max_cycles, ok ? "ok" : "FAIL");
+        failed += !ok;
+    }
+
+    // Ein Eintrag pro Durchlauf außer dem ersten nach prof_reset()
+    uint32_t periods = 0;
+    for (int i = 0; i < PROF_HIST_BUCKETS; i++)
+        periods += r.loop_hist[i];
+    bool ok = periods + 1 == r.section[PROF_LOOP].count && periods + 1 == loop_cost.loops;
+    printf("loop periods: %u of %llu loops %s\n", periods, (unsigned long long)loop_cost.loops,
+           ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    // Notengrenzen: der Sequenzer ist höchstens einen Timer-Callback spät
+    for (int e = 0; e < PROF_TONE_EDGE_COUNT; e++)
+    {
+        const prof_timing_t *t = &r.tone[e];
+        ok = t->count > 0 && t->max_late_us <= 1000 && t->max_early_us == 0;
+        printf("tone %s: n=%u late_max=%dus early_max=%dus %s\n", e == PROF_TONE_START ? "start" : "stop",
+               (unsigned)t->count, (int)t->max_late_us, (int)t->max_early_us, ok ? "ok" : "FAIL");
+        failed += !ok;
+    }
+
+    /*
+     * Latenz ab der ISR-Flanke bis zum Ton auf das Kommando. Wechselt der
+     * MIDI-Mode das Lied, beginnt es erst nach der Release des alten; der
+     * Simulator rechnet dagegen schon dessen nächste Note an.
+     */
+    const tone_env_t *envs[] = {&ode_an_die_freude_env, &melody_happy_birthday_env,
+                                &melody_hallelujah_motif_env, &alle_meine_entchen_env};
+    const sim_latency_t *lat = sim_latency();
+    uint64_t sim_max = 0;
+    uint64_t release_max = 0;
+    for (int i = 0; i < lat->count; i++)
+        if (lat->latency_us[i] > sim_max)
+            sim_max = lat->latency_us[i];
+    for (int i = 0; i < (int)(sizeof(envs) / sizeof(envs[0])); i++)
+        if (envs[i]->release_ms * 1000ULL > release_max)
+            release_max = envs[i]->release_ms * 1000ULL;
+    ok = r.latency.count == (uint32_t)lat->count && r.latency.max_us <= sim_max + release_max;
+    printf("input->tone: n=%u max=%uus (sim n=%d max=%lluus) %s\n", (unsigned)r.latency.count,
+           (unsigned)r.latency.max_us, lat->count, (unsigned long long)sim_max, ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    // Bericht auf Anfrage: beide Feuertaster halten, danach beginnen die Zähler neu
+    uint64_t loops = loop_cost.loops;
+    uint64_t t = sim_now_us() + 100000;
+    sim_press(t, IN_P1_FIRE_PIN, 2600, false);
+    sim_press(t + 50000, IN_P2_FIRE_PIN, 2500, false);
+    sim_log_enable(true);
+    sim_run_ms(3000);
+    sim_log_enable(false);
+    prof_read(&r);
+    ok = r.section[PROF_LOOP].count > 0 && r.section[PROF_LOOP].count < loop_cost.loops - loops;
+    printf("dump on request: loops since dump=%u of %llu %s\n", (unsigned)r.section[PROF_LOOP].count,
+           (unsigned long long)(loop_cost.loops - loops), ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    return failed;
+}
+
+/* ===================== Szenario: boot ===================== */
+
+#define SIM_BOOT_NOTE_BUDGET_US 1000   // Reset bis zum ersten Ton des Startsongs
+#define SIM_BOOT_INIT_BUDGET_US 50000  // Reset bis zur Hauptschleife
+
+static int run_boot(void)
+{
+    static const char *const names[BOOT_STAGE_COUNT] = {
+        "app", "buzzer", "song", "note", "input", "init"};
+    int failed = 0;
+    bool ok = true;
+
+    // playbox_init() ist schon gelaufen, der Startsong klingt
+    sim_run_ms(100);
+
+    printf("stages:");
+    for (int s = 0; s < BOOT_STAGE_COUNT; s++)
+    {
+        int64_t t = boot_time_us((boot_stage_t)s);
+        printf(" %s=%.3fms", names[s], (double)t / 1000.0);
+        ok = ok && t >= 0;
+    }
+    printf("\n");
+
+    // Buzzer vor dem Song, der Song vor seinem ersten Ton
+    ok = ok && boot_time_us(BOOT_BUZZER_READY) <= boot_time_us(BOOT_SONG_QUEUED) &&
+         boot_time_us(BOOT_SONG_QUEUED) <= boot_time_us(BOOT_FIRST_NOTE) &&
+         boot_time_us(BOOT_INPUT_LIVE) <= boot_time_us(BOOT_INIT_DONE);
+    printf("order: %s\n", ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    // Der Buzzer-Mitschnitt muss dasselbe sehen wie die Marke
+    uint64_t note_us = sim_note_count() > 0 ? sim_notes()[0].start_us : UINT64_MAX;
+    uint64_t init_us = (uint64_t)boot_time_us(BOOT_INIT_DONE);
+    ok = note_us == (uint64_t)boot_time_us(BOOT_FIRST_NOTE) && note_us <= SIM_BOOT_NOTE_BUDGET_US &&
+         init_us <= SIM_BOOT_INIT_BUDGET_US;
+    printf("reset to first note: %.3fms (budget %.3fms), to main loop: %.3fms (budget %.3fms) %s\n",
+           (double)note_us / 1000.0, SIM_BOOT_NOTE_BUDGET_US / 1000.0,
+           (double)init_us / 1000.0, SIM_BOOT_INIT_BUDGET_US / 1000.0, ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    // Im Idle braucht niemand RGB-LEDs oder ADC
+    sim_run_ms(song_length_ms(win95_true_boot, win95_true_boot_len) + 500);
+    ok = sim_ledc_gpio(LED_LEDC_MODE, LEDC_CHANNEL_7) == OUT_LED_PIN &&
+         sim_ledc_gpio(LED_LEDC_MODE, LEDC_CHANNEL_1) < 0 && analog_task() == NULL;
+    printf("idle: orb=%d rgb=%d analog=%s %s\n", sim_ledc_gpio(LED_LEDC_MODE, LEDC_CHANNEL_7),
+           sim_ledc_gpio(LED_LEDC_MODE, LEDC_CHANNEL_1), analog_task() ? "on" : "off", ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    // IDLE -> BEEP startet beides; der erste Notentaster danach klingt wie immer
+    sim_press(sim_now_us() + 1000, IN_LED_PIN, 80, false);
+    sim_run_ms(1500);
+    sim_press(sim_now_us() + 1000, IN_P1_TOP_PIN, 80, true);
+    sim_run_ms(500);
+
+    const sim_latency_t *lat = sim_latency();
+    uint64_t late = lat->count ? lat->latency_us[lat->count - 1] : UINT64_MAX;
+    ok = sim_ledc_gpio(LED_LEDC_MODE, LEDC_CHANNEL_1) == OUT_P1_R_PIN &&
+         sim_ledc_gpio(LED_LEDC_MODE, LEDC_CHANNEL_6) == OUT_P2_B_PIN && analog_task() != NULL &&
+         lat->missed == 0 && late < SIM_LATENCY_US;
+    printf("beep: rgb=%d,%d analog=%s first press %.3fms %s\n",
+           sim_ledc_gpio(LED_LEDC_MODE, LEDC_CHANNEL_1), sim_ledc_gpio(LED_LEDC_MODE, LEDC_CHANNEL_6),
+           analog_task() ? "on" : "off", (double)late / 1000.0, ok ? "ok" : "FAIL");
+    failed += !ok;
+
+    return failed;
+}
+
+/* ===================== Szenario: bench ===================== */
+
+/* Schwellen, ab denen der Lauf als Regression fehlschlägt */
+#define BENCH_TIMING_MAX_US 1000   // Notenlänge bzw. Notengrenze daneben
+#define BENCH_PITCH_MAX_CENTS SIM_PACK_CENTS // LEDC-Teiler und songpack gegen die Tabelle
+#define BENCH_LATENCY_MAX_US 10000 // Taster bis Ton
+
+typedef struct
+{
+    const char *name;
+    Mode mode;
+    bool entry_tone;             // der Mode-Wechsel selbst spielt etwas
+    void (*script)(uint64_t t0); // NULL: nur laufen lassen
+    uint32_t run_ms;
+} bench_session_t;
+
+static void bench_beep(uint64_t t0)
+{
+    const gpio_num_t pins[10] = {
+        IN_P1_TOP_PIN, IN_P1_DOWN_PIN, IN_P1_LEFT_PIN, IN_P1_RIGHT_PIN, IN_P1_FIRE_PIN,
+        IN_P2_TOP_PIN, IN_P2_DOWN_PIN, IN_P2_LEFT_PIN, IN_P2_RIGHT_PIN, IN_P2_FIRE_PIN};
+
+    for (int i = 0; i < 10; i++)
+        sim_press(t0 + (uint64_t)i * 333000, pins[i], 60, true);
+    sim_press(t0 + 3500000, IN_P1_FIRE_PIN, 5, true); // kurzer Tipp
+}
+
+static void bench_midi(uint64_t t0)
+{
+    sim_press(t0, IN_P1_RIGHT_PIN, 80, true);
+    sim_press(t0 + 1500000, IN_P1_LEFT_PIN, 80, true);
+    sim_press(t0 + 3000000, IN_P1_RIGHT_PIN, 80, true);
+}
+
+static void bench_quiz(uint64_t t0)
+{
+    sim_press(t0 + 4000, IN_P2_TOP_PIN, 200, true);
+    sim_press(t0 + 6000, IN_P1_TOP_PIN, 200, false);
+}
+
+static const bench_session_t bench_sessions[] = {
+    {"beep", BEEP_MODE, false, bench_beep, 6000},
+    {"midi", MIDI_MODE, false, bench_midi, 6000},
+    {"quizmaster", QUIZMASTER_MODE, false, bench_quiz, 3000},
+    {"tonleiter", TONLEITER_MODE, true, NULL, 5000},
+    {"idle", IDLE_MODE, false, NULL, 10000},
+};
+
+#define BENCH_SESSION_COUNT (int)(sizeof(bench_sessions) / sizeof(bench_sessions[0]))
+
+static bool bench_song(FILE *out, const sim_song_t *song, bool last)
+{
+    song_result_t r;
+
+    song_play(song, &r);
+
+    bool ok = r.played == r.notes && r.truncated == 0 &&
+              r.max_abs_us <= BENCH_TIMING_MAX_US && r.max_cents <= BENCH_PITCH_MAX_CENTS;
+
+    fprintf(out, "    {\"name\": \"%s\", \"notes\": %d, \"played\": %d, \"dropped\": %d, \"truncated\": %d, "
+                 "\"timing_err_mean_us\": %.1f, \"timing_err_max_us\": %lld, \"pitch_err_max_cents\": %.1f, "
+                 "\"ok\": %s}%s\n",
+            song->name, r.notes, r.played, r.notes > r.played ? r.notes - r.played : 0, r.truncated,
+            r.compared ? (double)r.sum_abs_us / r.compared : 0.0, (long long)r.max_abs_us, r.max_cents,
+            ok ? "true" : "false", last ? "" : ",");
+    return ok;
+}
+
+static bool bench_session(FILE *out, const bench_session_t *bs, bool last)
+{
+    // Mode-Taster bis vor das Ziel; der letzte Wechsel gehört zur Messung
+    while ((playbox_mode() + 1) % MODE_COUNT != bs->mode)
+    {
+        sim_press(sim_now_us() + 1000, IN_LED_PIN, 80, false);
+        sim_run_ms(1500);
+    }
+
+    const sim_latency_t *lat = sim_latency();
+    int lat_first = lat->count;
+    int missed = lat->missed;
+    int first = sim_note_count();
+    uint64_t loops = loop_cost.loops;
+    uint64_t ns = loop_cost.total_ns;
+    uint64_t t0 = sim_now_us();
+    prof_report_t r;
+
+    sim_power_reset();
+    prof_reset();
+    sim_press(t0 + 100000, IN_LED_PIN, 80, bs->entry_tone);
+    if (bs->script)
+        bs->script(t0 + 1100000);
+    sim_run_ms(bs->run_ms);
+    prof_read(&r);
+
+    double span_s = (double)(sim_now_us() - t0) / 1e6;
+    int n = lat->count - lat_first;
+    uint64_t sorted[SIM_MAX_LATENCIES];
+    memcpy(sorted, &lat->latency_us[lat_first], (size_t)n * sizeof(uint64_t));
+    qsort(sorted, (size_t)n, sizeof(uint64_t), cmp_u64);
+    uint64_t lat_max = n ? sorted[n - 1] : 0;
+    int lat_missed = lat->missed - missed;
+
+    int32_t late_max = r.tone[PROF_TONE_START].max_late_us > r.tone[PROF_TONE_STOP].max_late_us
+                           ? r.tone[PROF_TONE_START].max_late_us
+                           : r.tone[PROF_TONE_STOP].max_late_us;
+    bool ok = lat_missed == 0 && lat_max <= BENCH_LATENCY_MAX_US && late_max <= BENCH_TIMING_MAX_US;
+
+    fprintf(out, "    {\"mode\": \"%s\", \"sim_s\": %.3f, \"notes\": %d, \"loops\": %llu, "
+                 "\"wakeups_per_s\": %.1f,\n",
+            bs->name, span_s, sim_note_count() - first, (unsigned long long)(loop_cost.loops - loops),
+            sim_power()->wakeups / span_s);
+    fprintf(out, "     \"latency\": {\"n\": %d, \"missed\": %d, \"p50_us\": %llu, \"max_us\": %llu},\n",
+            n, lat_missed, n ? (unsigned long long)sorted[n / 2] : 0ULL, (unsigned long long)lat_max);
+    fprintf(out, "     \"tone_timing\": {\"starts\": %u, \"stops\": %u, \"late_max_us\": %d, \"early_max_us\": %d},\n",
+            (unsigned)r.tone[PROF_TONE_START].count, (unsigned)r.tone[PROF_TONE_STOP].count, (int)late_max,
+            (int)(r.tone[PROF_TONE_START].max_early_us > r.tone[PROF_TONE_STOP].max_early_us
+                      ? r.tone[PROF_TONE_START].max_early_us
+                      : r.tone[PROF_TONE_STOP].max_early_us));
+
+    // Kosten pro simulierter Sekunde: Host-ns der Schleife und Profiler-Zyklen je Abschnitt
+    fprintf(out, "     \"cpu\": {\"loop_host_ns_per_s\": %.0f", (double)(loop_cost.total_ns - ns) / span_s);
+    for (int i = 0; i < PROF_SECTION_COUNT; i++)
+        fprintf(out, ", \"%s_cycles_per_s\": %.0f", prof_section_name(i), (double)r.section[i].total_cycles / span_s);
+    fprintf(out, "},\n     \"ok\": %s}%s\n", ok ? "true" : "false", last ? "" : ",");
+
+    return ok;
+}
+
+/**
+ * run_bench - alle Lieder und eine Session pro Mode, Ergebnis als JSON
+ * @json: Ausgabedatei, NULL = stdout
+ *
+ * Gibt die Zahl der Einträge zurück, die eine BENCH_*-Schwelle reißen.
+ */
+static int run_bench(const char *json)
+{
+    FILE *out = json ? fopen(json, "w") : stdout;
+    int failed = 0;
+
+    if (!out)
+    {
+        perror(json);
+        return 1;
+    }
+
+    sim_run_ms(song_length_ms(win95_true_boot, win95_true_boot_len) + 500);
+
+    fprintf(out, "{\n  \"limits\": {\"timing_max_us\": %d, \"pitch_max_cents\": %.1f, \"latency_max_us\": %d},\n",
+            BENCH_TIMING_MAX_US, BENCH_PITCH_MAX_CENTS, BENCH_LATENCY_MAX_US);
+
+    fprintf(out, "  \"songs\": [\n");
+    for (int s = 0; s < SIM_SONG_COUNT; s++)
+        failed += !bench_song(out, &sim_songs[s], s == SIM_SONG_COUNT - 1);
+    fprintf(out, "  ],\n");
+
+    fprintf(out, "  \"sessions\": [\n");
+    for (int i = 0; i < BENCH_SESSION_COUNT; i++)
+        failed += !bench_session(out, &bench_sessions[i], i == BENCH_SESSION_COUNT - 1);
+    fprintf(out, "  ],\n");
+
+    fprintf(out, "  \"buzzer_clicks\": %u, \"seq_dropped\": %u, \"fade_conflicts\": %u,\n",
+            sim_buzzer_clicks(), (unsigned)sequencer_dropped(), sim_ledc_fade_conflicts());
+    failed += sim_buzzer_clicks() != 0 || sequencer_dropped() != 0;
+
+    dlog_stats_t ls;
+    dlog_read_stats(&ls);
+    fprintf(out, "  \"log\": {\"written\": %u, \"dropped\": %u, \"emitted\": %u},\n",
+            (unsigned)ls.written, (unsigned)ls.dropped, (unsigned)ls.emitted);
+    failed += ls.dropped != 0 || ls.emitted != ls.written;
+
+    fprintf(out, "  \"failed\": %d\n}\n", failed);
+
+    if (json)
+        fclose(out);
+    if (failed)
+        fprintf(stderr, "bench: %d regression(s)\n", failed);
+    return failed;
+}
+
+/* ===================== Szenario: analog ===================== */
+
+static analog_filter_cfg_t analog_test_cfg(void)
+{
+    return (analog_filter_cfg_t){
+        .oversample = ANALOG_OVERSAMPLE,
+        .shift = ANALOG_SHIFT,
+        .raw_min = ANALOG_RAW_MIN,
+        .raw_max = ANALOG_RAW_MAX,
+        .deadzone = ANALOG_DEADZONE,
+        .hysteresis = ANALOG_HYSTERESIS,
+    };
+}
+
+/* Stellung, die ein rauschfreier Rohwert ergeben soll */
+static double analog_expected(int raw)
+{
+    double span = ANALOG_RAW_MAX - ANALOG_RAW_MIN;
+    double pos = (raw - ANALOG_RAW_MIN) * (ANALOG_FULL_SCALE + 2.0 * ANALOG_DEADZONE) / span - ANALOG_DEADZONE;
+    return pos < 0 ? 0 : pos > ANALOG_FULL_SCALE ? ANALOG_FULL_SCALE : pos;
+}
+
+/* Rohwert mit Rauschen wie sim_hal.c, aber direkt in den Filter */
+static uint32_t analog_seed = 1;
+
+static uint16_t analog_noisy(int raw, int amplitude)
+{
+    int sum = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        analog_seed = analog_seed * 1103515245u + 12345u;
+        sum += (int)((analog_seed >> 16) % (2 * amplitude + 1)) - amplitude;
+    }
+    raw += sum / 2;
+    return (uint16_t)(raw < 0 ? 0 : raw > 4095 ? 4095 : raw);
+}
+
+/* Filterkette allein: Rauschen, Sprung, Anschläge, Rampe */
+static int analog_filter_cases(void)
+{
+    analog_filter_cfg_t cfg = analog_test_cfg();
+    analog_filter_t f;
+    int failed = 0;
+
+    // Rauschen: Streuung vor und nach dem Filter, Wertwechsel trotz Hysterese
+    analog_filter_init(&f, &cfg);
+    double in_sq = 0, out_sq = 0;
+    int outputs = 0;
+    int changes = 0;
+    uint16_t last = 0;
+    for (int i = 0; i < 4000; i++)
+    {
+        uint16_t raw = analog_noisy(2048, 40);
+        double d = raw - 2048.0;
+        in_sq += d * d;
+        if (!analog_filter_push(&f, raw))
+            continue;
+        if (++outputs == 1)
+        {
+            last = f.value;
+            continue;
+        }
+        double o = (double)f.level / (1 << ANALOG_LEVEL_SHIFT) - 2048.0;
+        out_sq += o * o;
+        if (f.value != last)
+            changes++;
+        last = f.value;
+    }
+    double in_rms = sqrt(in_sq / 4000);
+    double out_rms = sqrt(out_sq / (outputs - 1));
+    printf("noise: in=%.1fLSB out=%.2fLSB reduction=%.1fx value_changes=%d/%d\n",
+           in_rms, out_rms, in_rms / out_rms, changes, outputs - 1);
+    if (in_rms / out_rms < 4.0 || changes > outputs / 100)
+        failed++;
+
+    // Sprung: Zeit bis 95 % und bis der gemeldete Wert innerhalb der Hysterese liegt
+    analog_filter_init(&f, &cfg);
+    for (int i = 0; i < ANALOG_OVERSAMPLE; i++)
+        analog_filter_push(&f, 500);
+    double from = analog_expected(500), to = analog_expected(3500);
+    int t95 = -1, settle = -1;
+    for (int n = 1; n <= 100; n++)
+    {
+        for (int i = 0; i < ANALOG_OVERSAMPLE; i++)
+            analog_filter_push(&f, 3500);
+        double pos = analog_filter_position(&f);
+        if (t95 < 0 && pos - from >= 0.95 * (to - from))
+            t95 = n;
+        if (settle < 0 && fabs(f.value - to) <= ANALOG_HYSTERESIS)
+            settle = n;
+    }
+    printf("step: 95%%=%dms settled=%dms (value %u, expected %.0f)\n",
+           t95 * 1000 / ANALOG_RATE_HZ, settle * 1000 / ANALOG_RATE_HZ, f.value, to);
+    if (t95 < 0 || t95 * 1000 / ANALOG_RATE_HZ > 150 || settle < 0)
+        failed++;
+
+    // Anschläge und Totzone
+    static const struct
+    {
+        int raw;
+        uint16_t expect;
+    } ends[] = {
+        {0, 0},
+        {ANALOG_RAW_MIN, 0},
+        {ANALOG_RAW_MIN + 30, 0}, // in der Totzone
+        {ANALOG_RAW_MAX - 30, ANALOG_FULL_SCALE},
+        {ANALOG_RAW_MAX, ANALOG_FULL_SCALE},
+        {4095, ANALOG_FULL_SCALE},
+        {(ANALOG_RAW_MIN + ANALOG_RAW_MAX) / 2, ANALOG_FULL_SCALE / 2},
+    };
+    for (size_t c = 0; c < sizeof(ends) / sizeof(ends[0]); c++)
+    {
+        analog_filter_init(&f, &cfg);
+        for (int i = 0; i < ANALOG_OVERSAMPLE; i++)
+            analog_filter_push(&f, (uint16_t)ends[c].raw);
+        bool ok = abs((int)f.value - (int)ends[c].expect) <= 1;
+        printf("end %d: raw=%4d value=%4u %s\n", (int)c, ends[c].raw, f.value, ok ? "ok" : "FAIL");
+        if (!ok)
+            failed++;
+    }
+
+    // Rampe über den ganzen Weg mit Rauschen: monoton, beide Anschläge erreicht
+    analog_filter_init(&f, &cfg);
+    int reversals = 0;
+    uint16_t lo = ANALOG_FULL_SCALE, hi = 0;
+    last = 0;
+    for (int raw = 0; raw <= 4095; raw += 2)
+    {
+        if (!analog_filter_push(&f, analog_noisy(raw, 20)))
+            continue;
+        if (f.value < last)
+            reversals++;
+        last = f.value;
+        if (f.value < lo)
+            lo = f.value;
+        if (f.value > hi)
+            hi = f.value;
+    }
+    printf("ramp: min=%u max=%u reversals=%d\n", lo, hi, reversals);
+    if (lo != 0 || hi != ANALOG_FULL_SCALE || reversals)
+        failed++;
+
+    return failed;
+}
+
+static int run_analog(void)
+{
+    static const int levels[ANALOG_CHANNELS] = {ANALOG_RAW_MIN, 1200, 2048, ANALOG_RAW_MAX};
+    analog_snapshot_t snap;
+    int failed = analog_filter_cases();
+
+    // Im Idle tastet niemand ab
+    sim_run_ms(song_length_ms(win95_true_boot, win95_true_boot_len) + 500);
+    if (analog_read(&snap) || sim_adc_conversions() != 0)
+    {
+        printf("sampling in IDLE_MODE\n");
+        failed++;
+    }
+
+    for (int ch = 0; ch < ANALOG_CHANNELS; ch++)
+    {
+        sim_set_adc(ch, levels[ch]);
+        sim_set_adc_noise(ch, 40);
+    }
+
+    // IDLE -> BEEP: Abtastung läuft
+    sim_press(sim_now_us() + 10000, IN_LED_PIN, 80, false);
+    sim_run_ms(1500);
+
+    // Je eine Sekunde ohne Eingaben mit und ohne Abtastung: die Schleife
+    // muss gleich oft laufen, die Abtastung weckt sie nie
+    uint64_t loops = loop_cost.loops;
+    uint64_t conv = sim_adc_conversions();
+    sim_run_ms(1000);
+    uint64_t loops_sampling = loop_cost.loops - loops;
+    conv = sim_adc_conversions() - conv;
+
+    analog_enable(false);
+    loops = loop_cost.loops;
+    sim_run_ms(1000);
+    uint64_t loops_quiet = loop_cost.loops - loops;
+    analog_enable(true);
+    sim_run_ms(100);
+
+    if (!analog_read(&snap))
+    {
+        printf("no analog snapshot\n");
+        return failed + 1;
+    }
+
+    for (int ch = 0; ch < ANALOG_CHANNELS; ch++)
+    {
+        double expect = analog_expected(levels[ch]);
+        bool ok = fabs(snap.value[ch] - expect) <= ANALOG_HYSTERESIS;
+        printf("channel %d: raw=%4d value=%4u expected=%.0f %s\n",
+               ch, levels[ch], snap.value[ch], expect, ok ? "ok" : "FAIL");
+        if (!ok)
+            failed++;
+    }
+
+    // Poti drehen: wann sieht ein Leser den neuen Wert?
+    uint64_t t0 = sim_now_us();
+    sim_set_adc(1, 3000);
+    double target = analog_expected(3000);
+    uint64_t seen_us = 0;
+    while (sim_now_us() - t0 < 500000)
+    {
+        sim_run_ms(1);
+        analog_read(&snap);
+        if (!seen_us && fabs(snap.value[1] - target) <= ANALOG_HYSTERESIS)
+            seen_us = sim_now_us() - t0;
+    }
+
+    const analog_stats_t *st = analog_stats();
+    printf("analog: rounds=%u conversions=%llu/s overruns=%u ui_loops=%llu/s (%llu/s without) turn_to_value=%llums\n",
+           (unsigned)st->rounds, (unsigned long long)conv, (unsigned)st->overruns,
+           (unsigned long long)loops_sampling, (unsigned long long)loops_quiet,
+           (unsigned long long)seen_us / 1000);
+
+    if (conv != ANALOG_RATE_HZ * ANALOG_CHANNELS * ANALOG_OVERSAMPLE || st->overruns ||
+        loops_sampling != loops_quiet || !seen_us || seen_us > 200000)
+        failed++;
+
+    return failed;
+}
+
+/* ===================== Szenario: synth ===================== */
+
+static int run_synth(const char *wav)
+{
+    // C-Dur-Akkord über einer Basslinie, dazu ein kurzer Effekt obendrauf
+    static const uint32_t bass[4] = {131, 98, 110, 87}; // C3 G2 A2 F2
+    int failed = 0;
+
+    sim_run_ms(3000); // Startsong am Buzzer ausklingen lassen
+    playbox_hw_need(PLAYBOX_HW_AUDIO); // im Idle startet sonst niemand den DAC
+    sim_audio_capture(true);
+
+    for (int bar = 0; bar < 4; bar++)
+    {
+        synth_play(bass[bar], 480, SYNTH_WAVE_SAW, 80);
+        if (bar % 2 == 0)
+        {
+            synth_play(262, 900, SYNTH_WAVE_TRIANGLE, 56);
+            synth_play(330, 900, SYNTH_WAVE_TRIANGLE, 56);
+            synth_play(392, 900, SYNTH_WAVE_TRIANGLE, 56);
+        }
+        if (bar == 3)
+            synth_play(1568, 60, SYNTH_WAVE_SQUARE, 60);
+        sim_run_ms(500);
+    }
+    sim_run_ms(500);
+
+    const int16_t *pcm;
+    size_t n = sim_audio_samples(&pcm);
+    int32_t peak = 0;
+    size_t clipped = 0;
+    double sum_sq = 0.0;
+    uint32_t hash = 2166136261u; // FNV-1a über die Samples, zum Vergleich zwischen Builds
+
+    for (size_t i = 0; i < n; i++)
+    {
+        int32_t a = pcm[i] < 0 ? -pcm[i] : pcm[i];
+        if (a > peak)
+            peak = a;
+        clipped += pcm[i] == 32767 || pcm[i] == -32768;
+        sum_sq += (double)pcm[i] * pcm[i];
+        hash = (hash ^ (uint16_t)pcm[i]) * 16777619u;
+    }
+
+    const audio_stats_t *st = audio_stats();
+    printf("synth: samples=%zu peak=%d clipped=%zu rms=%.0f hash=%08x\n",
+           n, (int)peak, clipped, n ? sqrt(sum_sq / n) : 0.0, (unsigned)hash);
+    printf("audio: blocks=%u underruns=%u voice_samples=%llu %.1fns/voice-sample voices/core=%u\n",
+           st->blocks, st->underruns, (unsigned long long)st->voice_samples,
+           st->voice_samples ? (double)st->render_cycles / st->voice_samples : 0.0,
+           st->voices_per_core);
+
+    // Der Mix muss hörbar sein und darf im Akkord nicht dauerhaft clippen
+    if (n == 0 || peak == 0 || clipped > n / 100)
+        failed++;
+
+    if (wav && sim_audio_write_wav(wav) != 0)
+        failed++;
+
+    return failed;
+}
+
+/* Aufwachen, Schleifendurchläufe und geschätzter Strom seit sim_power_reset() */
+static void report_power(void)
+{
+    const sim_power_t *pw = sim_power();
+    double span_s = (double)(sim_now_us() - pw->since_us) / 1e6;
+    double sleep = span_s > 0 ? (double)pw->asleep_us / 1e6 / span_s : 0.0;
+
+    if (span_s <= 0)
+        return;
+
+    printf("power: wakeups=%.1f/s loops=%.1f/s light_sleep=%.1f%% est_current=%.1fmA\n",
+           pw->wakeups / span_s, loop_cost.loops / span_s, 100.0 * sleep,
+           sleep * SIM_LIGHT_SLEEP_MA + (1.0 - sleep) * SIM_ACTIVE_MA);
+}
+
+/* Freier Stack (Host-Verbrauch gegen die Target-Stackgröße) und Verzögerungen */
+static void report_tasks(void)
+{
+    const task_stats_t *ts = Playbox_task_stats();
+    const tone_timing_t *tt = Tone_timing_stats();
+
+    printf("tasks: seq_stack_free=%uB analog_stack_free=%uB ui_late_max=%lldus seq_late_max=%lldus seq_dropped=%u\n",
+           (unsigned)ts->seq_stack_free, (unsigned)ts->analog_stack_free, (long long)ts->ui_late_max_us,
+           (long long)tt->max_abs_err_us, (unsigned)sequencer_dropped());
+
+    dlog_stats_t ls;
+    dlog_read_stats(&ls);
+    printf("log: written=%u emitted=%u dropped=%u\n",
+           (unsigned)ls.written, (unsigned)ls.emitted, (unsigned)ls.dropped);
+}
+
+int main(int argc, char **argv)
+{
+    const char *scenario = "session";
+    const char *script = NULL;
+    const char *wav = NULL;
+    const char *trace = NULL;
+    const char *lib = NULL;
+    const char *bytes = NULL;
+    const char *json = NULL;
+    const char *rec = NULL;
+    const char *rec_out = NULL;
+
+    sim_reset();
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-v") == 0)
+            sim_log_enable(true);
+        else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc)
+            sim_load_us = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc)
+            script = argv[++i];
+        else if (strcmp(argv[i], "--wav") == 0 && i + 1 < argc)
+            wav = argv[++i];
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            trace = argv[++i];
+        else if (strcmp(argv[i], "--poll") == 0 && i + 1 < argc)
+            sim_poll_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--lib") == 0 && i + 1 < argc)
+            lib = argv[++i];
+        else if (strcmp(argv[i], "--bytes") == 0 && i + 1 < argc)
+            bytes = argv[++i];
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            json = argv[++i];
+        else if (strcmp(argv[i], "--rec") == 0 && i + 1 < argc)
+            rec = argv[++i];
+        else if (strcmp(argv[i], "--rec-out") == 0 && i + 1 < argc)
+            rec_out = argv[++i];
+        else
+            scenario = argv[i];
+    }
+
+    sim_set_buzzer_pin(BUZZER_PIN);
+    // library prüft das Test-Image: dieselben Lieder gepackt und als SMF
+    if (!lib)
+        lib = strcmp(scenario, "library") == 0 ? PLAYBOX_SONGLIB_TEST_IMAGE : PLAYBOX_SONGLIB_IMAGE;
+    if (sim_partition_load(SONGLIB_PARTITION_LABEL, SONGLIB_PARTITION_SUBTYPE, lib) != 0)
+        fprintf(stderr, "cannot load song library %s\n", lib);
+
+    // Kette nur für players, alle anderen Szenarien laufen mit P1 und P2
+    if (strcmp(scenario, "players") == 0)
+        sim_chain_connect(PLAYBOX_CHAIN_PLAYERS);
+
+    playbox_init();
+    sim_power_reset();
+
+    if (strcmp(scenario, "songs") == 0)
+    {
+        run_songs();
+    }
+    else if (strcmp(scenario, "session") == 0)
+    {
+        if (run_session(script) != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "quiz") == 0)
+    {
+        if (run_quiz() != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "synth") == 0)
+    {
+        if (run_synth(wav) != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "idle") == 0)
+    {
+        run_idle();
+    }
+    else if (strcmp(scenario, "bounce") == 0)
+    {
+        if (run_bounce(trace) != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "library") == 0)
+    {
+        if (run_library() != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "midiin") == 0)
+    {
+        if (run_midiin(bytes) != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "notes") == 0)
+    {
+        if (run_notes() != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "voices") == 0)
+    {
+        if (run_voices() != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "record") == 0)
+    {
+        if (run_record(rec, rec_out) != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "players") == 0)
+    {
+        if (run_players() != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "analog") == 0)
+    {
+        if (run_analog() != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "profile") == 0)
+    {
+        if (run_profile() != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "boot") == 0)
+    {
+        if (run_boot() != 0)
+            return 1;
+    }
+    else if (strcmp(scenario, "bench") == 0)
+    {
+        // Nur JSON, ohne die Textberichte unten
+        return run_bench(json) != 0;
+    }
+    else
+    {
+        fprintf(stderr, "unknown scenario: %s\n", scenario);
+        return 1;
+    }
+
+    report_leds();
+    report_power();
+    report_tasks();
+
+    printf("loop cost: loops=%llu mean=%.0fns max=%lluns\n",
+           (unsigned long long)loop_cost.loops,
+           loop_cost.loops ? (double)loop_cost.total_ns / loop_cost.loops : 0.0,
+           (unsigned long long)loop_cost.max_ns);
+
+    return 0;
+}
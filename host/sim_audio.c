@@ -0,0 +1,177 @@
+/*
+ * Host-Ersatz für main/audio.c: statt I2S-DMA holt ein esp_timer im Takt der
+ * Abtastrate Block für Block aus synth_render(). Auf Wunsch wird die
+ * Mixer-Ausgabe mitgeschnitten und als WAV geschrieben.
+ *
+ * Wie der Audio-Task parkt die Ausgabe nach AUDIO_IDLE_BLOCKS stillen
+ * Blöcken und gibt die PM-Sperre frei; synth_play() weckt sie wieder.
+ *
+ * render_cycles zählt hier Host-Nanosekunden, voices_per_core bezieht sich
+ * damit auf einen Host-Kern (1 ns = 1 Zyklus bei 1 GHz).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_timer.h"
+
+#include "audio.h"
+#include "synth.h"
+#include "power.h"
+#include "sim_hal.h"
+
+#define AUDIO_IDLE_BLOCKS 2 // = DMA-Puffer in audio.c
+
+static audio_stats_t stats;
+static esp_timer_handle_t block_timer = NULL;
+static uint64_t start_us;
+static uint32_t run_blocks;
+static int silent;
+
+static int16_t *capture = NULL;
+static size_t capture_len = 0;
+static size_t capture_cap = 0;
+static bool capture_on = false;
+
+static uint64_t host_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Zeitpunkt, an dem die DMA Block @n anfordert */
+static uint64_t block_deadline_us(uint32_t n)
+{
+    return start_us + (uint64_t)n * SYNTH_BLOCK * 1000000ULL / SYNTH_SAMPLE_RATE;
+}
+
+static void block_timer_cb(void *arg)
+{
+    int16_t block[SYNTH_BLOCK];
+
+    (void)arg;
+
+    uint64_t t0 = host_ns();
+    int voices = synth_render(block, SYNTH_BLOCK);
+    uint64_t ns = host_ns() - t0;
+
+    stats.blocks++;
+    run_blocks++;
+    stats.render_cycles += ns;
+    stats.voice_samples += (uint64_t)voices * SYNTH_BLOCK;
+    if (ns > stats.render_cycles_max)
+        stats.render_cycles_max = (uint32_t)ns;
+
+    if (capture_on)
+    {
+        if (capture_len + SYNTH_BLOCK > capture_cap)
+        {
+            capture_cap = capture_cap ? 2 * capture_cap : 64 * SYNTH_BLOCK;
+            capture = realloc(capture, capture_cap * sizeof(int16_t));
+            if (!capture)
+                abort();
+        }
+        memcpy(&capture[capture_len], block, sizeof(block));
+        capture_len += SYNTH_BLOCK;
+    }
+
+    silent = voices == 0 ? silent + 1 : 0;
+    if (silent >= AUDIO_IDLE_BLOCKS)
+    {
+        silent = 0;
+        power_release(POWER_LOCK_SYNTH);
+        return;
+    }
+
+    esp_timer_start_once(block_timer, block_deadline_us(run_blocks) - sim_now_us());
+}
+
+/* synth_play(): geparkte Ausgabe sofort mit dem ersten Block starten */
+static void audio_wake(void)
+{
+    if (power_held(POWER_LOCK_SYNTH))
+        return;
+
+    power_acquire(POWER_LOCK_SYNTH);
+    start_us = sim_now_us();
+    run_blocks = 0;
+    silent = 0;
+    esp_timer_start_once(block_timer, 0);
+}
+
+void audio_init(void)
+{
+    const esp_timer_create_args_t args = {
+        .callback = block_timer_cb,
+        .name = "audio",
+    };
+
+    sim_advance_us(SIM_COST_I2S_INSTALL_US); // i2s_driver_install() auf dem Target
+    synth_init();
+    memset(&stats, 0, sizeof(stats));
+
+    esp_timer_create(&args, &block_timer);
+    synth_set_wake(audio_wake);
+}
+
+TaskHandle_t audio_task(void)
+{
+    return NULL; // Blöcke kommen vom Timer
+}
+
+const audio_stats_t *audio_stats(void)
+{
+    stats.voices_per_core = audio_voices_per_core(&stats, 1000000000U, SYNTH_SAMPLE_RATE);
+    return &stats;
+}
+
+void sim_audio_capture(bool enable)
+{
+    capture_on = enable;
+    capture_len = 0;
+}
+
+size_t sim_audio_samples(const int16_t **samples)
+{
+    *samples = capture;
+    return capture_len;
+}
+
+static void put_le(FILE *f, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        fputc((int)((v >> (8 * i)) & 0xff), f);
+}
+
+int sim_audio_write_wav(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        perror(path);
+        return -1;
+    }
+
+    uint32_t data_bytes = (uint32_t)(capture_len * sizeof(int16_t));
+
+    fwrite("RIFF", 1, 4, f);
+    put_le(f, 36 + data_bytes, 4);
+    fwrite("WAVEfmt ", 1, 8, f);
+    put_le(f, 16, 4);
+    put_le(f, 1, 2); // PCM
+    put_le(f, 1, 2); // mono
+    put_le(f, SYNTH_SAMPLE_RATE, 4);
+    put_le(f, SYNTH_SAMPLE_RATE * 2, 4);
+    put_le(f, 2, 2);
+    put_le(f, 16, 2);
+    fwrite("data", 1, 4, f);
+    put_le(f, data_bytes, 4);
+    for (size_t i = 0; i < capture_len; i++)
+        put_le(f, (uint16_t)capture[i], 2);
+
+    fclose(f);
+    return 0;
+}
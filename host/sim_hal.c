@@ -0,0 +1,1600 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "driver/adc.h"
+#include "driver/dac.h"
+#include "driver/uart.h"
+#include "driver/spi_master.h"
+#include "hal/uart_ll.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_partition.h"
+#include "nvs_flash.h"
+#include "hal/gpio_ll.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "sdkconfig.h"
+
+#include "sim_hal.h"
+
+#define SIM_US_PER_TICK (1000000ULL / configTICK_RATE_HZ)
+#define SIM_MAX_PENDING_PRESSES 16
+#define SIM_MAX_TIMERS 16
+#define SIM_UART_FIFO_LEN 128
+
+/* Tickless Idle schläft erst ab dieser Leerlaufzeit */
+#define SIM_IDLE_BEFORE_SLEEP_US (CONFIG_FREERTOS_IDLE_TIME_BEFORE_SLEEP * SIM_US_PER_TICK)
+
+/* Konsole: 115200 Baud, 10 Bit pro Zeichen */
+#define SIM_UART_NS_PER_CHAR (10ULL * 1000000000ULL / 115200ULL)
+#define SIM_APB_HZ 80000000ULL // Takt der High-Speed-LEDC-Timer
+#define SIM_LEDC_DIV_MIN 0x100   // 10.8-Teiler 1.0 .. 1023.996
+#define SIM_LEDC_DIV_MAX 0x3ffff
+
+typedef struct
+{
+    uint64_t at_us;
+    gpio_num_t pin;
+    int level;
+    bool expect_tone;
+    bool uart;    // Byte auf einer UART-RX-Leitung statt Pegelwechsel
+    uint8_t byte;
+    bool chain;   // Eingang @pin der Schieberegister-Kette statt GPIO
+} sim_pin_event_t;
+
+typedef struct
+{
+    gpio_isr_t handler;
+    void *arg;
+    gpio_int_type_t intr_type;
+    bool pending; // Pegel-Interrupt während der ISR erneut ausgelöst
+} sim_gpio_isr_t;
+
+/* Nur RX: FIFO, Interrupt-Status und die registrierte ISR */
+struct sim_uart_dev
+{
+    int baud;
+    int rx_pin;
+    uint32_t int_ena;
+    uint32_t int_raw;
+    uint8_t full_thresh;
+    uint8_t fifo[SIM_UART_FIFO_LEN];
+    int head;
+    int count;
+    void (*isr)(void *arg);
+    void *isr_arg;
+};
+
+struct esp_pm_lock
+{
+    int count;
+};
+
+/* Ein Gerät am SPI-Bus; am Bus hängt höchstens die Schieberegister-Kette */
+struct sim_spi_device
+{
+    spi_host_device_t host;
+    int cs_pin;
+    uint32_t flags;
+    bool used;
+};
+
+struct gpio_dev_s
+{
+    int unused;
+};
+
+gpio_dev_t GPIO;
+
+struct esp_timer
+{
+    esp_timer_cb_t callback;
+    void *arg;
+    uint64_t deadline_us;
+    uint64_t period_us; // 0 = one-shot
+    bool armed;
+};
+
+typedef struct
+{
+    bool configured;       // ledc_channel_config() gelaufen
+    int gpio_num;
+    ledc_timer_t timer;
+    uint32_t duty;         // per ledc_set_duty gesetzt
+    uint32_t applied_duty; // per ledc_update_duty übernommen
+    uint32_t applied_res;  // Auflösung des Timers, als applied_duty galt
+
+    uint32_t fade_target;  // per ledc_set_fade_with_time/_step gesetzt
+    uint64_t fade_len_us;
+    uint32_t fade_from;    // laufende Hardware-Rampe
+    uint64_t fade_start_us;
+    uint64_t fade_end_us;
+} sim_ledc_channel_t;
+
+static struct
+{
+    uint64_t now_us;
+
+    int levels[GPIO_NUM_MAX];
+    sim_gpio_isr_t isr[GPIO_NUM_MAX];
+    bool isr_service;
+    int in_isr; // Pin der laufenden ISR, -1 = keine
+
+    sim_pin_event_t events[SIM_MAX_PIN_EVENTS];
+    int event_count;
+
+    struct esp_timer timers[SIM_MAX_TIMERS];
+    int timer_count;
+
+    struct sim_uart_dev uart[UART_NUM_MAX];
+
+    bool spi_bus[SPI3_HOST + 1];
+    int spi_miso[SPI3_HOST + 1];
+    struct sim_spi_device spi_dev;
+    bool pulldown[GPIO_NUM_MAX];
+    int chain_bits;        // angeschlossene Eingänge, 0 = keine Kette
+    uint32_t chain_levels; // Bit n = Eingang n, 1 = losgelassen
+    uint32_t spi_transfers;
+
+    sim_ledc_channel_t channels[LEDC_SPEED_MODE_MAX][LEDC_CHANNEL_MAX];
+    double timer_freq[LEDC_SPEED_MODE_MAX][LEDC_TIMER_MAX];
+    uint32_t timer_res[LEDC_SPEED_MODE_MAX][LEDC_TIMER_MAX];
+    bool freq_dirty;
+    uint32_t fade_conflicts;
+    uint32_t buzzer_clicks;
+
+    bool light_sleep;
+    int pm_locks_held;
+    struct esp_pm_lock pm_locks[8];
+    int pm_lock_count;
+    uint64_t last_wake_us;
+    sim_power_t power;
+
+    int adc_raw[ADC1_CHANNEL_MAX];
+    int adc_noise[ADC1_CHANNEL_MAX];
+    uint32_t adc_seed;
+    uint64_t adc_conversions;
+    uint8_t dac[DAC_CHANNEL_MAX];
+
+    gpio_num_t buzzer_pin;
+    sim_note_t notes[SIM_MAX_NOTES];
+    int note_count;
+    bool note_active;
+
+    uint64_t pending_press[SIM_MAX_PENDING_PRESSES];
+    int pending_count;
+    sim_latency_t latency;
+
+    uint32_t bounce_seed;
+    bool log_enabled;
+} sim;
+
+/* ===================== Uhr ===================== */
+
+void sim_reset(void)
+{
+    memset(&sim, 0, sizeof(sim));
+
+    for (int i = 0; i < GPIO_NUM_MAX; i++)
+        sim.levels[i] = 1; // Pull-ups: Taster offen
+
+    sim.buzzer_pin = GPIO_NUM_NC;
+    sim.in_isr = -1;
+
+    for (int u = 0; u < UART_NUM_MAX; u++)
+        sim.uart[u].rx_pin = UART_PIN_NO_CHANGE;
+}
+
+/* ===================== Wakeups / Light Sleep ===================== */
+
+/*
+ * Die CPU ist zwischen zwei Aktivitäten (ISR, Timer-Callback, Ablauf eines
+ * Timeouts) untätig. Ohne gehaltene PM-Sperre und ab
+ * SIM_IDLE_BEFORE_SLEEP_US Leerlauf zählt die Lücke als Light Sleep.
+ */
+static void sim_wake(void)
+{
+    if (sim.now_us == sim.last_wake_us)
+        return;
+
+    uint64_t gap = sim.now_us - sim.last_wake_us;
+    if (sim.light_sleep && sim.pm_locks_held == 0 && gap >= SIM_IDLE_BEFORE_SLEEP_US)
+        sim.power.asleep_us += gap;
+
+    sim.power.wakeups++;
+    sim.last_wake_us = sim.now_us;
+}
+
+void sim_power_reset(void)
+{
+    memset(&sim.power, 0, sizeof(sim.power));
+    sim.power.since_us = sim.now_us;
+    sim.last_wake_us = sim.now_us;
+}
+
+const sim_power_t *sim_power(void)
+{
+    return &sim.power;
+}
+
+void sim_note_wakeup(void)
+{
+    sim_wake();
+}
+
+uint64_t sim_now_us(void)
+{
+    return sim.now_us;
+}
+
+static void sim_expire_presses(void)
+{
+    int kept = 0;
+
+    for (int i = 0; i < sim.pending_count; i++)
+    {
+        if (sim.now_us - sim.pending_press[i] > SIM_PRESS_TIMEOUT_US)
+            sim.latency.missed++;
+        else
+            sim.pending_press[kept++] = sim.pending_press[i];
+    }
+
+    sim.pending_count = kept;
+}
+
+/* ISR ausführen; Pegel-Interrupts feuern erneut, solange der Pegel passt */
+static void sim_gpio_fire(gpio_num_t pin)
+{
+    sim_gpio_isr_t *isr = &sim.isr[pin];
+
+    if (!isr->handler)
+        return;
+
+    sim_wake();
+
+    do
+    {
+        isr->pending = false;
+        sim.in_isr = pin;
+        isr->handler(isr->arg);
+        sim.in_isr = -1;
+    } while (isr->pending);
+}
+
+static bool sim_level_active(gpio_num_t pin)
+{
+    gpio_int_type_t t = sim.isr[pin].intr_type;
+    return (t == GPIO_INTR_LOW_LEVEL && sim.levels[pin] == 0) ||
+           (t == GPIO_INTR_HIGH_LEVEL && sim.levels[pin] == 1);
+}
+
+static void sim_uart_fire(struct sim_uart_dev *u)
+{
+    if (!u->isr || !(u->int_raw & u->int_ena))
+        return;
+
+    sim_wake();
+    u->isr(u->isr_arg);
+}
+
+/* Byte ist mit dem Stoppbit komplett im RX-FIFO angekommen */
+static void sim_uart_rx(const sim_pin_event_t *ev)
+{
+    if (ev->expect_tone && sim.pending_count < SIM_MAX_PENDING_PRESSES)
+        sim.pending_press[sim.pending_count++] = ev->at_us;
+
+    for (int n = 0; n < UART_NUM_MAX; n++)
+    {
+        struct sim_uart_dev *u = &sim.uart[n];
+        if (u->rx_pin != ev->pin)
+            continue;
+
+        if (u->count == SIM_UART_FIFO_LEN)
+        {
+            u->int_raw |= UART_INTR_RXFIFO_OVF;
+        }
+        else
+        {
+            u->fifo[(u->head + u->count) % SIM_UART_FIFO_LEN] = ev->byte;
+            u->count++;
+        }
+
+        if (u->count >= u->full_thresh)
+            u->int_raw |= UART_INTR_RXFIFO_FULL;
+        sim_uart_fire(u);
+    }
+}
+
+static void sim_apply_event(const sim_pin_event_t *ev)
+{
+    if (ev->uart)
+    {
+        sim_uart_rx(ev);
+        return;
+    }
+
+    // Die Kette hat keinen Interrupt: nur der Pegel für den nächsten SPI-Lesezugriff
+    if (ev->chain)
+    {
+        uint32_t bit = 1u << ev->pin;
+        sim.chain_levels = ev->level ? sim.chain_levels | bit : sim.chain_levels & ~bit;
+        if (ev->level == 0 && ev->expect_tone && sim.pending_count < SIM_MAX_PENDING_PRESSES)
+            sim.pending_press[sim.pending_count++] = ev->at_us;
+        return;
+    }
+
+    int old = sim.levels[ev->pin];
+    sim.levels[ev->pin] = ev->level;
+
+    if (ev->level == 0 && ev->expect_tone && sim.pending_count < SIM_MAX_PENDING_PRESSES)
+        sim.pending_press[sim.pending_count++] = ev->at_us;
+
+    if (old == ev->level || !sim.isr_service)
+        return;
+
+    // GPIO-Interrupt synchron "auslösen"
+    const sim_gpio_isr_t *isr = &sim.isr[ev->pin];
+    bool fire = isr->intr_type == GPIO_INTR_ANYEDGE ||
+                (isr->intr_type == GPIO_INTR_NEGEDGE && ev->level == 0) ||
+                (isr->intr_type == GPIO_INTR_POSEDGE && ev->level == 1) ||
+                (isr->intr_type == GPIO_INTR_LOW_LEVEL && ev->level == 0) ||
+                (isr->intr_type == GPIO_INTR_HIGH_LEVEL && ev->level == 1);
+
+    if (fire)
+        sim_gpio_fire(ev->pin);
+}
+
+static struct esp_timer *sim_next_timer(void)
+{
+    struct esp_timer *next = NULL;
+
+    for (int i = 0; i < sim.timer_count; i++)
+    {
+        struct esp_timer *t = &sim.timers[i];
+        if (t->armed && (!next || t->deadline_us < next->deadline_us))
+            next = t;
+    }
+
+    return next;
+}
+
+uint64_t sim_next_event_us(void)
+{
+    uint64_t next = sim.event_count > 0 ? sim.events[0].at_us : UINT64_MAX;
+    struct esp_timer *timer = sim_next_timer();
+
+    if (timer && timer->deadline_us < next)
+        next = timer->deadline_us;
+
+    return next;
+}
+
+/* Nächstes fälliges Ereignis entnehmen und ausführen; Pins vor Timern */
+static void sim_dispatch_next(void)
+{
+    struct esp_timer *timer = sim_next_timer();
+
+    if (sim.event_count > 0 && (!timer || sim.events[0].at_us <= timer->deadline_us))
+    {
+        sim_pin_event_t ev = sim.events[0];
+        memmove(sim.events, sim.events + 1,
+                (size_t)(sim.event_count - 1) * sizeof(sim_pin_event_t));
+        sim.event_count--;
+        sim_apply_event(&ev);
+        return;
+    }
+
+    if (timer->period_us)
+        timer->deadline_us += timer->period_us;
+    else
+        timer->armed = false;
+
+    sim_wake();
+    timer->callback(timer->arg);
+}
+
+void sim_advance_us(uint64_t us)
+{
+    uint64_t target = sim.now_us + us;
+
+    // Callbacks dürfen selbst Zeit verbrauchen (z.B. ESP_LOGx) und damit
+    // rekursiv vorrücken; die Uhr läuft dabei nie rückwärts
+    for (;;)
+    {
+        uint64_t next = sim_next_event_us();
+        if (next > target)
+            break;
+
+        if (next > sim.now_us)
+            sim.now_us = next;
+        sim_dispatch_next();
+    }
+
+    if (target > sim.now_us)
+        sim.now_us = target;
+    sim_expire_presses();
+}
+
+/* ===================== esp_timer ===================== */
+
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t)sim.now_us;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args,
+                           esp_timer_handle_t *out_handle)
+{
+    if (sim.timer_count >= SIM_MAX_TIMERS)
+        return ESP_ERR_NO_MEM;
+
+    struct esp_timer *t = &sim.timers[sim.timer_count++];
+    *t = (struct esp_timer){.callback = create_args->callback, .arg = create_args->arg};
+    *out_handle = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    if (timer->armed)
+        return ESP_ERR_INVALID_STATE;
+
+    timer->deadline_us = sim.now_us + timeout_us;
+    timer->period_us = 0;
+    timer->armed = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    if (timer->armed)
+        return ESP_ERR_INVALID_STATE;
+
+    timer->deadline_us = sim.now_us + period;
+    timer->period_us = period;
+    timer->armed = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer->armed)
+        return ESP_ERR_INVALID_STATE;
+
+    timer->armed = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    timer->armed = false;
+    timer->callback = NULL;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+    return timer->armed;
+}
+
+/* ===================== Eingaben ===================== */
+
+static void sim_insert_event(sim_pin_event_t ev)
+{
+    if (sim.event_count >= SIM_MAX_PIN_EVENTS)
+    {
+        fprintf(stderr, "sim: pin event queue full\n");
+        return;
+    }
+
+    int i = sim.event_count;
+    while (i > 0 && sim.events[i - 1].at_us > ev.at_us)
+    {
+        sim.events[i] = sim.events[i - 1];
+        i--;
+    }
+
+    sim.events[i] = ev;
+    sim.event_count++;
+}
+
+void sim_set_pin(gpio_num_t pin, int level)
+{
+    sim_pin_event_t ev = {.at_us = sim.now_us, .pin = pin, .level = level};
+    sim_apply_event(&ev);
+}
+
+void sim_schedule_pin(uint64_t at_us, gpio_num_t pin, int level)
+{
+    sim_insert_event((sim_pin_event_t){.at_us = at_us, .pin = pin, .level = level});
+}
+
+void sim_press(uint64_t at_us, gpio_num_t pin, uint32_t hold_ms, bool expect_tone)
+{
+    sim_insert_event((sim_pin_event_t){
+        .at_us = at_us, .pin = pin, .level = 0, .expect_tone = expect_tone});
+    sim_insert_event((sim_pin_event_t){
+        .at_us = at_us + (uint64_t)hold_ms * 1000, .pin = pin, .level = 1});
+}
+
+/* Prellen wie bei Mikroschaltern: Zwischenflanken im Abstand 100..700 µs */
+static uint64_t sim_schedule_bounce(uint64_t at_us, gpio_num_t pin, int level, int bounces,
+                                    bool expect_tone)
+{
+    uint64_t t = at_us;
+
+    sim_insert_event((sim_pin_event_t){.at_us = t, .pin = pin, .level = level, .expect_tone = expect_tone});
+    for (int i = 0; i < 2 * bounces; i++)
+    {
+        sim.bounce_seed = sim.bounce_seed * 1103515245u + 12345u;
+        t += 100 + (sim.bounce_seed >> 16) % 600;
+        sim_insert_event((sim_pin_event_t){.at_us = t, .pin = pin, .level = (i % 2) ? level : !level});
+    }
+
+    return t;
+}
+
+void sim_press_bounce(uint64_t at_us, gpio_num_t pin, uint32_t hold_ms, int bounces, bool expect_tone)
+{
+    sim_schedule_bounce(at_us, pin, 0, bounces, expect_tone);
+    sim_schedule_bounce(at_us + (uint64_t)hold_ms * 1000, pin, 1, bounces, false);
+}
+
+void sim_chain_connect(int bits)
+{
+    sim.chain_bits = bits;
+    sim.chain_levels = ~0u;
+}
+
+void sim_chain_press(uint64_t at_us, int input, uint32_t hold_ms, bool expect_tone)
+{
+    sim_insert_event((sim_pin_event_t){
+        .at_us = at_us, .pin = (gpio_num_t)input, .level = 0, .chain = true, .expect_tone = expect_tone});
+    sim_insert_event((sim_pin_event_t){
+        .at_us = at_us + (uint64_t)hold_ms * 1000, .pin = (gpio_num_t)input, .level = 1, .chain = true});
+}
+
+uint32_t sim_spi_transfers(void)
+{
+    return sim.spi_transfers;
+}
+
+uint64_t sim_uart_send(uint64_t at_us, gpio_num_t rx_pin, int baud, const uint8_t *data, size_t n,
+                       bool expect_tone)
+{
+    // 8N1: 10 Bit pro Byte, Bytes direkt hintereinander
+    uint64_t t = at_us;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        t = at_us + (i + 1) * 10000000ULL / (uint64_t)baud;
+        sim_insert_event((sim_pin_event_t){
+            .at_us = t, .pin = rx_pin, .uart = true, .byte = data[i],
+            .expect_tone = expect_tone && i + 1 == n});
+    }
+
+    return t;
+}
+
+void sim_set_adc(int channel, int raw)
+{
+    sim.adc_raw[channel] = raw;
+}
+
+void sim_set_adc_noise(int channel, int amplitude)
+{
+    sim.adc_noise[channel] = amplitude;
+}
+
+uint64_t sim_adc_conversions(void)
+{
+    return sim.adc_conversions;
+}
+
+uint8_t sim_get_dac(int channel)
+{
+    return sim.dac[channel];
+}
+
+/* ===================== Buzzer-Mitschnitt ===================== */
+
+void sim_set_buzzer_pin(gpio_num_t pin)
+{
+    sim.buzzer_pin = pin;
+}
+
+int sim_note_count(void)
+{
+    return sim.note_count;
+}
+
+const sim_note_t *sim_notes(void)
+{
+    return sim.notes;
+}
+
+const sim_latency_t *sim_latency(void)
+{
+    return &sim.latency;
+}
+
+/* @at_us: Ende einer Release-Rampe kann in der Zukunft liegen */
+static void sim_note_end_at(uint64_t at_us)
+{
+    if (sim.note_active)
+    {
+        sim.notes[sim.note_count - 1].end_us = at_us;
+        sim.note_active = false;
+    }
+}
+
+static void sim_note_end(void)
+{
+    sim_note_end_at(sim.now_us);
+}
+
+static void sim_note_start(double freq_hz)
+{
+    sim_note_end();
+
+    for (int i = 0; i < sim.pending_count; i++)
+    {
+        if (sim.latency.count < SIM_MAX_LATENCIES)
+            sim.latency.latency_us[sim.latency.count++] = sim.now_us - sim.pending_press[i];
+    }
+    sim.pending_count = 0;
+
+    if (sim.note_count >= SIM_MAX_NOTES)
+        return;
+
+    sim.notes[sim.note_count++] = (sim_note_t){.start_us = sim.now_us, .freq_hz = freq_hz};
+    sim.note_active = true;
+}
+
+/* ===================== GPIO ===================== */
+
+esp_err_t gpio_config(const gpio_config_t *pGPIOConfig)
+{
+    sim_advance_us(SIM_COST_GPIO_CONFIG_US);
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++)
+    {
+        if (pGPIOConfig->pin_bit_mask & (1ULL << pin))
+            sim.isr[pin].intr_type = pGPIOConfig->intr_type;
+    }
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX)
+        return 0;
+
+    return sim.levels[gpio_num];
+}
+
+/* GPIO_IN_REG/GPIO_IN1_REG aus den simulierten Pegeln zusammensetzen */
+uint32_t sim_reg_read(uint32_t addr)
+{
+    uint32_t word = 0;
+    int base;
+
+    if (addr == GPIO_IN_REG)
+        base = 0;
+    else if (addr == GPIO_IN1_REG)
+        base = 32;
+    else
+    {
+        fprintf(stderr, "sim: unknown register 0x%08x\n", (unsigned)addr);
+        abort();
+    }
+
+    for (int i = 0; i < 32 && base + i < GPIO_NUM_MAX; i++)
+        word |= (uint32_t)(sim.levels[base + i] != 0) << i;
+    return word;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    sim.levels[gpio_num] = level ? 1 : 0;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    sim.isr[gpio_num].intr_type = intr_type;
+
+    // Pegel-Interrupt mit bereits passendem Pegel löst sofort aus
+    if (sim.isr_service && sim_level_active(gpio_num))
+    {
+        if (sim.in_isr == gpio_num)
+            sim.isr[gpio_num].pending = true;
+        else
+            sim_gpio_fire(gpio_num);
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    // Wie auf dem ESP32: Wakeup nutzt den Interrupt-Typ des Pins
+    if (intr_type != GPIO_INTR_LOW_LEVEL && intr_type != GPIO_INTR_HIGH_LEVEL)
+        return ESP_ERR_INVALID_ARG;
+
+    return gpio_set_intr_type(gpio_num, intr_type);
+}
+
+esp_err_t gpio_pulldown_en(gpio_num_t gpio_num)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    sim.pulldown[gpio_num] = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t domain, esp_sleep_pd_option_t option)
+{
+    (void)domain;
+    (void)option;
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+    sim_advance_us(SIM_COST_INTR_ALLOC_US);
+    (void)intr_alloc_flags;
+
+    if (sim.isr_service)
+        return ESP_ERR_INVALID_STATE;
+
+    sim.isr_service = true;
+    return ESP_OK;
+}
+
+void gpio_uninstall_isr_service(void)
+{
+    sim.isr_service = false;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+    if (!sim.isr_service)
+        return ESP_ERR_INVALID_STATE;
+
+    sim.isr[gpio_num].handler = isr_handler;
+    sim.isr[gpio_num].arg = args;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num)
+{
+    sim.isr[gpio_num].handler = NULL;
+    sim.isr[gpio_num].arg = NULL;
+    return ESP_OK;
+}
+
+/* ===================== UART ===================== */
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config)
+{
+    sim_advance_us(SIM_COST_UART_CONFIG_US);
+    sim.uart[uart_num].baud = uart_config->baud_rate;
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num)
+{
+    (void)tx_io_num;
+    (void)rts_io_num;
+    (void)cts_io_num;
+
+    if (rx_io_num != UART_PIN_NO_CHANGE)
+        sim.uart[uart_num].rx_pin = rx_io_num;
+    return ESP_OK;
+}
+
+esp_err_t uart_intr_config(uart_port_t uart_num, const uart_intr_config_t *intr_conf)
+{
+    sim.uart[uart_num].full_thresh = intr_conf->rxfifo_full_thresh;
+    sim.uart[uart_num].int_ena = intr_conf->intr_enable_mask;
+    return ESP_OK;
+}
+
+esp_err_t uart_enable_intr_mask(uart_port_t uart_num, uint32_t enable_mask)
+{
+    sim.uart[uart_num].int_ena |= enable_mask;
+    sim_uart_fire(&sim.uart[uart_num]);
+    return ESP_OK;
+}
+
+esp_err_t uart_disable_intr_mask(uart_port_t uart_num, uint32_t disable_mask)
+{
+    sim.uart[uart_num].int_ena &= ~disable_mask;
+    return ESP_OK;
+}
+
+esp_err_t uart_clear_intr_status(uart_port_t uart_num, uint32_t clr_mask)
+{
+    sim.uart[uart_num].int_raw &= ~clr_mask;
+    return ESP_OK;
+}
+
+esp_err_t uart_isr_register(uart_port_t uart_num, void (*fn)(void *), void *arg,
+                            int intr_alloc_flags, uart_isr_handle_t *handle)
+{
+    sim_advance_us(SIM_COST_INTR_ALLOC_US);
+    (void)intr_alloc_flags;
+
+    sim.uart[uart_num].isr = fn;
+    sim.uart[uart_num].isr_arg = arg;
+    if (handle)
+        *handle = &sim.uart[uart_num];
+    return ESP_OK;
+}
+
+uart_dev_t *sim_uart_hw(int num)
+{
+    return &sim.uart[num];
+}
+
+uint32_t uart_ll_get_rxfifo_len(uart_dev_t *hw)
+{
+    return (uint32_t)hw->count;
+}
+
+void uart_ll_read_rxfifo(uart_dev_t *hw, uint8_t *buf, uint32_t rd_len)
+{
+    for (uint32_t i = 0; i < rd_len && hw->count > 0; i++)
+    {
+        buf[i] = hw->fifo[hw->head];
+        hw->head = (hw->head + 1) % SIM_UART_FIFO_LEN;
+        hw->count--;
+    }
+
+    if (hw->count < hw->full_thresh)
+        hw->int_raw &= ~UART_INTR_RXFIFO_FULL;
+}
+
+uint32_t uart_ll_get_intsts_mask(uart_dev_t *hw)
+{
+    return hw->int_raw & hw->int_ena;
+}
+
+void uart_ll_clr_intsts_mask(uart_dev_t *hw, uint32_t mask)
+{
+    hw->int_raw &= ~mask;
+}
+
+void uart_ll_rxfifo_rst(uart_dev_t *hw)
+{
+    hw->head = 0;
+    hw->count = 0;
+    hw->int_raw &= ~UART_INTR_RXFIFO_FULL;
+}
+
+/* ===================== SPI ===================== */
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config,
+                             spi_dma_chan_t dma_chan)
+{
+    sim_advance_us(SIM_COST_SPI_BUS_US);
+    (void)dma_chan;
+
+    if (host_id < SPI2_HOST || host_id > SPI3_HOST)
+        return ESP_ERR_INVALID_ARG;
+    if (sim.spi_bus[host_id])
+        return ESP_ERR_INVALID_STATE;
+
+    sim.spi_bus[host_id] = true;
+    sim.spi_miso[host_id] = bus_config->miso_io_num;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host_id)
+{
+    if (host_id < SPI2_HOST || host_id > SPI3_HOST || !sim.spi_bus[host_id])
+        return ESP_ERR_INVALID_STATE;
+    if (sim.spi_dev.used && sim.spi_dev.host == host_id)
+        return ESP_ERR_INVALID_STATE;
+
+    sim.spi_bus[host_id] = false;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config,
+                             spi_device_handle_t *handle)
+{
+    sim_advance_us(SIM_COST_SPI_DEVICE_US);
+    if (host_id < SPI2_HOST || host_id > SPI3_HOST || !sim.spi_bus[host_id])
+        return ESP_ERR_INVALID_STATE;
+    if (sim.spi_dev.used)
+        return ESP_ERR_NOT_FOUND; // ein Gerät reicht für die Kette
+
+    sim.spi_dev = (struct sim_spi_device){
+        .host = host_id, .cs_pin = dev_config->spics_io_num, .flags = dev_config->flags, .used = true};
+    *handle = &sim.spi_dev;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle)
+{
+    if (!handle || !handle->used)
+        return ESP_ERR_INVALID_ARG;
+
+    handle->used = false;
+    return ESP_OK;
+}
+
+/*
+ * 74HC165-Kette: die steigende /PL-Flanke (CS mit SPI_DEVICE_POSITIVE_CS)
+ * friert chain_levels ein, MSB zuerst wird Eingang 0, 1, ... geschoben.
+ * Unbenutzte Eingänge liegen auf high. Ohne Kette liest MISO den Pull-down.
+ */
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc)
+{
+    if (!handle || !handle->used)
+        return ESP_ERR_INVALID_ARG;
+
+    size_t bits = trans_desc->rxlength ? trans_desc->rxlength : trans_desc->length;
+    uint8_t *rx = (trans_desc->flags & SPI_TRANS_USE_RXDATA) ? trans_desc->rx_data : trans_desc->rx_buffer;
+    bool chain = sim.chain_bits > 0 && (handle->flags & SPI_DEVICE_POSITIVE_CS);
+    int miso = sim.spi_miso[handle->host];
+
+    if (!rx || bits % 8)
+        return ESP_ERR_INVALID_ARG;
+
+    for (size_t i = 0; i < bits / 8; i++)
+    {
+        uint8_t byte = 0;
+        for (int b = 0; b < 8; b++)
+        {
+            size_t n = i * 8 + (size_t)b;
+            int level = chain ? (n >= (size_t)sim.chain_bits || ((sim.chain_levels >> n) & 1))
+                              : (miso < 0 || !sim.pulldown[miso]);
+            byte |= (uint8_t)(level << (7 - b));
+        }
+        rx[i] = byte;
+    }
+
+    sim.spi_transfers++;
+    return ESP_OK;
+}
+
+/* ===================== esp_pm ===================== */
+
+esp_err_t esp_pm_configure(const void *config)
+{
+    sim_advance_us(SIM_COST_PM_CONFIG_US);
+    sim.light_sleep = ((const esp_pm_config_esp32_t *)config)->light_sleep_enable;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t lock_type, int arg, const char *name,
+                             esp_pm_lock_handle_t *out_handle)
+{
+    (void)lock_type;
+    (void)arg;
+    (void)name;
+
+    if (sim.pm_lock_count >= (int)(sizeof(sim.pm_locks) / sizeof(sim.pm_locks[0])))
+        return ESP_ERR_NO_MEM;
+
+    *out_handle = &sim.pm_locks[sim.pm_lock_count++];
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle)
+{
+    // Laufende Lücke endet hier: bis jetzt galt der alte Sperrzustand
+    sim_wake();
+    if (handle->count++ == 0)
+        sim.pm_locks_held++;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle)
+{
+    if (handle->count == 0)
+        return ESP_ERR_INVALID_STATE;
+
+    sim_wake();
+    if (--handle->count == 0)
+        sim.pm_locks_held--;
+    return ESP_OK;
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    return code == ESP_OK ? "ESP_OK" : "ESP_ERR";
+}
+
+/* ===================== esp_partition ===================== */
+
+// Eine Datenpartition reicht (Liederbibliothek), bleibt über sim_reset() erhalten
+static esp_partition_t sim_part;
+static uint8_t *sim_part_data = NULL;
+
+int sim_partition_load(const char *label, int subtype, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return -1;
+
+    free(sim_part_data);
+    sim_part_data = malloc(SIM_PARTITION_SIZE);
+    memset(sim_part_data, 0xff, SIM_PARTITION_SIZE);
+
+    size_t n = fread(sim_part_data, 1, SIM_PARTITION_SIZE, f);
+    int extra = fgetc(f);
+    fclose(f);
+    if (extra != EOF || n == 0)
+        return -1;
+
+    sim_part.type = ESP_PARTITION_TYPE_DATA;
+    sim_part.subtype = subtype;
+    sim_part.address = 0x110000;
+    sim_part.size = SIM_PARTITION_SIZE;
+    snprintf(sim_part.label, sizeof(sim_part.label), "%s", label);
+    return 0;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype, const char *label)
+{
+    if (!sim_part_data || sim_part.type != type || sim_part.subtype != subtype ||
+        (label && strcmp(sim_part.label, label) != 0))
+        return NULL;
+
+    return &sim_part;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, size_t size,
+                             spi_flash_mmap_memory_t memory, const void **out_ptr,
+                             spi_flash_mmap_handle_t *out_handle)
+{
+    sim_advance_us(SIM_COST_PARTITION_MMAP_US);
+    (void)memory;
+
+    if (partition != &sim_part || offset + size > partition->size)
+        return ESP_ERR_INVALID_ARG;
+
+    *out_ptr = sim_part_data + offset;
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+void spi_flash_munmap(spi_flash_mmap_handle_t handle)
+{
+    (void)handle;
+}
+
+/* ===================== NVS ===================== */
+
+#define SIM_NVS_ITEMS 32
+#define SIM_NVS_NAME_LEN 16
+#define SIM_NVS_ENTRY_BYTES 32
+
+// Schlüssel im RAM, bleiben über sim_reset() erhalten wie die Partition
+typedef struct
+{
+    char ns[SIM_NVS_NAME_LEN];
+    char key[SIM_NVS_NAME_LEN];
+    uint8_t *data;
+    size_t len;
+} sim_nvs_item_t;
+
+static sim_nvs_item_t sim_nvs_items[SIM_NVS_ITEMS];
+static char sim_nvs_handles[SIM_NVS_ITEMS][SIM_NVS_NAME_LEN]; // Handle - 1 -> Namespace
+static bool sim_nvs_writable[SIM_NVS_ITEMS];
+static sim_nvs_stats_t sim_nvs;
+
+static sim_nvs_item_t *sim_nvs_find(nvs_handle_t handle, const char *key, bool create)
+{
+    const char *ns = sim_nvs_handles[handle - 1];
+    sim_nvs_item_t *free_item = NULL;
+
+    for (int i = 0; i < SIM_NVS_ITEMS; i++)
+    {
+        sim_nvs_item_t *it = &sim_nvs_items[i];
+        if (it->data && strcmp(it->ns, ns) == 0 && strcmp(it->key, key) == 0)
+            return it;
+        if (!it->data && !free_item)
+            free_item = it;
+    }
+
+    if (!create || !free_item)
+        return NULL;
+    snprintf(free_item->ns, sizeof(free_item->ns), "%s", ns);
+    snprintf(free_item->key, sizeof(free_item->key), "%s", key);
+    return free_item;
+}
+
+static bool sim_nvs_handle_ok(nvs_handle_t handle)
+{
+    return handle >= 1 && handle <= SIM_NVS_ITEMS && sim_nvs_handles[handle - 1][0] != 0;
+}
+
+esp_err_t nvs_flash_init(void)
+{
+    sim_advance_us(SIM_COST_NVS_INIT_US);
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    for (int i = 0; i < SIM_NVS_ITEMS; i++)
+    {
+        free(sim_nvs_items[i].data);
+        sim_nvs_items[i].data = NULL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    for (int i = 0; i < SIM_NVS_ITEMS; i++)
+    {
+        if (sim_nvs_handles[i][0] == 0)
+        {
+            snprintf(sim_nvs_handles[i], SIM_NVS_NAME_LEN, "%s", name);
+            sim_nvs_writable[i] = open_mode == NVS_READWRITE;
+            *out_handle = (nvs_handle_t)(i + 1);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    if (!sim_nvs_handle_ok(handle))
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!sim_nvs_writable[handle - 1])
+        return ESP_ERR_NVS_READ_ONLY;
+
+    sim_nvs_item_t *it = sim_nvs_find(handle, key, true);
+    if (!it)
+        return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+
+    free(it->data);
+    it->data = malloc(length ? length : 1);
+    memcpy(it->data, value, length);
+    it->len = length;
+
+    // Daten, Daten-Header und Blob-Index wie in nvs_flash ab IDF v4
+    sim_nvs.blob_writes++;
+    sim_nvs.bytes += length;
+    sim_nvs.entries += (length + SIM_NVS_ENTRY_BYTES - 1) / SIM_NVS_ENTRY_BYTES + 2;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    if (!sim_nvs_handle_ok(handle))
+        return ESP_ERR_NVS_INVALID_HANDLE;
+
+    sim_nvs_item_t *it = sim_nvs_find(handle, key, false);
+    if (!it)
+        return ESP_ERR_NVS_NOT_FOUND;
+
+    if (out_value == NULL)
+    {
+        *length = it->len;
+        return ESP_OK;
+    }
+    if (*length < it->len)
+        return ESP_ERR_NVS_INVALID_LENGTH;
+
+    memcpy(out_value, it->data, it->len);
+    *length = it->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    if (!sim_nvs_handle_ok(handle))
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!sim_nvs_writable[handle - 1])
+        return ESP_ERR_NVS_READ_ONLY;
+
+    sim_nvs_item_t *it = sim_nvs_find(handle, key, false);
+    if (!it)
+        return ESP_ERR_NVS_NOT_FOUND;
+
+    free(it->data);
+    it->data = NULL;
+    sim_nvs.erases++;
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    if (!sim_nvs_handle_ok(handle))
+        return ESP_ERR_NVS_INVALID_HANDLE;
+
+    sim_nvs.commits++;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    if (sim_nvs_handle_ok(handle))
+        sim_nvs_handles[handle - 1][0] = 0;
+}
+
+const sim_nvs_stats_t *sim_nvs_stats(void)
+{
+    return &sim_nvs;
+}
+
+/* ===================== LEDC ===================== */
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timer_conf)
+{
+    sim_advance_us(SIM_COST_LEDC_TIMER_US);
+    sim.timer_freq[timer_conf->speed_mode][timer_conf->timer_num] = timer_conf->freq_hz;
+    sim.timer_res[timer_conf->speed_mode][timer_conf->timer_num] = timer_conf->duty_resolution;
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledc_conf)
+{
+    sim_advance_us(SIM_COST_LEDC_CHANNEL_US);
+    sim_ledc_channel_t *ch = &sim.channels[ledc_conf->speed_mode][ledc_conf->channel];
+
+    ch->configured = true;
+    ch->gpio_num = ledc_conf->gpio_num;
+    ch->timer = ledc_conf->timer_sel;
+    ch->duty = ledc_conf->duty;
+    ch->applied_duty = ledc_conf->duty;
+    ch->applied_res = sim.timer_res[ledc_conf->speed_mode][ledc_conf->timer_sel];
+    return ESP_OK;
+}
+
+static uint32_t sim_ledc_duty_now(const sim_ledc_channel_t *ch);
+static bool sim_is_buzzer(const sim_ledc_channel_t *ch);
+
+/* Neue Timer-Frequenz; Tonwechsel bei klingendem Buzzer zählt als neuer Ton */
+static void sim_ledc_timer_freq(ledc_mode_t speed_mode, ledc_timer_t timer_num, double freq_hz)
+{
+    sim.timer_freq[speed_mode][timer_num] = freq_hz;
+    sim.freq_dirty = true;
+
+    // Tonwechsel bei klingendem Buzzer (Legato): neuer Ton ohne Duty-Zugriff
+    for (int c = 0; c < LEDC_CHANNEL_MAX; c++)
+    {
+        sim_ledc_channel_t *ch = &sim.channels[speed_mode][c];
+        if (sim_is_buzzer(ch) && ch->timer == timer_num && sim.note_active && sim_ledc_duty_now(ch) > 0)
+        {
+            sim_note_start(freq_hz);
+            sim.freq_dirty = false;
+        }
+    }
+}
+
+/* Frequenz aus APB-Takt, 10.8-Teiler und Auflösung */
+static double sim_ledc_div_freq(uint32_t div, uint32_t res)
+{
+    return SIM_APB_HZ * 256.0 / ((double)div * (double)(1u << res));
+}
+
+esp_err_t ledc_set_freq(ledc_mode_t speed_mode, ledc_timer_t timer_num, uint32_t freq_hz)
+{
+    uint32_t res = sim.timer_res[speed_mode][timer_num];
+
+    // Wie der echte Treiber: Teiler abgerundet, ohne gültigen bleibt die alte Frequenz stehen
+    if (freq_hz == 0)
+        return ESP_FAIL;
+    uint64_t div = ((uint64_t)SIM_APB_HZ << 8) / freq_hz / (1u << res);
+    if (div < SIM_LEDC_DIV_MIN || div > SIM_LEDC_DIV_MAX)
+        return ESP_FAIL;
+
+    sim_ledc_timer_freq(speed_mode, timer_num, sim_ledc_div_freq((uint32_t)div, res));
+    return ESP_OK;
+}
+
+esp_err_t ledc_timer_set(ledc_mode_t speed_mode, ledc_timer_t timer_sel, uint32_t clock_divider,
+                         uint32_t duty_resolution, ledc_clk_src_t clk_src)
+{
+    if (clk_src != LEDC_APB_CLK || clock_divider < SIM_LEDC_DIV_MIN || clock_divider > SIM_LEDC_DIV_MAX ||
+        duty_resolution == 0 || duty_resolution >= LEDC_TIMER_BIT_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    sim.timer_res[speed_mode][timer_sel] = duty_resolution;
+    sim_ledc_timer_freq(speed_mode, timer_sel, sim_ledc_div_freq(clock_divider, duty_resolution));
+    return ESP_OK;
+}
+
+uint32_t ledc_get_freq(ledc_mode_t speed_mode, ledc_timer_t timer_num)
+{
+    return (uint32_t)sim.timer_freq[speed_mode][timer_num];
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty)
+{
+    sim.channels[speed_mode][channel].duty = duty;
+    return ESP_OK;
+}
+
+/* Duty zur aktuellen virtuellen Zeit, auch während einer Hardware-Rampe */
+static uint32_t sim_ledc_duty_now(const sim_ledc_channel_t *ch)
+{
+    if (sim.now_us >= ch->fade_end_us)
+        return ch->applied_duty;
+
+    uint64_t done = sim.now_us - ch->fade_start_us;
+    uint64_t total = ch->fade_end_us - ch->fade_start_us;
+    int64_t span = (int64_t)ch->applied_duty - (int64_t)ch->fade_from;
+
+    return (uint32_t)((int64_t)ch->fade_from + span * (int64_t)done / (int64_t)total);
+}
+
+/* Rampe läuft noch: der echte Treiber würde hier blockieren */
+static void sim_ledc_check_fade(const sim_ledc_channel_t *ch)
+{
+    if (sim.now_us < ch->fade_end_us)
+        sim.fade_conflicts++;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    return sim_ledc_duty_now(&sim.channels[speed_mode][channel]);
+}
+
+uint32_t sim_get_duty(ledc_mode_t mode, ledc_channel_t channel)
+{
+    return sim_ledc_duty_now(&sim.channels[mode][channel]);
+}
+
+int sim_ledc_gpio(ledc_mode_t mode, ledc_channel_t channel)
+{
+    const sim_ledc_channel_t *ch = &sim.channels[mode][channel];
+    return ch->configured ? ch->gpio_num : -1;
+}
+
+uint32_t sim_ledc_fade_conflicts(void)
+{
+    return sim.fade_conflicts;
+}
+
+uint32_t sim_buzzer_clicks(void)
+{
+    return sim.buzzer_clicks;
+}
+
+static bool sim_is_buzzer(const sim_ledc_channel_t *ch)
+{
+    return sim.buzzer_pin != GPIO_NUM_NC && ch->gpio_num == sim.buzzer_pin;
+}
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags)
+{
+    sim_advance_us(SIM_COST_INTR_ALLOC_US);
+    (void)intr_alloc_flags;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t speed_mode, ledc_channel_t channel,
+                                  uint32_t target_duty, int max_fade_time_ms)
+{
+    sim_ledc_channel_t *ch = &sim.channels[speed_mode][channel];
+
+    sim_ledc_check_fade(ch);
+    ch->fade_target = target_duty;
+    ch->fade_len_us = (uint64_t)max_fade_time_ms * 1000;
+    return ESP_OK;
+}
+
+/*
+ * Wie die Hardware: Start mit der nächsten PWM-Periode, dann delta/scale
+ * Schritte zu je cycle_num Perioden, ein Rest als letzter Schritt.
+ */
+esp_err_t ledc_set_fade_with_step(ledc_mode_t speed_mode, ledc_channel_t channel,
+                                  uint32_t target_duty, uint32_t scale, uint32_t cycle_num)
+{
+    sim_ledc_channel_t *ch = &sim.channels[speed_mode][channel];
+    uint32_t from = sim_ledc_duty_now(ch);
+    uint32_t delta = from > target_duty ? from - target_duty : target_duty - from;
+    double freq = sim.timer_freq[speed_mode][ch->timer];
+
+    sim_ledc_check_fade(ch);
+    if (scale == 0 || cycle_num == 0 || freq <= 0.0)
+        return ESP_ERR_INVALID_ARG;
+
+    uint64_t cycles = delta ? 1 + delta / scale * cycle_num + (delta % scale ? 1 : 0) : 0;
+    ch->fade_target = target_duty;
+    double len_us = cycles * 1e6 / freq;
+    ch->fade_len_us = (uint64_t)len_us;
+    if ((double)ch->fade_len_us < len_us)
+        ch->fade_len_us++; // aufrunden, ohne libm im Task-Stack (Lazy Binding)
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t speed_mode, ledc_channel_t channel, ledc_fade_mode_t fade_mode)
+{
+    sim_ledc_channel_t *ch = &sim.channels[speed_mode][channel];
+
+    (void)fade_mode;
+    ch->fade_from = sim_ledc_duty_now(ch);
+    ch->fade_start_us = sim.now_us;
+    ch->fade_end_us = sim.now_us + ch->fade_len_us;
+    ch->applied_duty = ch->fade_target;
+    ch->applied_res = sim.timer_res[speed_mode][ch->timer];
+    ch->duty = ch->fade_target;
+
+    // Buzzer: Ton beginnt mit dem Attack und endet mit der Release
+    if (sim_is_buzzer(ch))
+    {
+        if (ch->fade_target == 0)
+            sim_note_end_at(ch->fade_end_us);
+        else if (!sim.note_active || sim.freq_dirty)
+            sim_note_start(sim.timer_freq[speed_mode][ch->timer]);
+        sim.freq_dirty = false;
+    }
+    return ESP_OK;
+}
+
+/* Rampe abbrechen: die Duty bleibt auf dem aktuellen Wert stehen */
+esp_err_t ledc_fade_stop(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    sim_ledc_channel_t *ch = &sim.channels[speed_mode][channel];
+
+    if (sim.now_us >= ch->fade_end_us)
+        return ESP_OK;
+
+    ch->applied_duty = sim_ledc_duty_now(ch);
+    ch->duty = ch->applied_duty;
+    ch->fade_end_us = 0;
+
+    // Abgebrochene Release: der Ton endet nicht erst am geplanten Ende
+    if (sim_is_buzzer(ch) && ch->fade_target == 0 && sim.note_count > 0 &&
+        sim.notes[sim.note_count - 1].end_us > sim.now_us)
+        sim.notes[sim.note_count - 1].end_us = sim.now_us;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    sim_ledc_channel_t *ch = &sim.channels[speed_mode][channel];
+    uint32_t before = sim_ledc_duty_now(ch);
+    uint32_t before_res = ch->applied_res;
+
+    sim_ledc_check_fade(ch);
+    ch->applied_duty = ch->duty;
+    ch->applied_res = sim.timer_res[speed_mode][ch->timer];
+    ch->fade_end_us = 0;
+
+    if (!sim_is_buzzer(ch))
+        return ESP_OK;
+
+    // Harter Sprung des Tastverhältnisses bei klingendem Buzzer: hörbares
+    // Knacken. Beide Seiten auf 20 Bit, die Auflösung kann dazwischen wechseln
+    int64_t from = (int64_t)before << (20 - before_res);
+    int64_t to = (int64_t)ch->applied_duty << (20 - ch->applied_res);
+    if (llabs(to - from) > (int64_t)SIM_CLICK_DUTY << 10)
+        sim.buzzer_clicks++;
+
+    if (ch->applied_duty == 0)
+        sim_note_end();
+    else if (!sim.note_active || sim.freq_dirty)
+        sim_note_start(sim.timer_freq[speed_mode][ch->timer]);
+
+    sim.freq_dirty = false;
+    return ESP_OK;
+}
+
+/* ===================== ADC / DAC ===================== */
+
+esp_err_t adc1_config_width(adc_bits_width_t width_bit)
+{
+    sim_advance_us(SIM_COST_ADC_CONFIG_US);
+    (void)width_bit;
+    return ESP_OK;
+}
+
+esp_err_t adc1_config_channel_atten(adc1_channel_t channel, adc_atten_t atten)
+{
+    sim_advance_us(SIM_COST_ADC_CONFIG_US);
+    (void)channel;
+    (void)atten;
+    return ESP_OK;
+}
+
+/* Rauschen: Summe von vier Gleichverteilungen, ungefähr normalverteilt */
+static int sim_adc_noise(int amplitude)
+{
+    int sum = 0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        sim.adc_seed = sim.adc_seed * 1103515245u + 12345u;
+        sum += (int)((sim.adc_seed >> 16) % (2 * amplitude + 1)) - amplitude;
+    }
+    return sum / 2;
+}
+
+int adc1_get_raw(adc1_channel_t channel)
+{
+    int raw = sim.adc_raw[channel];
+
+    sim.adc_conversions++;
+    if (sim.adc_noise[channel] > 0)
+        raw += sim_adc_noise(sim.adc_noise[channel]);
+
+    return raw < 0 ? 0 : raw > 4095 ? 4095 : raw;
+}
+
+esp_err_t dac_output_enable(dac_channel_t channel)
+{
+    (void)channel;
+    return ESP_OK;
+}
+
+esp_err_t dac_output_disable(dac_channel_t channel)
+{
+    (void)channel;
+    return ESP_OK;
+}
+
+esp_err_t dac_output_voltage(dac_channel_t channel, uint8_t dac_value)
+{
+    sim.dac[channel] = dac_value;
+    return ESP_OK;
+}
+
+/* ===================== Log ===================== */
+
+void sim_log_enable(bool enable)
+{
+    sim.log_enabled = enable;
+}
+
+void sim_log_write(char level, const char *tag, const char *fmt, ...)
+{
+    char msg[256];
+
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, args);
+    va_end(args);
+
+    int len = snprintf(NULL, 0, "%c (%llu) %s: %s\n",
+                       level, (unsigned long long)(sim.now_us / 1000), tag, msg);
+
+    if (sim.log_enabled)
+        printf("%c (%llu) %s: %s\n", level, (unsigned long long)(sim.now_us / 1000), tag, msg);
+
+    // ESP_LOGx blockiert, bis die Zeile über die UART raus ist
+    sim_advance_us((uint64_t)len * SIM_UART_NS_PER_CHAR / 1000);
+}
+
+/* Nur der Log-Task (dlog.c) schreibt so: er läuft nebenher auf Core 1, die UART-Zeit blockiert niemanden */
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    (void)level;
+    (void)tag;
+
+    if (!sim.log_enabled)
+        return;
+
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+/*
+ * Simulierte Hardware für den Host-Build.
+ *
+ * Ersetzt GPIO/LEDC/ADC/DAC und den FreeRTOS-Tick durch eine
+ * deterministische virtuelle Uhr in Mikrosekunden. Eingaben werden als
+ * zeitgestempelte Pin-Ereignisse eingeplant und beim Vorrücken der Uhr
+ * zusammen mit fälligen esp_timer-Callbacks in zeitlicher Reihenfolge
+ * angewendet. ESP_LOGx kostet virtuelle Zeit wie
+ * die blockierende UART-Ausgabe. Der Buzzer-Kanal wird mitgeschnitten,
+ * damit Tonlängen und Eingabe-zu-Ton-Latenz gemessen werden können.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+
+#define SIM_MAX_PIN_EVENTS 1024
+#define SIM_MAX_NOTES 4096
+#define SIM_MAX_LATENCIES 1024
+
+/* Ein abgespielter Ton, wie er am Buzzer-Pin angekommen ist */
+typedef struct
+{
+    uint64_t start_us;
+    uint64_t end_us;  // 0 solange der Ton noch klingt
+    double freq_hz;   // aus Teiler und Auflösung des Timers, wie ihn die Hardware erzeugt
+} sim_note_t;
+
+typedef struct
+{
+    uint64_t latency_us[SIM_MAX_LATENCIES];
+    int count;
+    int missed; // Tastendrücke ohne Ton innerhalb von SIM_PRESS_TIMEOUT_US
+} sim_latency_t;
+
+#define SIM_PRESS_TIMEOUT_US 500000ULL
+
+/* Aufwachen und geschätzter Light Sleep seit sim_power_reset() */
+typedef struct
+{
+    uint64_t since_us;
+    uint64_t wakeups;   // Zeitpunkte mit Aktivität (ISR, Timer, Timeout)
+    uint64_t asleep_us; // Leerlauf ohne PM-Sperre, lang genug für Light Sleep
+} sim_power_t;
+
+/* ===================== Uhr ===================== */
+void sim_reset(void);
+uint64_t sim_now_us(void);
+
+/**
+ * sim_advance_us - virtuelle Uhr vorrücken
+ * @us: Anzahl Mikrosekunden
+ *
+ * Wendet alle bis dahin fälligen Pin-Ereignisse und esp_timer-Deadlines in
+ * zeitlicher Reihenfolge an und löst dabei GPIO-ISRs und Timer-Callbacks aus.
+ */
+void sim_advance_us(uint64_t us);
+
+/*
+ * Init-Kosten der Treiber: um so viel rückt die Uhr bei jedem Aufruf vor,
+ * damit das boot-Szenario die Reihenfolge in playbox_init() sieht.
+ * Richtwerte für ESP32 mit 240 MHz und IDF 4.4; teuer sind Interrupt- und
+ * DMA-Allokation und alles, was den Flash liest.
+ */
+#define SIM_COST_GPIO_CONFIG_US 15
+#define SIM_COST_INTR_ALLOC_US 60       // ISR-Dienst, Fade-Dienst, UART-ISR
+#define SIM_COST_LEDC_TIMER_US 40       // Teiler suchen, Timer zurücksetzen
+#define SIM_COST_LEDC_CHANNEL_US 20
+#define SIM_COST_SPI_BUS_US 250         // DMA-Deskriptoren und Interrupt
+#define SIM_COST_SPI_DEVICE_US 40
+#define SIM_COST_UART_CONFIG_US 30
+#define SIM_COST_PM_CONFIG_US 100
+#define SIM_COST_PARTITION_MMAP_US 200  // MMU-Seiten für die Songbibliothek
+#define SIM_COST_NVS_INIT_US 15000      // alle NVS-Seiten lesen
+#define SIM_COST_ADC_CONFIG_US 20
+#define SIM_COST_I2S_INSTALL_US 900     // DMA-Puffer für den Synth
+#define SIM_COST_TASK_CREATE_US 40
+
+/* Zeitpunkt des nächsten eingeplanten Ereignisses, UINT64_MAX wenn keins */
+uint64_t sim_next_event_us(void);
+
+/**
+ * sim_block_until - blockierenden RTOS-Aufruf simulieren
+ * @deadline_us: absoluter Timeout
+ * @ready: Bedingung, auf die gewartet wird
+ *
+ * Rückt die Uhr von Ereignis zu Ereignis vor, bis @ready true liefert oder
+ * @deadline_us erreicht ist. Gibt das letzte Ergebnis von @ready zurück.
+ */
+bool sim_block_until(uint64_t deadline_us, bool (*ready)(void *ctx), void *ctx);
+
+/* ===================== Eingaben ===================== */
+void sim_set_pin(gpio_num_t pin, int level);
+
+/**
+ * sim_schedule_pin - Pegelwechsel zu einem absoluten Zeitpunkt einplanen
+ */
+void sim_schedule_pin(uint64_t at_us, gpio_num_t pin, int level);
+
+/**
+ * sim_press - Taster (active low) drücken und nach @hold_ms loslassen
+ * @expect_tone: Tastendruck für die Latenzmessung berücksichtigen
+ */
+void sim_press(uint64_t at_us, gpio_num_t pin, uint32_t hold_ms, bool expect_tone);
+
+/**
+ * sim_press_bounce - wie sim_press(), aber mit Kontaktprellen
+ * @bounces: Zahl der Rückpraller beim Drücken und beim Loslassen
+ *
+ * Die Abstände der Zwischenflanken sind pseudozufällig, aber reproduzierbar.
+ */
+void sim_press_bounce(uint64_t at_us, gpio_num_t pin, uint32_t hold_ms, int bounces, bool expect_tone);
+
+/**
+ * sim_uart_send - Bytes auf einer UART-RX-Leitung eintreffen lassen
+ * @rx_pin: GPIO, auf den ein UART per uart_set_pin() hört
+ * @expect_tone: letztes Byte für die Latenzmessung berücksichtigen
+ *
+ * Die Bytes folgen lückenlos im 8N1-Takt von @baud. Gibt den Zeitpunkt
+ * zurück, an dem das letzte Byte im RX-FIFO ist.
+ */
+uint64_t sim_uart_send(uint64_t at_us, gpio_num_t rx_pin, int baud, const uint8_t *data, size_t n,
+                       bool expect_tone);
+
+/**
+ * sim_chain_connect - 74HC165-Kette mit @bits Eingängen an den SPI-Bus hängen
+ *
+ * Vor playbox_init() aufrufen, damit chain_init() sie findet. Ohne Aufruf
+ * ist keine Kette angeschlossen: jeder Lesezugriff liefert nur Nullen.
+ */
+void sim_chain_connect(int bits);
+
+/* Wie sim_press(), aber für Eingang @input der Kette */
+void sim_chain_press(uint64_t at_us, int input, uint32_t hold_ms, bool expect_tone);
+
+/* SPI-Transaktionen seit dem Start */
+uint32_t sim_spi_transfers(void);
+
+/* Registerlesezugriffe (REG_READ) auf GPIO_IN_REG/GPIO_IN1_REG */
+uint32_t sim_reg_read(uint32_t addr);
+
+void sim_set_adc(int channel, int raw);
+
+/* Reproduzierbares Rauschen auf adc1_get_raw(), Standardabweichung ~ @amplitude / 2 */
+void sim_set_adc_noise(int channel, int amplitude);
+uint64_t sim_adc_conversions(void);
+uint8_t sim_get_dac(int channel);
+
+/* ===================== Ausgaben ===================== */
+void sim_set_buzzer_pin(gpio_num_t pin);
+uint32_t sim_get_duty(ledc_mode_t mode, ledc_channel_t channel);
+
+/* GPIO eines per ledc_channel_config() eingerichteten Kanals, sonst -1 */
+int sim_ledc_gpio(ledc_mode_t mode, ledc_channel_t channel);
+
+/* LEDC-Zugriffe während einer laufenden Hardware-Rampe (auf dem Target blockierend) */
+uint32_t sim_ledc_fade_conflicts(void);
+
+/* Harte Duty-Sprünge am Buzzer um mehr als SIM_CLICK_DUTY (auf 10 Bit bezogen), ohne Rampe */
+#define SIM_CLICK_DUTY 8
+uint32_t sim_buzzer_clicks(void);
+
+int sim_note_count(void);
+const sim_note_t *sim_notes(void);
+const sim_latency_t *sim_latency(void);
+
+/* ===================== Audio (sim_audio.c) ===================== */
+/* Mixer-Ausgabe ab jetzt mitschneiden (verwirft vorherigen Mitschnitt) */
+void sim_audio_capture(bool enable);
+size_t sim_audio_samples(const int16_t **samples);
+int sim_audio_write_wav(const char *path);
+
+/* ===================== Flash ===================== */
+#define SIM_PARTITION_SIZE (512 * 1024)
+
+/**
+ * sim_partition_load - Datenpartition @label mit dem Inhalt von @path anlegen
+ *
+ * Rest der Partition ist 0xff wie gelöschter Flash. Vor playbox_init()
+ * aufrufen. Gibt -1 zurück, wenn die Datei fehlt oder zu groß ist.
+ */
+int sim_partition_load(const char *label, int subtype, const char *path);
+
+/* Schreibzugriffe auf den NVS-Stub seit dem Start */
+typedef struct
+{
+    uint32_t blob_writes; // nvs_set_blob()
+    uint32_t erases;      // nvs_erase_key()
+    uint32_t commits;
+    uint64_t bytes;       // Nutzdaten
+    uint64_t entries;     // 32-Byte-Einträge samt Header und Index: Maß für den Verschleiß
+} sim_nvs_stats_t;
+
+const sim_nvs_stats_t *sim_nvs_stats(void);
+
+/* ===================== Energie ===================== */
+void sim_power_reset(void);
+const sim_power_t *sim_power(void);
+
+/* Blockierender Aufruf kehrt nach Timeout zurück: zählt als Aufwachen */
+void sim_note_wakeup(void);
+
+/* ===================== Log ===================== */
+void sim_log_enable(bool enable);
@@ -0,0 +1,312 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#include "sim_hal.h"
+
+#define SIM_US_PER_TICK (1000000ULL / configTICK_RATE_HZ)
+
+/* Host-Code braucht mehr Stack als Xtensa; gemessen wird trotzdem der Verbrauch */
+#define SIM_TASK_STACK_MIN (64 * 1024)
+#define SIM_STACK_FILL 0xa5
+
+struct QueueDefinition
+{
+    uint8_t *buf;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+/* ===================== Uhr / Blockieren ===================== */
+
+bool sim_block_until(uint64_t deadline_us, bool (*ready)(void *ctx), void *ctx)
+{
+    while (!ready(ctx))
+    {
+        uint64_t now = sim_now_us();
+        if (now >= deadline_us)
+        {
+            sim_note_wakeup();
+            return false;
+        }
+
+        uint64_t next = sim_next_event_us();
+        sim_advance_us((next < deadline_us ? next : deadline_us) - now);
+    }
+
+    return true;
+}
+
+/* Timeout in Ticks -> absolute Deadline an der Tick-Grenze, wie FreeRTOS */
+static uint64_t sim_tick_deadline(TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY)
+        return UINT64_MAX;
+
+    return (sim_now_us() / SIM_US_PER_TICK + ticks) * SIM_US_PER_TICK;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(sim_now_us() / SIM_US_PER_TICK);
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    if (xTicksToDelay == 0)
+        return;
+
+    sim_advance_us(sim_tick_deadline(xTicksToDelay) - sim_now_us());
+}
+
+/* ===================== Queues ===================== */
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+{
+    QueueHandle_t q = calloc(1, sizeof(*q));
+    q->buf = calloc(uxQueueLength, uxItemSize);
+    q->length = uxQueueLength;
+    q->item_size = uxItemSize;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t xQueue)
+{
+    free(xQueue->buf);
+    free(xQueue);
+}
+
+static bool sim_queue_not_full(void *ctx)
+{
+    QueueHandle_t q = ctx;
+    return q->count < q->length;
+}
+
+static bool sim_queue_not_empty(void *ctx)
+{
+    QueueHandle_t q = ctx;
+    return q->count > 0;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void *pvItemToQueue,
+                             BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken)
+        *pxHigherPriorityTaskWoken = pdFALSE;
+
+    if (xQueue->count >= xQueue->length)
+        return pdFAIL;
+
+    UBaseType_t tail = (xQueue->head + xQueue->count) % xQueue->length;
+    memcpy(xQueue->buf + tail * xQueue->item_size, pvItemToQueue, xQueue->item_size);
+    xQueue->count++;
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait)
+{
+    if (!sim_block_until(sim_tick_deadline(xTicksToWait), sim_queue_not_full, xQueue))
+        return pdFAIL;
+
+    return xQueueSendFromISR(xQueue, pvItemToQueue, NULL);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+    if (!sim_block_until(sim_tick_deadline(xTicksToWait), sim_queue_not_empty, xQueue))
+        return pdFAIL;
+
+    memcpy(pvBuffer, xQueue->buf + xQueue->head * xQueue->item_size, xQueue->item_size);
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+    if (xQueuePeek(xQueue, pvBuffer, xTicksToWait) != pdPASS)
+        return pdFAIL;
+
+    xQueue->head = (xQueue->head + 1) % xQueue->length;
+    xQueue->count--;
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue)
+{
+    return xQueue->count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue)
+{
+    xQueue->head = 0;
+    xQueue->count = 0;
+    return pdPASS;
+}
+
+/* ===================== Tasks ===================== */
+
+struct tskTaskControlBlock
+{
+    const char *name;
+    TaskFunction_t fn;
+    void *arg;
+    ucontext_t ctx;
+    ucontext_t *resumer; // wer den Task zuletzt fortgesetzt hat
+    uint8_t *stack;
+    size_t stack_size;
+    uint32_t requested;  // Stacktiefe laut xTaskCreatePinnedToCore
+    uint32_t notify;
+    bool waiting;
+};
+
+static TaskHandle_t sim_current = NULL; // NULL = Hauptprogramm (UI-Task)
+
+static void sim_task_entry(void)
+{
+    sim_current->fn(sim_current->arg);
+
+    fprintf(stderr, "sim: task %s returned\n", sim_current->name);
+    abort();
+}
+
+/* @task bis zum nächsten ulTaskNotifyTake() laufen lassen */
+static void sim_task_resume(TaskHandle_t task)
+{
+    ucontext_t here;
+    TaskHandle_t prev = sim_current;
+
+    task->waiting = false;
+    task->resumer = &here;
+    sim_current = task;
+    swapcontext(&here, &task->ctx);
+    sim_current = prev;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char *pcName,
+                                   const uint32_t usStackDepth, void *pvParameters,
+                                   UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask,
+                                   const BaseType_t xCoreID)
+{
+    TaskHandle_t task = calloc(1, sizeof(*task));
+
+    sim_advance_us(SIM_COST_TASK_CREATE_US);
+    (void)uxPriority;
+    (void)xCoreID;
+
+    task->name = pcName;
+    task->fn = pvTaskCode;
+    task->arg = pvParameters;
+    task->requested = usStackDepth;
+    task->stack_size = usStackDepth > SIM_TASK_STACK_MIN ? usStackDepth : SIM_TASK_STACK_MIN;
+    task->stack = malloc(task->stack_size);
+    memset(task->stack, SIM_STACK_FILL, task->stack_size);
+
+    getcontext(&task->ctx);
+    task->ctx.uc_stack.ss_sp = task->stack;
+    task->ctx.uc_stack.ss_size = task->stack_size;
+    task->ctx.uc_link = NULL;
+    makecontext(&task->ctx, sim_task_entry, 0);
+
+    if (pvCreatedTask)
+        *pvCreatedTask = task;
+
+    sim_task_resume(task);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    TaskHandle_t self = sim_current;
+
+    if (self == NULL)
+    {
+        fprintf(stderr, "sim: ulTaskNotifyTake outside a task\n");
+        abort();
+    }
+
+    while (self->notify == 0)
+    {
+        if (xTicksToWait != portMAX_DELAY)
+            return 0;
+
+        self->waiting = true;
+        swapcontext(&self->ctx, self->resumer);
+    }
+
+    uint32_t count = self->notify;
+    self->notify = xClearCountOnExit ? 0 : count - 1;
+    return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    xTaskToNotify->notify++;
+
+    // Wartender Task läuft sofort, wie auf dem eigenen Kern
+    if (xTaskToNotify->waiting && xTaskToNotify != sim_current)
+        sim_task_resume(xTaskToNotify);
+
+    return pdPASS;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask)
+{
+    if (xTask == NULL)
+        xTask = sim_current;
+    if (xTask == NULL)
+        return 0;
+
+    // Stack wächst nach unten: unberührte Bytes am unteren Ende zählen
+    size_t untouched = 0;
+    while (untouched < xTask->stack_size && xTask->stack[untouched] == SIM_STACK_FILL)
+        untouched++;
+
+    size_t used = xTask->stack_size - untouched;
+    return used < xTask->requested ? (UBaseType_t)(xTask->requested - used) : 0;
+}
+
+/* ===================== Mutex ===================== */
+
+struct SemaphoreDefinition
+{
+    bool taken;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return calloc(1, sizeof(struct SemaphoreDefinition));
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+    (void)xBlockTime;
+
+    // Single-threaded: belegt heißt, ein Callback ist in einen kritischen
+    // Abschnitt des Hauptprogramms gefallen
+    if (xSemaphore->taken)
+    {
+        fprintf(stderr, "sim: mutex already taken (would deadlock)\n");
+        abort();
+    }
+
+    xSemaphore->taken = true;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    xSemaphore->taken = false;
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    free(xSemaphore);
+}
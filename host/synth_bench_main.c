@@ -0,0 +1,15 @@
+/*
+ * synth_bench - Durchsatz des Synth-Kernels auf dem Host
+ *
+ * Gleicher Code wie der Start-Benchmark auf dem Target (main/synth_bench.c).
+ */
+
+#include "synth_bench.h"
+#include "sim_hal.h"
+
+int main(void)
+{
+    sim_reset();
+    synth_bench_run();
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "driver/adc.h"
+#include "esp_timer.h"
+
+#include "analog.h"
+#include "seqlock.h"
+#include "dlog.h"
+
+#define ANALOG_TASK_CORE 1 // neben Sequenzer und Audio, weg vom UI-Task
+#define ANALOG_TASK_PRIO 5 // unter Audio und Sequenzer: eine Runde darf warten
+#define ANALOG_TASK_STACK 2048
+
+static const adc1_channel_t channels[ANALOG_CHANNELS] = {
+    ADC1_CHANNEL_0, // GPIO36
+    ADC1_CHANNEL_1, // GPIO37
+    ADC1_CHANNEL_2, // GPIO38
+    ADC1_CHANNEL_3, // GPIO39
+};
+
+// Nur der Analog-Task greift auf filters/stats zu
+static analog_filter_t filters[ANALOG_CHANNELS];
+static analog_stats_t stats;
+
+// Kalibrierung vom UI-Task, übernimmt der Analog-Task beim Neustart
+static analog_filter_cfg_t cfgs[ANALOG_CHANNELS];
+
+// Analog-Task -> alle Leser
+static analog_snapshot_t snapshot;
+static seqlock_t snapshot_lock;
+
+static atomic_bool restart;
+static bool enabled = false;
+
+static esp_timer_handle_t round_timer = NULL;
+static TaskHandle_t task = NULL;
+
+static analog_filter_cfg_t default_cfg(void)
+{
+    return (analog_filter_cfg_t){
+        .oversample = ANALOG_OVERSAMPLE,
+        .shift = ANALOG_SHIFT,
+        .raw_min = ANALOG_RAW_MIN,
+        .raw_max = ANALOG_RAW_MAX,
+        .deadzone = ANALOG_DEADZONE,
+        .hysteresis = ANALOG_HYSTERESIS,
+    };
+}
+
+/* Eine Runde: jeden Kanal ANALOG_OVERSAMPLE-mal, Kanäle im Wechsel */
+static void analog_round(analog_snapshot_t *out)
+{
+    for (int k = 0; k < ANALOG_OVERSAMPLE; k++)
+    {
+        for (int ch = 0; ch < ANALOG_CHANNELS; ch++)
+            analog_filter_push(&filters[ch], (uint16_t)adc1_get_raw(channels[ch]));
+    }
+
+    for (int ch = 0; ch < ANALOG_CHANNELS; ch++)
+        out->value[ch] = filters[ch].value;
+}
+
+static void analog_task_fn(void *arg)
+{
+    analog_snapshot_t next = {0};
+
+    (void)arg;
+
+    for (;;)
+    {
+        uint32_t due = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (atomic_exchange(&restart, false))
+        {
+            for (int ch = 0; ch < ANALOG_CHANNELS; ch++)
+                analog_filter_init(&filters[ch], &cfgs[ch]);
+        }
+        else if (due > 1)
+        {
+            stats.overruns += due - 1;
+        }
+
+        int64_t t0 = esp_timer_get_time();
+        analog_round(&next);
+        int64_t t1 = esp_timer_get_time();
+
+        uint32_t us = (uint32_t)(t1 - t0);
+        stats.rounds++;
+        stats.conversions += ANALOG_CHANNELS * ANALOG_OVERSAMPLE;
+        stats.round_us_total += us;
+        if (us > stats.round_us_max)
+            stats.round_us_max = us;
+
+        next.frames++;
+        next.time_us = t1;
+        seqlock_write(&snapshot_lock, &snapshot, &next, sizeof(next));
+    }
+}
+
+/* esp_timer-Task (Core 0): nur wecken */
+static void round_timer_cb(void *arg)
+{
+    (void)arg;
+    xTaskNotifyGive(task);
+}
+
+void analog_init(void)
+{
+    const esp_timer_create_args_t args = {
+        .callback = round_timer_cb,
+        .name = "analog",
+    };
+
+    adc1_config_width(ADC_WIDTH_BIT_12);
+    for (int ch = 0; ch < ANALOG_CHANNELS; ch++)
+    {
+        adc1_config_channel_atten(channels[ch], ADC_ATTEN_DB_11);
+        cfgs[ch] = default_cfg();
+    }
+
+    seqlock_init(&snapshot_lock);
+    atomic_init(&restart, false);
+    esp_timer_create(&args, &round_timer);
+
+    xTaskCreatePinnedToCore(analog_task_fn, "analog", ANALOG_TASK_STACK, NULL,
+                            ANALOG_TASK_PRIO, &task, ANALOG_TASK_CORE);
+
+    // Erst beim ersten Mode mit Abtastung (playbox_hw_need()): nicht auf die UART warten
+    DLOGI(DLOG_ANALOG, "%d channels, %d Hz x %d", ANALOG_CHANNELS, ANALOG_RATE_HZ, ANALOG_OVERSAMPLE);
+}
+
+void analog_enable(bool enable)
+{
+    if (enable == enabled)
+        return;
+
+    enabled = enable;
+    if (!enable)
+    {
+        esp_timer_stop(round_timer);
+        return;
+    }
+
+    // Erste Runde sofort, der Task startet die Filter mit cfgs neu
+    atomic_store(&restart, true);
+    xTaskNotifyGive(task);
+    esp_timer_start_periodic(round_timer, 1000000 / ANALOG_RATE_HZ);
+}
+
+bool analog_calibrate(int channel, uint16_t raw_min, uint16_t raw_max)
+{
+    if (enabled || channel < 0 || channel >= ANALOG_CHANNELS)
+        return false;
+
+    cfgs[channel].raw_min = raw_min;
+    cfgs[channel].raw_max = raw_max;
+    return true;
+}
+
+bool analog_read(analog_snapshot_t *snap)
+{
+    seqlock_read(&snapshot_lock, snap, &snapshot, sizeof(*snap));
+    return snap->frames > 0;
+}
+
+const analog_stats_t *analog_stats(void)
+{
+    return &stats;
+}
+
+TaskHandle_t analog_task(void)
+{
+    return task;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "analog_filter.h"
+
+/*
+ * Analoge Eingänge ADC1_CHANNEL_0..3 (GPIO36-39) für Paddles und
+ * Lautstärke-Poti.
+ *
+ * Ein eigener Task auf Core 1 tastet alle Kanäle im Wechsel ab, ein
+ * periodischer esp_timer weckt ihn ANALOG_RATE_HZ-mal pro Sekunde. Pro
+ * Runde wandelt er jeden Kanal ANALOG_OVERSAMPLE-mal (verschränkt, damit
+ * sich Störungen auf alle Kanäle verteilen), filtert (analog_filter.h) und
+ * veröffentlicht die Werte als Momentaufnahme (seqlock.h). Die Hauptschleife
+ * wird dabei nie geweckt, Leser holen sich den letzten Stand ohne Sperre.
+ *
+ * Kein Continuous-Mode mit DMA: der läuft beim ESP32 über I2S0, und den
+ * belegt der eingebaute DAC (audio.c).
+ */
+
+#define ANALOG_CHANNELS 4
+#define ANALOG_RATE_HZ 100  // gefilterte Werte pro Sekunde und Kanal
+#define ANALOG_OVERSAMPLE 4 // Wandlungen pro Wert
+#define ANALOG_SHIFT 2      // IIR 1/4: 95 % eines Sprungs nach ~100 ms
+#define ANALOG_RAW_MIN 80   // Anschläge bei 11 dB, der ADC ist an den Enden nichtlinear
+#define ANALOG_RAW_MAX 4000
+#define ANALOG_DEADZONE 16
+#define ANALOG_HYSTERESIS 5
+
+typedef struct
+{
+    uint16_t value[ANALOG_CHANNELS]; // 0..ANALOG_FULL_SCALE
+    uint32_t frames;                 // Runden seit dem Start, 0 = noch kein Wert
+    int64_t time_us;                 // Ende der letzten Runde
+} analog_snapshot_t;
+
+typedef struct
+{
+    uint32_t rounds;
+    uint32_t conversions;
+    uint32_t overruns;       // Timer-Perioden, die eine Runde verpasst hat
+    uint32_t round_us_max;   // längste Runde
+    uint64_t round_us_total;
+} analog_stats_t;
+
+/* ADC konfigurieren, Filter anlegen und den Task starten; Abtastung bleibt aus */
+void analog_init(void);
+
+/**
+ * analog_enable - Abtastung ein- oder ausschalten (UI-Task)
+ *
+ * Beim Einschalten beginnen die Filter neu, der erste Wert ist also der
+ * aktuelle Mittelwert und kein Einschwingen von einem alten Stand.
+ */
+void analog_enable(bool enable);
+
+/**
+ * analog_calibrate - Anschläge eines Kanals setzen
+ * @raw_min, @raw_max: gemessene Rohwerte an den Enden
+ *
+ * Nur bei ausgeschalteter Abtastung, sonst false; gilt ab analog_enable().
+ */
+bool analog_calibrate(int channel, uint16_t raw_min, uint16_t raw_max);
+
+/* Letzte Werte, aus jedem Task; false, solange noch keine Runde fertig ist */
+bool analog_read(analog_snapshot_t *snap);
+
+const analog_stats_t *analog_stats(void);
+
+/* Für uxTaskGetStackHighWaterMark() */
+TaskHandle_t analog_task(void);
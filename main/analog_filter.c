@@ -0,0 +1,67 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "analog_filter.h"
+
+void analog_filter_init(analog_filter_t *f, const analog_filter_cfg_t *cfg)
+{
+    memset(f, 0, sizeof(*f));
+    f->cfg = *cfg;
+    if (f->cfg.oversample == 0)
+        f->cfg.oversample = 1;
+    if (f->cfg.raw_max <= f->cfg.raw_min)
+        f->cfg.raw_max = f->cfg.raw_min + 1;
+}
+
+uint16_t analog_filter_position(const analog_filter_t *f)
+{
+    const analog_filter_cfg_t *c = &f->cfg;
+    int32_t dz = c->deadzone;
+    int32_t span = (int32_t)(c->raw_max - c->raw_min) << ANALOG_LEVEL_SHIFT;
+
+    // raw_min..raw_max auf -dz..FULL+dz strecken, dann abschneiden
+    int64_t x = (int64_t)(f->level - ((int32_t)c->raw_min << ANALOG_LEVEL_SHIFT)) *
+                (ANALOG_FULL_SCALE + 2 * dz);
+    int32_t pos = (int32_t)((x + span / 2) / span) - dz;
+
+    if (pos < 0)
+        return 0;
+    if (pos > ANALOG_FULL_SCALE)
+        return ANALOG_FULL_SCALE;
+    return (uint16_t)pos;
+}
+
+bool analog_filter_push(analog_filter_t *f, uint16_t raw)
+{
+    f->acc += raw;
+    if (++f->n < f->cfg.oversample)
+        return false;
+
+    // Mittelwert mit Nachkommabits: Oversampling bringt Auflösung unter 1 LSB
+    int32_t x = (int32_t)(((uint64_t)f->acc << ANALOG_LEVEL_SHIFT) / f->n);
+    f->acc = 0;
+    f->n = 0;
+
+    if (!f->primed)
+    {
+        // Erster Wert ohne Einschwingen, sonst liefe jeder Regler von 0 hoch
+        f->level = x;
+        f->primed = true;
+        f->value = analog_filter_position(f);
+        return true;
+    }
+
+    f->level += (x - f->level) >> f->cfg.shift;
+
+    uint16_t pos = analog_filter_position(f);
+    int diff = (int)pos - (int)f->value;
+    if (diff < 0)
+        diff = -diff;
+
+    // Anschläge immer melden, sonst bliebe die Hysterese knapp davor stehen
+    if (diff >= f->cfg.hysteresis || (diff > 0 && (pos == 0 || pos == ANALOG_FULL_SCALE)))
+        f->value = pos;
+
+    return true;
+}
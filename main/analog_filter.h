@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Filterkette für einen ADC-Kanal: Oversampling, Dezimierung, IIR-Glättung,
+ * Kalibrierung mit Totzonen an den Anschlägen und Hysterese.
+ *
+ * Reine Logik ohne Hardwarezugriff, auf dem Host mit synthetischen Signalen
+ * prüfbar. Rechnet nur mit Ganzzahlen:
+ *
+ *   raw (12 Bit) --Mittel über oversample--> level (Q12, IIR 1/2^shift)
+ *     --Kalibrierung raw_min..raw_max, Totzone--> 0..ANALOG_FULL_SCALE
+ *     --Hysterese--> value
+ *
+ * Der ESP32-ADC rauscht um einige LSB und ist an den Enden nichtlinear;
+ * die Totzone sorgt dafür, dass ein Poti die Endwerte sicher erreicht.
+ */
+
+#define ANALOG_FULL_SCALE 1023 // 10 Bit nach dem Filter, mehr gibt der ADC nicht rauschfrei her
+#define ANALOG_LEVEL_SHIFT 12  // Nachkommabits von level
+
+typedef struct
+{
+    uint8_t oversample; // Rohwerte pro gefiltertem Wert (Dezimierung)
+    uint8_t shift;      // IIR-Koeffizient 1/2^shift, 0 = aus
+    uint16_t raw_min;   // Rohwert am unteren Anschlag
+    uint16_t raw_max;   // Rohwert am oberen Anschlag
+    uint16_t deadzone;  // Totzone je Anschlag, Einheiten von ANALOG_FULL_SCALE
+    uint16_t hysteresis; // kleinste gemeldete Änderung
+} analog_filter_cfg_t;
+
+typedef struct
+{
+    analog_filter_cfg_t cfg;
+    uint32_t acc;   // Summe der Rohwerte seit dem letzten Ausgang
+    uint8_t n;      // Anzahl in acc
+    bool primed;    // level gültig
+    int32_t level;  // geglätteter Rohwert, Q12
+    uint16_t value; // veröffentlichter Wert 0..ANALOG_FULL_SCALE
+} analog_filter_t;
+
+void analog_filter_init(analog_filter_t *f, const analog_filter_cfg_t *cfg);
+
+/**
+ * analog_filter_push - einen Rohwert verarbeiten
+ * @raw: 12-Bit-Wandlung
+ *
+ * Gibt true zurück, wenn damit ein dezimierter Wert fertig wurde (jeder
+ * oversample-te Aufruf). f->value ändert sich nur um mindestens hysteresis
+ * oder beim Erreichen eines Anschlags.
+ */
+bool analog_filter_push(analog_filter_t *f, uint16_t raw);
+
+/* Kalibrierte Stellung vor der Hysterese, 0..ANALOG_FULL_SCALE */
+uint16_t analog_filter_position(const analog_filter_t *f);
@@ -0,0 +1,159 @@
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#include "driver/i2s.h"
+#include "esp_cpu.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#include "audio.h"
+#include "synth.h"
+#include "power.h"
+#include "dlog.h"
+
+#define AUDIO_I2S_PORT I2S_NUM_0 // nur I2S0 kann den eingebauten DAC treiben
+#define AUDIO_DMA_BUFS 2
+#define AUDIO_TASK_CORE 1 // mit dem Sequenzer; UI-Task und esp_timer auf Core 0
+#define AUDIO_TASK_PRIO 10
+#define AUDIO_TASK_STACK 3072
+
+static QueueHandle_t i2s_events = NULL;
+static audio_stats_t stats;
+static TaskHandle_t task = NULL;
+
+/* Mono-Block und Stereo-Frame für den DAC: 16 Bit, davon nutzt der DAC das obere Byte */
+static int16_t mono[SYNTH_BLOCK];
+static uint16_t frame[2 * SYNTH_BLOCK];
+
+static void audio_task_fn(void *arg)
+{
+    uint32_t tx_done = 0;
+    uint32_t tx_done_at_start = 0;
+    uint32_t run_blocks = 0; // Blöcke seit i2s_start()
+    uint32_t underruns_before = 0;
+    int silent = 0;
+    bool started = false;
+
+    (void)arg;
+
+    for (;;)
+    {
+        if (!power_held(POWER_LOCK_SYNTH))
+        {
+            // Leerlauf: I2S steht, CPU darf schlafen, bis eine Note kommt
+            while (!synth_pending())
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            power_acquire(POWER_LOCK_SYNTH);
+            i2s_start(AUDIO_I2S_PORT);
+        }
+
+        uint32_t t0 = esp_cpu_get_ccount();
+        int voices = synth_render(mono, SYNTH_BLOCK);
+        uint32_t cycles = esp_cpu_get_ccount() - t0;
+
+        // Offset-Binär für den DAC, beide Kanäle gleich
+        for (int i = 0; i < SYNTH_BLOCK; i++)
+        {
+            uint16_t s = (uint16_t)mono[i] ^ 0x8000;
+            frame[2 * i] = s;
+            frame[2 * i + 1] = s;
+        }
+
+        size_t written = 0;
+        i2s_write(AUDIO_I2S_PORT, frame, sizeof(frame), &written, portMAX_DELAY);
+
+        /*
+         * Jeder gesendete DMA-Puffer meldet TX_DONE. Mit tx_desc_auto_clear
+         * sendet die DMA Stille, wenn kein neuer Block bereitliegt – das
+         * zählt ebenfalls. Mehr TX_DONE als geschriebene Blöcke = Underrun.
+         */
+        i2s_event_t ev;
+        while (xQueueReceive(i2s_events, &ev, 0) == pdTRUE)
+        {
+            if (ev.type == I2S_EVENT_TX_DONE)
+                tx_done++;
+        }
+
+        if (!started)
+        {
+            // Stille vor dem ersten Block ist kein Underrun
+            tx_done_at_start = tx_done;
+            started = true;
+        }
+
+        stats.blocks++;
+        run_blocks++;
+        stats.render_cycles += cycles;
+        stats.voice_samples += (uint64_t)voices * SYNTH_BLOCK;
+        if (cycles > stats.render_cycles_max)
+            stats.render_cycles_max = cycles;
+
+        uint32_t sent = tx_done - tx_done_at_start;
+        if (sent > run_blocks)
+            stats.underruns = underruns_before + (sent - run_blocks);
+
+        // Erst anhalten, wenn auch die DMA-Puffer nur noch Stille enthalten
+        silent = voices == 0 ? silent + 1 : 0;
+        if (silent >= AUDIO_DMA_BUFS)
+        {
+            i2s_stop(AUDIO_I2S_PORT);
+            i2s_zero_dma_buffer(AUDIO_I2S_PORT);
+            xQueueReset(i2s_events);
+            underruns_before = stats.underruns;
+            run_blocks = 0;
+            tx_done = 0;
+            silent = 0;
+            started = false;
+            power_release(POWER_LOCK_SYNTH);
+        }
+    }
+}
+
+/* synth_play() im UI-Task */
+static void audio_wake(void)
+{
+    xTaskNotifyGive(task);
+}
+
+void audio_init(void)
+{
+    synth_init();
+
+    i2s_config_t cfg = {
+        .mode = I2S_MODE_MASTER | I2S_MODE_TX | I2S_MODE_DAC_BUILT_IN,
+        .sample_rate = SYNTH_SAMPLE_RATE,
+        .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+        .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,
+        .communication_format = I2S_COMM_FORMAT_STAND_MSB,
+        .intr_alloc_flags = 0,
+        .dma_buf_count = AUDIO_DMA_BUFS,
+        .dma_buf_len = SYNTH_BLOCK,
+        .use_apll = false,
+        .tx_desc_auto_clear = true,
+    };
+
+    ESP_ERROR_CHECK(i2s_driver_install(AUDIO_I2S_PORT, &cfg, 8, &i2s_events));
+    ESP_ERROR_CHECK(i2s_set_dac_mode(I2S_DAC_CHANNEL_BOTH_EN));
+    i2s_stop(AUDIO_I2S_PORT); // startet erst mit der ersten Note
+
+    xTaskCreatePinnedToCore(audio_task_fn, "audio", AUDIO_TASK_STACK, NULL,
+                            AUDIO_TASK_PRIO, &task, AUDIO_TASK_CORE);
+    synth_set_wake(audio_wake);
+
+    // Erst beim ersten Mode mit Synth (playbox_hw_need()): nicht auf die UART warten
+    DLOGI(DLOG_AUDIO, "I2S DAC %d Hz, %d voices, block %d", SYNTH_SAMPLE_RATE, SYNTH_VOICES, SYNTH_BLOCK);
+}
+
+TaskHandle_t audio_task(void)
+{
+    return task;
+}
+
+const audio_stats_t *audio_stats(void)
+{
+    stats.voices_per_core = audio_voices_per_core(&stats, CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ * 1000000, SYNTH_SAMPLE_RATE);
+    return &stats;
+}
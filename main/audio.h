@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/*
+ * Audio-Ausgabe des Synths (synth.h) über I2S-DMA auf den eingebauten DAC
+ * (GPIO25/GPIO26). Der Audio-Task rendert einen Block, während die DMA den
+ * vorherigen ausgibt.
+ */
+
+typedef struct
+{
+    uint32_t blocks;         // gerenderte und geschriebene Blöcke
+    uint32_t underruns;      // Blöcke, die die DMA ohne neue Daten senden musste
+    uint32_t render_cycles_max;  // längster Block in CPU-Zyklen
+    uint64_t render_cycles;      // Summe über alle Blöcke
+    uint64_t voice_samples;      // Summe aktiver Stimmen x Samples
+    uint32_t voices_per_core;    // geschätzte Stimmen, die ein Kern in Echtzeit schafft
+} audio_stats_t;
+
+/**
+ * audio_init - Synth, I2S-Treiber und Audio-Task starten
+ *
+ * Übernimmt beide DAC-Kanäle; dac_output_enable() ist danach nicht mehr nötig.
+ */
+void audio_init(void);
+
+const audio_stats_t *audio_stats(void);
+
+/* Für uxTaskGetStackHighWaterMark(), NULL ohne eigenen Task (Host) */
+TaskHandle_t audio_task(void);
+
+/* Hilfsfunktion für audio_stats(): Zyklen pro Stimme und Sample -> Stimmen */
+static inline uint32_t audio_voices_per_core(const audio_stats_t *st, uint32_t cpu_hz, uint32_t sample_rate)
+{
+    if (st->voice_samples == 0 || st->render_cycles == 0)
+        return 0;
+
+    // Budget pro Sample / Kosten pro Stimme und Sample
+    return (uint32_t)((uint64_t)cpu_hz * st->voice_samples / sample_rate / st->render_cycles);
+}
@@ -0,0 +1,55 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "boot.h"
+
+static const char *TAG = "BOOT";
+
+static int64_t stamps[BOOT_STAGE_COUNT];
+static bool marked[BOOT_STAGE_COUNT];
+
+static const char *const stage_names[BOOT_STAGE_COUNT] = {
+    [BOOT_APP_START] = "app",
+    [BOOT_BUZZER_READY] = "buzzer",
+    [BOOT_SONG_QUEUED] = "song",
+    [BOOT_FIRST_NOTE] = "note",
+    [BOOT_INPUT_LIVE] = "input",
+    [BOOT_INIT_DONE] = "init",
+};
+
+void boot_mark(boot_stage_t stage)
+{
+    if (stage >= BOOT_STAGE_COUNT || marked[stage])
+        return;
+
+    stamps[stage] = esp_timer_get_time();
+    marked[stage] = true;
+}
+
+int64_t boot_time_us(boot_stage_t stage)
+{
+    if (stage >= BOOT_STAGE_COUNT || !marked[stage])
+        return -1;
+    return stamps[stage];
+}
+
+void boot_report(void)
+{
+    char line[160];
+    int len = 0;
+
+    for (int s = 0; s < BOOT_STAGE_COUNT && len < (int)sizeof(line); s++)
+    {
+        if (marked[s])
+            len += snprintf(line + len, sizeof(line) - len, " %s=%u.%02u", stage_names[s],
+                            (unsigned)(stamps[s] / 1000), (unsigned)(stamps[s] % 1000 / 10));
+        else
+            len += snprintf(line + len, sizeof(line) - len, " %s=-", stage_names[s]);
+    }
+
+    ESP_LOGI(TAG, "ms since start:%s", line);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Zeitstempel der Startphasen, vom Reset bis zur bedienbaren Box.
+ *
+ * Jede Phase wird beim ersten boot_mark() mit esp_timer_get_time()
+ * festgehalten, spätere Aufrufe ändern nichts. Die Uhr läuft ab dem Start
+ * der App-CPU: ROM und Bootloader davor sind nicht enthalten, deren Dauer
+ * steht in den Zeitstempeln des Bootloader-Logs (sdkconfig).
+ *
+ * Jede Phase hat genau einen Schreiber; boot_report() liest erst, wenn
+ * alles gelaufen ist.
+ */
+
+typedef enum
+{
+    BOOT_APP_START = 0, // playbox_init() betreten
+    BOOT_BUZZER_READY,  // Buzzer-Timer, Kanal und Sequenzer laufen
+    BOOT_SONG_QUEUED,   // Startsong beim Sequenzer
+    BOOT_FIRST_NOTE,    // erster Ton hörbar (Sequenzer-Task)
+    BOOT_INPUT_LIVE,    // Taster-ISR aktiv: Drücke bekommen ihren Zeitstempel
+    BOOT_INIT_DONE,     // playbox_init() fertig, die Hauptschleife wertet aus
+    BOOT_STAGE_COUNT
+} boot_stage_t;
+
+/* Phase @stage erreicht; nur der erste Aufruf zählt */
+void boot_mark(boot_stage_t stage);
+
+/* Zeitpunkt von @stage in µs seit dem Start der Uhr, -1 wenn noch nicht erreicht */
+int64_t boot_time_us(boot_stage_t stage);
+
+/* Alle Phasen einmal über das Log ausgeben */
+void boot_report(void);
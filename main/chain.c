@@ -0,0 +1,123 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+
+#include "chain.h"
+#include "input.h"
+
+static const char *TAG = "CHAIN";
+
+#define CHAIN_BYTES_MAX ((INPUT_CHAIN_MAX + 7) / 8)
+
+static spi_device_handle_t chain_dev = NULL;
+static int chain_nbits = 0;
+static int chain_nbytes = 0;
+static uint32_t chain_unused = 0; // Bits ohne Eingang: immer losgelassen
+static uint32_t reads = 0;
+
+// DMA-Ziel im internen RAM, wortweise ausgerichtet
+static WORD_ALIGNED_ATTR DMA_ATTR uint8_t chain_rx[4];
+
+/* Eine Transaktion: /PL hoch, chain_nbytes Byte nach chain_rx schieben, /PL wieder runter */
+static bool chain_transfer(void)
+{
+    spi_transaction_t t = {
+        .length = (size_t)chain_nbytes * 8,
+        .rxlength = (size_t)chain_nbytes * 8,
+        .rx_buffer = chain_rx, // kein tx_buffer: MOSI ist nicht belegt
+    };
+
+    // Polling statt Queue: drei Byte sind schneller fertig als ein Task-Wechsel
+    if (spi_device_polling_transmit(chain_dev, &t) != ESP_OK)
+        return false;
+
+    reads++;
+    return true;
+}
+
+bool chain_init(int bits)
+{
+    const spi_bus_config_t bus = {
+        .mosi_io_num = -1,
+        .miso_io_num = CHAIN_MISO_PIN,
+        .sclk_io_num = CHAIN_SCLK_PIN,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = CHAIN_BYTES_MAX,
+    };
+    const spi_device_interface_config_t dev = {
+        .mode = 0,
+        .clock_speed_hz = CHAIN_SPI_HZ,
+        .spics_io_num = CHAIN_PL_PIN,
+        .flags = SPI_DEVICE_POSITIVE_CS,
+        .queue_size = 1,
+    };
+
+    if (bits <= 0 || bits > INPUT_CHAIN_MAX)
+        return false;
+
+    chain_nbits = bits;
+    chain_nbytes = (bits + 7) / 8;
+    chain_unused = bits < 32 ? ~0u << bits : 0;
+
+    esp_err_t err = spi_bus_initialize(CHAIN_SPI_HOST, &bus, SPI_DMA_CH_AUTO);
+    if (err == ESP_OK)
+        err = spi_bus_add_device(CHAIN_SPI_HOST, &dev, &chain_dev);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "SPI init failed: %s", esp_err_to_name(err));
+        chain_dev = NULL;
+        chain_nbits = 0;
+        return false;
+    }
+
+    // Offener MISO liest 0, eine Kette mit losgelassenen Tastern lauter 1
+    gpio_pulldown_en(CHAIN_MISO_PIN);
+
+    uint8_t any = 0;
+    if (chain_transfer())
+    {
+        for (int i = 0; i < chain_nbytes; i++)
+            any |= chain_rx[i];
+    }
+    if (!any)
+    {
+        spi_bus_remove_device(chain_dev);
+        spi_bus_free(CHAIN_SPI_HOST);
+        chain_dev = NULL;
+        chain_nbits = 0;
+        ESP_LOGI(TAG, "no shift register chain");
+        return false;
+    }
+
+    ESP_LOGI(TAG, "%d inputs, %d byte per read", chain_nbits, chain_nbytes);
+    return true;
+}
+
+int chain_bits(void)
+{
+    return chain_nbits;
+}
+
+uint32_t chain_read(void)
+{
+    uint32_t bits = chain_unused;
+
+    if (!chain_dev || !chain_transfer())
+        return ~0u;
+
+    // MSB zuerst geschoben: Bit 7 von Byte 0 ist Eingang 0
+    for (int n = 0; n < chain_nbits; n++)
+        bits |= (uint32_t)((chain_rx[n / 8] >> (7 - n % 8)) & 1) << n;
+    return bits;
+}
+
+uint32_t chain_reads(void)
+{
+    return reads;
+}
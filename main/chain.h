@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+
+/*
+ * Zusätzliche Taster über eine Kette von 74HC165 (parallel rein, seriell
+ * raus), gelesen per SPI-DMA in einer Transaktion.
+ *
+ * /PL hängt am CS-Pin, der mit SPI_DEVICE_POSITIVE_CS im Ruhezustand low
+ * ist: die Register laden dann ständig die Eingänge. Die steigende Flanke
+ * zu Beginn der Transaktion friert alle Bits gleichzeitig ein, danach
+ * schiebt SCLK sie heraus (Modus 0, das erste Bit liegt schon an). Bit n
+ * der Kette ist das n-te geschobene Bit: D7 des Registers am MISO zuerst.
+ *
+ * Taster sind active low wie an den GPIOs (Pull-ups auf der Platine),
+ * unbenutzte Eingänge liegen auf high. Ohne Kette zieht der Pull-down am
+ * MISO alles auf 0: so erkennt chain_init(), dass nichts angeschlossen ist.
+ */
+
+#define CHAIN_SPI_HOST SPI2_HOST // HSPI, Pins über die GPIO-Matrix
+#define CHAIN_SPI_HZ 2000000    // 8 Bit = 4 µs, weit unter dem 74HC165-Limit
+
+#define CHAIN_SCLK_PIN GPIO_NUM_17 // statt der nicht bestückten P2-LED grün
+#define CHAIN_PL_PIN GPIO_NUM_0    // Strapping-Pin: /PL ist ein Eingang, stört den Boot nicht
+#define CHAIN_MISO_PIN GPIO_NUM_2  // Strapping-Pin: nur im Download-Mode relevant
+
+/**
+ * chain_init - SPI-Bus einrichten und die Kette suchen
+ * @bits: erwartete Eingänge, höchstens INPUT_CHAIN_MAX (input.h)
+ *
+ * Liest einmal; kommen nur Nullen, gilt die Kette als nicht angeschlossen
+ * und der Bus wird wieder freigegeben. Gibt true zurück, wenn sie da ist.
+ */
+bool chain_init(int bits);
+
+/* Eingänge der erkannten Kette, 0 ohne Kette */
+int chain_bits(void);
+
+/**
+ * chain_read - alle Eingänge lesen (Scan-Timer, esp_timer-Task)
+ *
+ * Bit n = Eingang n, 1 = losgelassen. Bits über chain_bits() und alle Bits
+ * ohne Kette sind 1.
+ */
+uint32_t chain_read(void);
+
+/* SPI-Transaktionen seit dem Start */
+uint32_t chain_reads(void);
@@ -0,0 +1,36 @@
+#include "debounce.h"
+
+void debounce_init(debounce_t *db, uint64_t raw)
+{
+    db->state = raw;
+    db->last = raw;
+    db->locked = 0;
+    db->cnt0 = 0;
+    db->cnt1 = 0;
+}
+
+uint64_t debounce_edge(debounce_t *db, uint64_t raw, uint64_t mask)
+{
+    uint64_t toggle = (raw ^ db->state) & ~db->locked & mask;
+
+    db->last = (db->last & ~mask) | (raw & mask);
+    db->state ^= toggle;
+    db->locked |= toggle;
+    db->cnt0 &= ~toggle;
+    db->cnt1 &= ~toggle;
+    return toggle;
+}
+
+uint64_t debounce_update(debounce_t *db, uint64_t raw)
+{
+    // Gesperrte Bits mit gleichem Rohpegel wie zuvor: 00 -> 01 -> 10 -> 11 -> 00, sonst 00
+    uint64_t steady = ~(raw ^ db->last) & db->locked;
+    db->cnt1 = (db->cnt1 ^ db->cnt0) & steady;
+    db->cnt0 = ~db->cnt0 & steady;
+    db->last = raw;
+
+    // Übertrag nach 00: DEBOUNCE_SAMPLES ruhige Abtastungen in Folge
+    db->locked &= ~(steady & ~(db->cnt0 | db->cnt1));
+
+    return debounce_edge(db, raw, ~0ULL);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Bit-paralleles Entprellen aller Eingänge mit vertikalen Zählern.
+ *
+ * Reine Logik ohne Hardwarezugriff: pro Abtastung ein 64-Bit-Wort mit den
+ * Rohpegeln (Bit n = GPIO n, aus GPIO_IN_REG/GPIO_IN1_REG), auf dem Host
+ * aus dem Simulator. Entprellt wird an der ersten Flanke: ein Pin übernimmt
+ * den neuen Pegel sofort und ist danach gesperrt, bis sein Rohpegel
+ * DEBOUNCE_SAMPLES Abtastungen in Folge gleich geblieben ist. Prellen in
+ * der Sperre setzt nur den Zähler zurück, es gibt weder einen zweiten Druck
+ * noch ein falsches Loslassen. Steht der Pin nach der Sperre auf dem
+ * anderen Pegel, ist das die nächste Flanke. Jedes Bit hat einen 2-Bit-
+ * Zähler, verteilt auf die Wörter cnt0/cnt1. Kosten: eine Handvoll
+ * Bitoperationen für alle Pins.
+ */
+
+#define DEBOUNCE_SAMPLES 4 // durch die 2-Bit-Zähler festgelegt
+
+typedef struct
+{
+    uint64_t state;  // entprellte Pegel
+    uint64_t last;   // Rohpegel der letzten Abtastung oder Flanke
+    uint64_t locked; // Pins in der Sperre nach einem Wechsel
+    uint64_t cnt0;   // Zähler Bit 0
+    uint64_t cnt1;   // Zähler Bit 1
+} debounce_t;
+
+/* Mit den aktuellen Pegeln starten, ohne Flanken zu melden */
+void debounce_init(debounce_t *db, uint64_t raw);
+
+/**
+ * debounce_edge - Flanke sofort übernehmen, etwa aus der GPIO-ISR
+ * @raw: Rohpegel, gültig nur in @mask
+ * @mask: Pins, deren Pegel @raw kennt
+ *
+ * Gibt die Pins zurück, die dabei gekippt sind, also nicht gesperrt waren;
+ * der neue Pegel steht in db->state, die Pins sind jetzt gesperrt.
+ */
+uint64_t debounce_edge(debounce_t *db, uint64_t raw, uint64_t mask);
+
+/**
+ * debounce_update - eine Abtastung verarbeiten
+ * @raw: Rohpegel aller Pins
+ *
+ * Zählt die Sperren weiter und übernimmt Flanken aller freien Pins wie
+ * debounce_edge(). Gibt die Pins zurück, die in dieser Abtastung gekippt
+ * sind.
+ */
+uint64_t debounce_update(debounce_t *db, uint64_t raw);
+
+/* Kein Pin gesperrt oder abweichend: weitere Abtastungen ändern nichts */
+static inline bool debounce_idle(const debounce_t *db, uint64_t raw)
+{
+    return db->locked == 0 && raw == db->state;
+}
@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#include "dlog.h"
+
+#define DLOG_TASK_CORE 1  // Core 1 hat die meiste Leerlaufzeit
+#define DLOG_TASK_PRIO 1  // unter allem anderen: Ausgabe nur, wenn Zeit ist
+#define DLOG_TASK_STACK 3072 // vsnprintf
+
+static const char *const tag_names[DLOG_TAG_COUNT] = {
+    [DLOG_APP] = "APP",
+    [DLOG_MODE] = "MODE",
+    [DLOG_SONG] = "SONG",
+    [DLOG_QUIZ] = "QUIZ",
+    [DLOG_TASKS] = "TASKS",
+    [DLOG_SEQ] = "SEQ",
+    [DLOG_REC] = "REC",
+    [DLOG_AUDIO] = "AUDIO",
+    [DLOG_ANALOG] = "ANALOG",
+};
+
+/*
+ * Begrenzter Ring für mehrere Schreiber (UI-Task, Sequenzer) und einen
+ * Leser, nach D. Vyukov: jeder Platz trägt eine Sequenznummer. Ein
+ * Schreiber reserviert Position p per CAS auf head, wenn der Platz p frei
+ * ist (seq == p), füllt ihn und gibt ihn mit seq = p + 1 frei. Der Leser
+ * nimmt Position t, sobald seq == t + 1, und reicht den Platz mit
+ * seq = t + DLOG_CAPACITY an die nächste Runde weiter.
+ *
+ * Ein unterbrochener Schreiber hält nur seinen eigenen Platz auf: der Leser
+ * hört dort auf und macht beim nächsten Wecken weiter.
+ */
+typedef struct
+{
+    atomic_uint seq;
+    uint8_t level;
+    uint8_t tag;
+    int64_t time_us;
+    const char *fmt;
+    int32_t args[DLOG_ARGS];
+} dlog_slot_t;
+
+static dlog_slot_t ring[DLOG_CAPACITY];
+static atomic_uint head; // nächste Schreibposition, alle Schreiber
+static unsigned tail;    // nächste Leseposition, nur der Log-Task
+
+// Schreiber -> Log-Task: schon geweckt, noch nicht abgeholt
+static atomic_bool wake_pending;
+
+static atomic_uint written;
+static atomic_uint dropped;
+static atomic_uint emitted;
+
+static TaskHandle_t task = NULL;
+
+static bool slot_take(dlog_slot_t *out)
+{
+    dlog_slot_t *slot = &ring[tail % DLOG_CAPACITY];
+
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != tail + 1)
+        return false;
+
+    *out = *slot; // seq ist bei der Kopie egal
+    atomic_store_explicit(&slot->seq, tail + DLOG_CAPACITY, memory_order_release);
+    tail++;
+    return true;
+}
+
+static void dlog_emit(const dlog_slot_t *s)
+{
+    static const char letters[] = "NEWIDV";
+    char msg[128];
+
+    snprintf(msg, sizeof(msg), s->fmt, s->args[0], s->args[1], s->args[2], s->args[3]);
+    esp_log_write((esp_log_level_t)s->level, tag_names[s->tag], "%c (%u) %s: %s\n",
+                  letters[s->level], (unsigned)(s->time_us / 1000), tag_names[s->tag], msg);
+}
+
+static void dlog_task_fn(void *arg)
+{
+    unsigned reported = 0;
+    dlog_slot_t s;
+
+    (void)arg;
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // Vor dem Leeren zurücksetzen: was danach kommt, weckt erneut
+        atomic_exchange(&wake_pending, false);
+
+        while (slot_take(&s))
+        {
+            dlog_emit(&s);
+            atomic_fetch_add_explicit(&emitted, 1, memory_order_relaxed);
+        }
+
+        unsigned lost = atomic_load_explicit(&dropped, memory_order_relaxed);
+        if (lost != reported)
+        {
+            esp_log_write(ESP_LOG_WARN, "LOG", "W (%u) LOG: %u records dropped\n",
+                          (unsigned)(esp_timer_get_time() / 1000), lost - reported);
+            reported = lost;
+        }
+    }
+}
+
+void dlog_init(void)
+{
+    for (unsigned i = 0; i < DLOG_CAPACITY; i++)
+        atomic_init(&ring[i].seq, i);
+    atomic_init(&head, 0);
+    tail = 0;
+    atomic_init(&wake_pending, false);
+
+    xTaskCreatePinnedToCore(dlog_task_fn, "dlog", DLOG_TASK_STACK, NULL,
+                            DLOG_TASK_PRIO, &task, DLOG_TASK_CORE);
+}
+
+void dlog_write(esp_log_level_t level, dlog_tag_t tag, const char *fmt, const int32_t *args)
+{
+    int64_t now = esp_timer_get_time();
+    unsigned pos = atomic_load_explicit(&head, memory_order_relaxed);
+    dlog_slot_t *slot;
+
+    if (task == NULL)
+    {
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    for (;;)
+    {
+        slot = &ring[pos % DLOG_CAPACITY];
+        int diff = (int)(atomic_load_explicit(&slot->seq, memory_order_acquire) - pos);
+
+        if (diff == 0)
+        {
+            // Platz frei: reservieren; bei Konkurrenz steht pos danach neu
+            if (atomic_compare_exchange_weak_explicit(&head, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // Leser eine Runde zurück: voll
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = atomic_load_explicit(&head, memory_order_relaxed);
+        }
+    }
+
+    slot->level = (uint8_t)level;
+    slot->tag = (uint8_t)tag;
+    slot->time_us = now;
+    slot->fmt = fmt;
+    for (int i = 0; i < DLOG_ARGS; i++)
+        slot->args[i] = args[i];
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    atomic_fetch_add_explicit(&written, 1, memory_order_relaxed);
+
+    // Nur der erste Satz seit dem letzten Leeren weckt den Log-Task
+    if (!atomic_exchange(&wake_pending, true))
+        xTaskNotifyGive(task);
+}
+
+void dlog_read_stats(dlog_stats_t *stats)
+{
+    stats->written = atomic_load_explicit(&written, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&dropped, memory_order_relaxed);
+    stats->emitted = atomic_load_explicit(&emitted, memory_order_relaxed);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_log.h"
+
+/*
+ * Verzögertes Logging für die Hauptschleife und den Sequenzer.
+ *
+ * ESP_LOGx formatiert im Aufrufer und schreibt in die UART; ist der FIFO
+ * voll, wartet er auf die Leitung (115200 Baud: ~4 ms für 50 Zeichen) –
+ * mitten in der Schleife, die Töne und LEDs taktet. DLOGx legt stattdessen
+ * nur einen Binärsatz (Tag, Zeitstempel, Format-Zeiger, bis zu DLOG_ARGS
+ * Integer) in einen lock-freien Ring; ein Task niedriger Priorität auf
+ * Core 1 formatiert und gibt aus. Ein Aufruf kostet einige hundert Zyklen.
+ *
+ * Regeln:
+ *  - Das Format muss statisch sein (Stringliteral im Flash), es wird erst
+ *    später gelesen.
+ *  - Nur Integer-Argumente bis 32 Bit (%d, %u, %x, %c); 64-Bit-Werte und
+ *    Strings vorher umwandeln bzw. weglassen.
+ *  - Aus Tasks, nicht aus ISRs.
+ *  - Ist der Ring voll, geht der Satz verloren und wird gezählt; der
+ *    Log-Task meldet verlorene Sätze.
+ *
+ * Zeilen erscheinen mit dem Zeitstempel des Aufrufs, aber erst, wenn der
+ * Log-Task dran ist: direkte ESP_LOGx-Zeilen können sich dazwischen schieben.
+ * Für Meldungen beim Start und seltene Berichte bleibt ESP_LOGx richtig.
+ */
+
+#define DLOG_ARGS 4
+#define DLOG_CAPACITY 64 // Sätze, Zweierpotenz
+
+typedef enum
+{
+    DLOG_APP = 0,
+    DLOG_MODE,
+    DLOG_SONG,
+    DLOG_QUIZ,
+    DLOG_TASKS,
+    DLOG_SEQ,
+    DLOG_REC,
+    DLOG_AUDIO,
+    DLOG_ANALOG,
+    DLOG_TAG_COUNT
+} dlog_tag_t;
+
+typedef struct
+{
+    uint32_t written; // angenommene Sätze
+    uint32_t dropped; // Ring voll oder vor dlog_init()
+    uint32_t emitted; // vom Log-Task ausgegeben
+} dlog_stats_t;
+
+/* Ring anlegen und den Log-Task starten; vorher geschriebene Sätze zählen als verloren */
+void dlog_init(void);
+
+/**
+ * dlog_write - einen Satz ablegen
+ * @level: ESP_LOG_ERROR .. ESP_LOG_VERBOSE
+ * @fmt: statischer printf-Format-String
+ * @args: DLOG_ARGS Werte, nicht benutzte 0
+ *
+ * Direkt nur über die DLOGx-Makros aufrufen.
+ */
+void dlog_write(esp_log_level_t level, dlog_tag_t tag, const char *fmt, const int32_t *args);
+
+/* Zähler, aus jedem Task */
+void dlog_read_stats(dlog_stats_t *stats);
+
+/* Nur für die Formatprüfung des Compilers, wird nie aufgerufen */
+static inline void __attribute__((format(printf, 1, 2))) dlog_check_format(const char *fmt, ...)
+{
+    (void)fmt;
+}
+
+#define DLOG_LEVEL(level, tag, fmt, ...)                                                  \
+    do                                                                                    \
+    {                                                                                     \
+        if (0)                                                                            \
+            dlog_check_format(fmt, ##__VA_ARGS__);                                        \
+        dlog_write(level, tag, fmt, (const int32_t[DLOG_ARGS]){__VA_ARGS__});             \
+    } while (0)
+
+#define DLOGE(tag, fmt, ...) DLOG_LEVEL(ESP_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#define DLOGW(tag, fmt, ...) DLOG_LEVEL(ESP_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define DLOGI(tag, fmt, ...) DLOG_LEVEL(ESP_LOG_INFO, tag, fmt, ##__VA_ARGS__)
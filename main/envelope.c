@@ -0,0 +1,182 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "envelope.h"
+
+bool env_fade(env_fade_t *f, uint32_t from, uint32_t to, uint32_t freq_hz, uint32_t max_us)
+{
+    uint32_t delta = from > to ? from - to : to - from;
+    uint32_t budget = (uint32_t)((uint64_t)max_us * freq_hz / 1000000);
+
+    f->duty = (uint16_t)to;
+    f->len_us = 0;
+    f->scale = 0;
+    f->cycle_num = 0;
+
+    // Startperiode plus mindestens ein Schritt
+    if (delta == 0 || budget < 2)
+        return false;
+    uint32_t usable = budget - 1;
+
+    if (usable >= delta)
+    {
+        f->scale = 1;
+        f->cycle_num = (uint16_t)(usable / delta > ENV_STEP_MAX ? ENV_STEP_MAX : usable / delta);
+    }
+    else
+    {
+        // Größere Schritte, bis auch der Rest noch hineinpasst
+        uint32_t scale = (delta + usable - 1) / usable;
+        while (env_fade_cycles(delta, scale, 1) > budget)
+            scale++;
+        if (scale > ENV_STEP_MAX)
+            return false; // hohe Auflösung, zu wenige Perioden
+        f->scale = (uint16_t)scale;
+        f->cycle_num = 1;
+    }
+
+    uint32_t total = env_fade_cycles(delta, f->scale, f->cycle_num);
+    f->len_us = (uint32_t)(((uint64_t)total * 1000000 + freq_hz - 1) / freq_hz);
+    return true;
+}
+
+/* Stücke einer Stufe: etwa ENV_PIECE_US lang, jedes mit genug Perioden und Duty-Schritten */
+static uint8_t env_pieces(uint32_t len_us, uint32_t delta, uint32_t freq_hz)
+{
+    uint32_t cycles = (uint32_t)((uint64_t)len_us * freq_hz / 1000000);
+    uint32_t k = len_us / ENV_PIECE_US;
+
+    if (k > cycles / ENV_PIECE_CYCLES)
+        k = cycles / ENV_PIECE_CYCLES;
+    if (k > delta)
+        k = delta;
+    if (k > UINT8_MAX)
+        k = UINT8_MAX;
+
+    return k < 1 ? 1 : (uint8_t)k;
+}
+
+/* Stück next_piece der Stufe next_stage nach plan->pending */
+static void env_prepare(env_plan_t *plan)
+{
+    if (plan->next_stage >= plan->count)
+        return;
+
+    const env_stage_t *st = &plan->stage[plan->next_stage];
+    env_fade_t *f = &plan->pending;
+    uint32_t j = plan->next_piece;
+    uint32_t win_start = st->at_us + (uint32_t)((uint64_t)st->len_us * j / st->pieces);
+    uint32_t win_end = st->at_us + (uint32_t)((uint64_t)st->len_us * (j + 1) / st->pieces);
+    int32_t delta = (int32_t)st->to - (int32_t)st->from;
+    uint32_t from = (uint32_t)(st->from + delta * (int32_t)j / st->pieces);
+    uint32_t to = (uint32_t)(st->from + delta * (int32_t)(j + 1) / st->pieces);
+
+    // Ohne Rampe ein harter Sprung auf das Ziel des Stücks
+    if (st->len_us == 0 || !env_fade(f, from, to, plan->freq_hz, win_end - win_start))
+    {
+        f->duty = (uint16_t)to;
+        f->len_us = 0;
+    }
+
+    // Die Release endet mit dem Fenster, alles andere beginnt mit ihm
+    f->at_us = st->align_end ? win_end - f->len_us : win_start;
+}
+
+/* Stufe anhängen; ohne passende Rampe als harter Sprung (@len_us = 0) */
+static void env_stage(env_plan_t *plan, uint32_t at_us, uint32_t len_us, uint32_t from, uint32_t to,
+                      bool align_end)
+{
+    env_stage_t *st = &plan->stage[plan->count++];
+    uint32_t delta = from > to ? from - to : to - from;
+    env_fade_t f;
+
+    if (!env_fade(&f, from, to, plan->freq_hz, len_us))
+    {
+        // Harter Sprung: die Release schneidet am Ende, alles andere springt sofort
+        at_us = align_end ? at_us + len_us : at_us;
+        len_us = 0;
+    }
+
+    st->at_us = at_us;
+    st->len_us = len_us;
+    st->from = (uint16_t)from;
+    st->to = (uint16_t)to;
+    st->pieces = len_us ? env_pieces(len_us, delta, plan->freq_hz) : 1;
+    st->align_end = align_end;
+}
+
+static void env_begin(env_plan_t *plan, uint32_t freq_hz)
+{
+    plan->freq_hz = freq_hz;
+    plan->count = 0;
+    plan->next_stage = 0;
+    plan->next_piece = 0;
+}
+
+void env_plan(env_plan_t *plan, const tone_env_t *env, uint32_t from, uint32_t peak,
+              uint32_t freq_hz, uint32_t duration_us)
+{
+    uint32_t a = env_ramp_us(env->attack_ms * 1000u, from > peak ? from - peak : peak - from, freq_hz);
+    uint32_t d = env->decay_ms * 1000u;
+    uint32_t r = env_ramp_us(env->release_ms * 1000u, peak, freq_hz);
+    uint32_t sustain = peak * env->sustain / 255;
+    uint32_t level = from;
+    env_fade_t f;
+
+    env_begin(plan, freq_hz);
+
+    if (a + d + r > duration_us || sustain == peak)
+    {
+        d = 0;
+        sustain = peak;
+    }
+    if (a + r > duration_us)
+    {
+        uint32_t ar = a + r;
+        a = (uint32_t)((uint64_t)a * duration_us / ar);
+        r = duration_us - a;
+    }
+
+    if (level != peak)
+    {
+        env_stage(plan, 0, a, level, peak, false);
+        level = peak;
+    }
+
+    // Decay: passt keine Rampe, bleibt der Ton auf der Spitze
+    if (d > 0 && env_fade(&f, level, sustain, freq_hz, d))
+    {
+        env_stage(plan, a, d, level, sustain, false);
+        level = sustain;
+    }
+
+    if (level > 0)
+        env_stage(plan, duration_us - r, r, level, 0, true);
+
+    env_prepare(plan);
+}
+
+bool env_release(env_plan_t *plan, uint32_t from, uint32_t freq_hz, uint32_t len_us)
+{
+    env_fade_t f;
+
+    env_begin(plan, freq_hz);
+    if (from == 0 || !env_fade(&f, from, 0, freq_hz, len_us))
+        return false;
+
+    env_stage(plan, 0, len_us, from, 0, true);
+    env_prepare(plan);
+    return true;
+}
+
+void env_next(env_plan_t *plan, env_fade_t *f)
+{
+    *f = plan->pending;
+
+    if (++plan->next_piece >= plan->stage[plan->next_stage].pieces)
+    {
+        plan->next_piece = 0;
+        plan->next_stage++;
+    }
+    env_prepare(plan);
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "songs.h"
+
+/*
+ * ADSR-Hüllkurven für den Buzzer als Folge von LEDC-Hardware-Rampen.
+ *
+ * Reine Logik ohne Hardwarezugriff: env_plan() legt für eine Note die
+ * Stufen Attack, Decay und Release fest, env_next() liefert daraus die
+ * einzelnen Rampen (ledc_set_fade_with_step), die im LEDC selbst laufen.
+ *
+ * Solange eine Rampe läuft, blockiert jeder andere Zugriff auf den Kanal;
+ * ein neues Kommando bricht sie deshalb mit ledc_fade_stop() ab. Jede Stufe
+ * besteht aus Stücken von etwa ENV_PIECE_US. Der Plan rechnet mit der
+ * Dauer, die die Hardware tatsächlich braucht (env_fade_cycles()); die
+ * Release endet genau mit der Note.
+ */
+
+#define ENV_STEP_MAX 1023 // scale und cycle_num: 10-Bit-Felder im LEDC
+#define ENV_PIECE_US 10000 // Stücklänge, bis zu doppelt so lang bei tiefen Tönen
+#define ENV_PIECE_CYCLES 4 // mindestens so viele PWM-Perioden pro Stück
+#define ENV_RAMP_CYCLES 2  // Attack und Release mindestens so viele Perioden, siehe env_ramp_us()
+
+/* Eine Rampe, oder ein harter Sprung bei len_us == 0 */
+typedef struct
+{
+    uint32_t at_us;  // Start relativ zum Notenanfang
+    uint32_t len_us; // Dauer in der Hardware, obere Schranke
+    uint16_t duty;   // Ziel
+    uint16_t scale;  // Duty-Schritt
+    uint16_t cycle_num; // PWM-Perioden pro Schritt
+} env_fade_t;
+
+/* Eine Stufe von @from nach @to im Zeitfenster [at_us, at_us + len_us] */
+typedef struct
+{
+    uint32_t at_us;
+    uint32_t len_us; // 0: harter Sprung bei at_us
+    uint16_t from;
+    uint16_t to;
+    uint8_t pieces;
+    bool align_end;  // Release: das letzte Stück endet genau am Fensterende
+} env_stage_t;
+
+typedef struct
+{
+    env_stage_t stage[3]; // Attack, Decay, Release; fehlende fallen weg
+    uint32_t freq_hz;
+    uint8_t count;
+    uint8_t next_stage; // Position von env_next()
+    uint8_t next_piece;
+    env_fade_t pending; // nächstes Stück, gültig solange next_stage < count
+} env_plan_t;
+
+/**
+ * env_fade_cycles - PWM-Perioden einer Rampe in der Hardware
+ * @delta: Duty-Abstand, @scale/@cycle_num wie ledc_set_fade_with_step()
+ *
+ * Start mit der nächsten Periode, delta/scale Schritte zu je cycle_num
+ * Perioden, ein Rest kommt als letzter Schritt dazu.
+ */
+static inline uint32_t env_fade_cycles(uint32_t delta, uint32_t scale, uint32_t cycle_num)
+{
+    if (scale == 0 || delta == 0)
+        return 0;
+
+    return 1 + delta / scale * cycle_num + (delta % scale ? 1 : 0);
+}
+
+/**
+ * env_fade - Rampe von @from nach @to, die in @max_us passt
+ *
+ * Die Duty ändert sich höchstens einmal pro PWM-Periode, also pro
+ * Schwingung des Tons: tiefe Töne bekommen grobere Rampen. Gibt false
+ * zurück, wenn keine zwei Perioden hineinpassen oder ein Schritt größer
+ * als ENV_STEP_MAX würde; dann bleibt nur ein harter Sprung.
+ */
+bool env_fade(env_fade_t *f, uint32_t from, uint32_t to, uint32_t freq_hz, uint32_t max_us);
+
+/**
+ * env_ramp_us - Attack oder Release von @len_us so verlängern, dass eine Rampe passt
+ * @delta: Duty-Abstand der Rampe
+ *
+ * Startperiode plus ein Schritt je ENV_STEP_MAX, mindestens ENV_RAMP_CYCLES
+ * Perioden bei @freq_hz. 0 bleibt 0, ein gewollter harter Sprung.
+ */
+static inline uint32_t env_ramp_us(uint32_t len_us, uint32_t delta, uint32_t freq_hz)
+{
+    if (len_us == 0 || freq_hz == 0)
+        return len_us;
+
+    uint32_t cycles = 1 + (delta + ENV_STEP_MAX - 1) / ENV_STEP_MAX;
+    if (cycles < ENV_RAMP_CYCLES)
+        cycles = ENV_RAMP_CYCLES;
+
+    uint32_t min_us = (uint32_t)(((uint64_t)cycles * 1000000 + freq_hz - 1) / freq_hz);
+    return len_us < min_us ? min_us : len_us;
+}
+
+/**
+ * env_plan - Stufen für eine Note
+ * @from: Duty zu Beginn (0, außer eine Note wird ohne Pause abgelöst)
+ * @peak: Duty nach dem Attack, aus der Lautstärke
+ * @duration_us: Länge der Note, die Release endet genau dort
+ *
+ * Attack und Release werden mit env_ramp_us() verlängert, damit auch
+ * tiefe Töne eine Rampe bekommen; nur 0 ms bleibt ein harter Sprung.
+ * Passen Attack, Decay und Release nicht in die Note, entfällt zuerst der
+ * Decay (der Ton bleibt auf der Spitze), dann werden Attack und Release
+ * anteilig gekürzt. Eine Stufe, für die keine Rampe mehr passt, wird zum
+ * harten Sprung.
+ */
+void env_plan(env_plan_t *plan, const tone_env_t *env, uint32_t from, uint32_t peak,
+              uint32_t freq_hz, uint32_t duration_us);
+
+/**
+ * env_release - nur eine Release ab sofort, für den Abbruch einer Note
+ * @len_us: Dauer, schon mit env_ramp_us() verlängert
+ *
+ * Gibt false zurück, wenn dafür keine Rampe passt (harter Schnitt).
+ */
+bool env_release(env_plan_t *plan, uint32_t from, uint32_t freq_hz, uint32_t len_us);
+
+/* Start des nächsten Stücks relativ zum Notenanfang; false, wenn der Plan durch ist */
+static inline bool env_next_at(const env_plan_t *plan, uint32_t *at_us)
+{
+    if (plan->next_stage >= plan->count)
+        return false;
+
+    *at_us = plan->pending.at_us;
+    return true;
+}
+
+/* Nächstes Stück nach @f und weiterzählen; nur wenn env_next_at() true liefert */
+void env_next(env_plan_t *plan, env_fade_t *f);
+
+/* Plan leeren, es folgt kein Stück mehr */
+static inline void env_clear(env_plan_t *plan)
+{
+    plan->count = 0;
+    plan->next_stage = 0;
+}
@@ -0,0 +1,275 @@
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#include "driver/gpio.h"
+#include "hal/gpio_ll.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "esp_sleep.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#include "input.h"
+#include "debounce.h"
+#include "chain.h"
+
+static QueueHandle_t input_queue = NULL;
+static input_stats_t stats;
+
+// Letzter bekannter Pegel je Pin (Task-Kontext), 1 = losgelassen
+static uint64_t input_levels = ~0ULL;
+
+/* Entprellen: ISR und Scan-Timer (esp_timer-Task), evtl. auf verschiedenen Cores */
+static uint64_t input_mask = 0;
+static debounce_t debouncer;
+static portMUX_TYPE debounce_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t scan_timer = NULL;
+static volatile bool scanning = false;
+
+// Schieberegister-Kette: wird gelesen, solange chain_on (UI-Task schaltet)
+static volatile bool chain_on = false;
+static uint64_t chain_mask = 0;
+
+/*
+ * Rohpegel aller Eingänge aus GPIO_IN_REG (GPIO0-31) und GPIO_IN1_REG
+ * (32-39), darüber die Kette. Mit @chain false gilt sie als losgelassen.
+ */
+static inline uint64_t input_read_raw(bool chain)
+{
+    uint64_t raw = REG_READ(GPIO_IN_REG) | ((uint64_t)(REG_READ(GPIO_IN1_REG) & 0xff) << 32);
+    raw = (raw & input_mask) | ~input_mask; // fremde Pins gelten als losgelassen
+
+    if (chain)
+        raw &= ((uint64_t)chain_read() << INPUT_GPIO_COUNT) | ~chain_mask;
+    return raw;
+}
+
+static inline void IRAM_ATTR input_scan_start(void)
+{
+    scanning = true;
+    esp_timer_start_periodic(scan_timer, INPUT_SCAN_US); // läuft evtl. schon, Fehler egal
+}
+
+/*
+ * Die Pins laufen mit Pegel- statt Flanken-Interrupts, weil nur diese die
+ * CPU aus dem Light Sleep wecken (gpio_wakeup_enable nutzt denselben
+ * Interrupt-Typ). Die ISR stellt jeweils auf den Gegenpegel um; das wirkt
+ * wie ein Flanken-Interrupt. Kippt der Pegel zwischen Lesen und Umstellen
+ * erneut, feuert der Interrupt sofort wieder, es geht also nichts verloren.
+ *
+ * Die erste Flanke eines freien Pins geht sofort in die Queue, mit ihrem
+ * Zeitstempel; der Pin ist danach gesperrt (debounce.h), weitere Flanken
+ * sind Prellen. Der Scan-Timer zählt die Sperre ab.
+ */
+static void IRAM_ATTR input_isr(void *arg)
+{
+    gpio_num_t pin = (gpio_num_t)(intptr_t)arg;
+    int level = gpio_ll_get_level(&GPIO, pin);
+    BaseType_t woken = pdFALSE;
+
+    gpio_ll_set_intr_type(&GPIO, pin, level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+
+    portENTER_CRITICAL_ISR(&debounce_lock);
+    uint64_t changed = debounce_edge(&debouncer, (uint64_t)(level != 0) << pin, 1ULL << pin);
+    stats.edges++;
+    if (changed)
+        stats.changes++;
+    portEXIT_CRITICAL_ISR(&debounce_lock);
+
+    if (changed)
+    {
+        input_event_t ev = {
+            .time_us = esp_timer_get_time(),
+            .id = (input_id_t)pin,
+            .level = (uint8_t)(level != 0),
+        };
+
+        if (xQueueSendFromISR(input_queue, &ev, &woken) != pdTRUE)
+            stats.dropped++;
+    }
+
+    if (!scanning)
+        input_scan_start();
+    if (woken)
+        portYIELD_FROM_ISR();
+}
+
+/**
+ * input_scan_cb - eine Abtastung aller Eingänge (esp_timer-Task)
+ *
+ * Zählt die Sperren ab und meldet Wechsel, die keine ISR gemeldet hat: die
+ * Kette, und Pins, die nach ihrer Sperre auf dem anderen Pegel stehen. Hält
+ * den Timer an, sobald kein Pin mehr gesperrt ist oder abweicht.
+ */
+static void input_scan_cb(void *arg)
+{
+    int64_t now = esp_timer_get_time();
+    bool chain = chain_on;
+    uint64_t raw = input_read_raw(chain);
+
+    (void)arg;
+
+    portENTER_CRITICAL(&debounce_lock);
+    uint64_t changed = debounce_update(&debouncer, raw);
+    uint64_t state = debouncer.state;
+    stats.changes += (uint32_t)__builtin_popcountll(changed);
+    portEXIT_CRITICAL(&debounce_lock);
+
+    while (changed)
+    {
+        int id = __builtin_ctzll(changed);
+        input_event_t ev = {
+            .time_us = now,
+            .id = (input_id_t)id,
+            .level = (uint8_t)((state >> id) & 1),
+        };
+
+        // Kette ohne ISR: die Flanke liegt im Mittel eine halbe Periode zurück
+        if ((chain_mask >> id) & 1)
+            ev.time_us = now - INPUT_SCAN_US / 2;
+
+        if (xQueueSend(input_queue, &ev, 0) != pdTRUE)
+            stats.dropped++;
+
+        changed &= changed - 1;
+    }
+
+    // Die Kette meldet sich nicht selbst: solange sie an ist, weiter abtasten
+    portENTER_CRITICAL(&debounce_lock);
+    bool idle = debounce_idle(&debouncer, raw);
+    portEXIT_CRITICAL(&debounce_lock);
+    if (chain || !idle)
+        return;
+
+    scanning = false;
+    esp_timer_stop(scan_timer);
+
+    // Flanke zwischen Prüfung und Stopp: die ISR hat evtl. keinen Timer bekommen,
+    // oder die Kette wurde gerade eingeschaltet
+    portENTER_CRITICAL(&debounce_lock);
+    idle = debounce_idle(&debouncer, input_read_raw(false));
+    portEXIT_CRITICAL(&debounce_lock);
+    if (scanning || chain_on || !idle)
+        input_scan_start();
+}
+
+void input_init(uint64_t pin_mask)
+{
+    const esp_timer_create_args_t args = {
+        .callback = input_scan_cb,
+        .name = "input_scan",
+    };
+
+    input_queue = xQueueCreate(INPUT_QUEUE_LEN, sizeof(input_event_t));
+    input_mask = pin_mask;
+    esp_timer_create(&args, &scan_timer);
+    debounce_init(&debouncer, input_read_raw(false));
+
+    gpio_install_isr_service(0);
+
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++)
+    {
+        if (!(pin_mask & (1ULL << pin)))
+            continue;
+
+        gpio_isr_handler_add((gpio_num_t)pin, input_isr, (void *)(intptr_t)pin);
+
+        // Auf den Gegenpegel des aktuellen Zustands warten, auch im Light Sleep
+        int level = gpio_get_level((gpio_num_t)pin);
+        input_levels = (input_levels & ~(1ULL << pin)) | ((uint64_t)(level != 0) << pin);
+        gpio_wakeup_enable((gpio_num_t)pin, level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    }
+
+    esp_sleep_enable_gpio_wakeup();
+
+    ESP_LOGI("INPUT", "ISR on %d pins", __builtin_popcountll(pin_mask));
+}
+
+void input_chain_enable(bool enable)
+{
+    int bits = chain_bits();
+
+    if (bits == 0 || enable == chain_on)
+        return;
+
+    chain_mask = ((1ULL << bits) - 1) << INPUT_GPIO_COUNT;
+    chain_on = enable;
+
+    // Ausschalten: der laufende Scan sieht die Kette losgelassen und hält an
+    if (enable)
+        input_scan_start();
+}
+
+bool input_wait(TickType_t timeout)
+{
+    input_event_t ev;
+    return xQueuePeek(input_queue, &ev, timeout) == pdTRUE;
+}
+
+void input_wake(void)
+{
+    input_event_t ev = {
+        .time_us = esp_timer_get_time(),
+        .id = INPUT_NONE,
+    };
+
+    if (xQueueSend(input_queue, &ev, 0) != pdTRUE)
+        stats.dropped++;
+}
+
+void IRAM_ATTR input_wake_from_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+    input_event_t ev = {
+        .time_us = esp_timer_get_time(),
+        .id = INPUT_NONE,
+    };
+
+    if (xQueueSendFromISR(input_queue, &ev, &woken) != pdTRUE)
+        stats.dropped++;
+    if (woken)
+        portYIELD_FROM_ISR();
+}
+
+void input_collect(input_frame_t *frame)
+{
+    input_event_t ev;
+
+    frame->pressed = 0;
+    frame->released = 0;
+
+    while (xQueueReceive(input_queue, &ev, 0) == pdTRUE)
+    {
+        if (ev.id == INPUT_NONE)
+            continue; // nur input_wake()
+
+        uint64_t bit = 1ULL << ev.id;
+        uint64_t level = ev.level ? bit : 0;
+
+        if ((input_levels & bit) == level)
+            continue; // keine echte Flanke
+
+        input_levels = (input_levels & ~bit) | level;
+
+        if (ev.level == 0)
+        {
+            if (!(frame->pressed & bit))
+                frame->press_time_us[ev.id] = ev.time_us;
+            frame->pressed |= bit;
+        }
+        else
+        {
+            frame->released |= bit;
+        }
+    }
+
+    frame->changed = frame->pressed | frame->released;
+}
+
+const input_stats_t *input_stats(void)
+{
+    return &stats;
+}
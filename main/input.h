@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+
+/* Größe der Queue entprellter Wechsel */
+#define INPUT_QUEUE_LEN 64
+
+/* Abtastperiode beim Entprellen: Sperre nach einer Flanke DEBOUNCE_SAMPLES x 1 ms ruhig = 4 ms */
+#define INPUT_SCAN_US 1000
+
+/*
+ * Eingänge 0..39 sind die GPIOs, dahinter folgen bis zu INPUT_CHAIN_MAX
+ * Eingänge der Schieberegister-Kette (chain.h). Alle passen in ein 64-Bit-
+ * Wort des Entprellers.
+ */
+typedef uint8_t input_id_t;
+
+#define INPUT_GPIO_COUNT GPIO_NUM_MAX
+#define INPUT_CHAIN_MAX 24
+#define INPUT_COUNT (INPUT_GPIO_COUNT + INPUT_CHAIN_MAX)
+#define INPUT_CHAIN(n) ((input_id_t)(INPUT_GPIO_COUNT + (n)))
+#define INPUT_NONE ((input_id_t)0xff)
+
+/* Alle Taster sind active low (Pull-up), Level 0 = gedrückt */
+typedef struct
+{
+    int64_t time_us; // erste Flanke des Wechsels (ISR, esp_timer-Zeit)
+    input_id_t id;   // INPUT_NONE: nur input_wake()
+    uint8_t level;
+} input_event_t;
+
+/* Alle entprellten Wechsel seit dem letzten input_collect() */
+typedef struct
+{
+    uint64_t pressed;  // Bit n = Eingang n wurde gedrückt
+    uint64_t released; // Bit n = Eingang n wurde losgelassen
+    uint64_t changed;  // pressed | released
+    int64_t press_time_us[INPUT_COUNT]; // Zeitstempel des ersten Drucks
+} input_frame_t;
+
+/**
+ * input_init - GPIO-ISR für alle Eingänge aus @pin_mask installieren
+ * @pin_mask: dieselbe Bitmaske wie in gpio_config_t.pin_bit_mask
+ *
+ * Die Pins müssen bereits als Eingang mit aktiviertem Interrupt konfiguriert
+ * sein. input_init() stellt sie auf Pegel-Interrupts um und meldet sie als
+ * Wakeup-Quelle für den Light Sleep an. Die erste Flanke meldet die ISR
+ * sofort; danach tastet ein esp_timer alle INPUT_SCAN_US die
+ * Eingangsregister ab, bis die Sperre gegen Prellen (debounce.h) vorbei ist.
+ */
+void input_init(uint64_t pin_mask);
+
+/**
+ * input_chain_enable - Schieberegister-Kette mit abtasten (UI-Task)
+ *
+ * Die Kette hat keinen Interrupt: solange sie eingeschaltet ist, läuft der
+ * Scan-Timer durchgehend und liest sie bei jeder Abtastung mit einer
+ * SPI-Transaktion. Ein Druck auf der Kette bekommt die Mitte zwischen zwei
+ * Abtastungen als Zeitstempel (±INPUT_SCAN_US/2). Ohne erkannte Kette
+ * (chain_bits() == 0) ohne Wirkung.
+ */
+void input_chain_enable(bool enable);
+
+/**
+ * input_wait - blockieren, bis ein Eingabe-Ereignis vorliegt
+ * @timeout: maximale Wartezeit in Ticks
+ *
+ * Entnimmt nichts aus der Queue. Gibt true zurück, wenn ein Ereignis wartet.
+ */
+bool input_wait(TickType_t timeout);
+
+/**
+ * input_wake - input_wait() ohne Tastendruck aufwecken
+ *
+ * Für Ereignisse außerhalb der Hauptschleife, z.B. ein abgelaufener
+ * LED-Effekt. Nicht aus einer ISR aufrufen.
+ */
+void input_wake(void);
+
+/* Wie input_wake(), aber aus einer ISR (z.B. MIDI-UART) */
+void input_wake_from_isr(void);
+
+/**
+ * input_collect - alle wartenden Ereignisse in @frame zusammenfassen
+ *
+ * Doppelte Flanken mit gleichem Pegel werden verworfen, damit pro Druck
+ * genau ein pressed-Bit entsteht.
+ */
+void input_collect(input_frame_t *frame);
+
+typedef struct
+{
+    uint32_t edges;   // Roh-Flanken in der ISR, inkl. Prellen
+    uint32_t changes; // entprellte Wechsel
+    uint32_t dropped; // verloren, weil die Queue voll war
+} input_stats_t;
+
+const input_stats_t *input_stats(void);
+
+static inline bool input_pressed(const input_frame_t *frame, input_id_t id)
+{
+    return (frame->pressed >> id) & 1ULL;
+}
+
+static inline bool input_released(const input_frame_t *frame, input_id_t id)
+{
+    return (frame->released >> id) & 1ULL;
+}
@@ -0,0 +1,358 @@
+#include <math.h> // powf() für die Gamma-Tabelle, nur in led_init()
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "driver/ledc.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "led.h"
+#include "profiler.h"
+
+static const char *TAG = "LED";
+
+#define LED_DUTY_MAX 8191 // 13 Bit, siehe LED_PWM_RES in playbox.c
+#define LED_GAMMA 2.2f
+
+/* Rampen werden in Stücke zerlegt: mindestens so viele für die Gamma-Kurve,
+ * und keins länger als LED_PIECE_MAX_MS, damit Vorrang schnell greift */
+#define LED_RAMP_PIECES_MIN 4
+#define LED_PIECE_MAX_MS 100
+
+#define LED_MAX_SEGMENTS 3
+
+typedef struct
+{
+    uint8_t to;   // Zielhelligkeit
+    bool ramp;    // false: springen und @ms halten
+    uint16_t ms;
+} led_segment_t;
+
+typedef struct
+{
+    ledc_mode_t mode;
+    ledc_channel_t channel;
+
+    led_fx_t layers[LED_PRIO_COUNT];
+    bool layer_active[LED_PRIO_COUNT];
+    int owner; // laufende Ebene, -1 = aus
+
+    /* Ablauf des laufenden Effekts */
+    led_segment_t seg[LED_MAX_SEGMENTS];
+    uint8_t seg_count;
+    uint8_t seg_idx;
+    bool hold;       // nach dem letzten Segment stehen bleiben
+    uint16_t count;  // Wiederholungen, 0 = endlos
+    uint16_t cycles;
+
+    uint8_t cur;     // Helligkeit am Ende des laufenden Stücks
+    uint8_t ramp_from;
+    uint16_t piece;
+    uint16_t pieces;
+    int64_t seg_start_us;
+
+    int64_t deadline_us; // nächster Schritt, 0 = nichts geplant
+    int64_t fade_end_us; // bis dahin läuft eine Hardware-Rampe
+} led_channel_t;
+
+static led_channel_t leds[LED_COUNT] = {
+    [LED_ORB] = {.mode = LED_LEDC_MODE, .channel = LEDC_CHANNEL_7},
+    [LED_P1_R] = {.mode = LED_LEDC_MODE, .channel = LEDC_CHANNEL_1},
+    [LED_P1_G] = {.mode = LED_LEDC_MODE, .channel = LEDC_CHANNEL_2},
+    [LED_P1_B] = {.mode = LED_LEDC_MODE, .channel = LEDC_CHANNEL_3},
+    [LED_P2_R] = {.mode = LED_LEDC_MODE, .channel = LEDC_CHANNEL_4},
+    [LED_P2_B] = {.mode = LED_LEDC_MODE, .channel = LEDC_CHANNEL_6},
+};
+
+static uint16_t gamma_duty[256];
+static bool hw_fade = false;
+static uint32_t writes = 0;
+
+static esp_timer_handle_t led_timer = NULL;
+static SemaphoreHandle_t led_lock = NULL;
+
+static const led_fx_t led_fx_off = {.kind = LED_FX_OFF};
+static void (*led_notify)(void) = NULL;
+
+/* ===================== Ausgabe ===================== */
+
+static void led_output(led_channel_t *ch, uint8_t b, uint32_t ms, int64_t now)
+{
+    uint32_t duty = gamma_duty[b];
+
+    if (ms > 0 && hw_fade)
+    {
+        ledc_set_fade_with_time(ch->mode, ch->channel, duty, (int)ms);
+        ledc_fade_start(ch->mode, ch->channel, LEDC_FADE_NO_WAIT);
+        ch->fade_end_us = now + (int64_t)ms * 1000;
+    }
+    else
+    {
+        ledc_set_duty(ch->mode, ch->channel, duty);
+        ledc_update_duty(ch->mode, ch->channel);
+    }
+
+    ch->cur = b;
+    writes++;
+}
+
+/* ===================== Ablauf ===================== */
+
+static void led_start(led_channel_t *ch, const led_fx_t *fx, int64_t now)
+{
+    led_segment_t *s = ch->seg;
+    uint32_t cycle_ms;
+
+    switch (fx->kind)
+    {
+    case LED_FX_ON:
+        s[0] = (led_segment_t){fx->level, false, 0};
+        ch->seg_count = 1;
+        break;
+    case LED_FX_FADE:
+        s[0] = (led_segment_t){fx->level, true, fx->fade_ms};
+        ch->seg_count = 1;
+        break;
+    case LED_FX_BLINK:
+        s[0] = (led_segment_t){fx->level, false, fx->on_ms};
+        s[1] = (led_segment_t){fx->low, false, fx->off_ms};
+        ch->seg_count = 2;
+        break;
+    case LED_FX_PULSE:
+        s[0] = (led_segment_t){fx->level, false, fx->on_ms};
+        s[1] = (led_segment_t){fx->low, true, fx->fade_ms};
+        s[2] = (led_segment_t){fx->low, false, fx->off_ms};
+        ch->seg_count = 3;
+        break;
+    case LED_FX_BREATHE:
+        s[0] = (led_segment_t){fx->level, true, fx->fade_ms};
+        s[1] = (led_segment_t){fx->low, true, fx->fade_ms};
+        ch->seg_count = 2;
+        break;
+    case LED_FX_OFF:
+    default:
+        s[0] = (led_segment_t){0, false, 0};
+        ch->seg_count = 1;
+        break;
+    }
+
+    cycle_ms = 0;
+    for (int i = 0; i < ch->seg_count; i++)
+        cycle_ms += s[i].ms;
+
+    // Stehende Effekte und Zyklen ohne Dauer nicht endlos wiederholen
+    ch->hold = fx->kind == LED_FX_OFF || fx->kind == LED_FX_ON || fx->kind == LED_FX_FADE ||
+               (cycle_ms == 0 && fx->count == 0);
+    ch->count = ch->hold ? 1 : fx->count;
+    ch->cycles = 0;
+    ch->seg_idx = 0;
+    ch->piece = 0;
+    ch->pieces = 0;
+
+    // Eine laufende Hardware-Rampe erst zu Ende fahren lassen
+    ch->deadline_us = now > ch->fade_end_us ? now : ch->fade_end_us;
+}
+
+/* Höchste belegte Ebene starten, oder ausschalten */
+static void led_select(led_channel_t *ch, int64_t now)
+{
+    for (int p = LED_PRIO_COUNT - 1; p >= 0; p--)
+    {
+        if (ch->layer_active[p])
+        {
+            ch->owner = p;
+            led_start(ch, &ch->layers[p], now);
+            return;
+        }
+    }
+
+    ch->owner = -1;
+    led_start(ch, &led_fx_off, now);
+}
+
+/*
+ * Einen Schritt ausführen, der bei ch->deadline_us fällig ist. Deadlines
+ * bauen aufeinander auf, damit sich Verspätungen nicht aufsummieren.
+ */
+static void led_advance(led_channel_t *ch)
+{
+    for (;;)
+    {
+        int64_t now = ch->deadline_us;
+        const led_segment_t *seg;
+
+        // Innerhalb einer Rampe: nächstes Stück auf der Gamma-Kurve
+        if (ch->piece < ch->pieces)
+        {
+            seg = &ch->seg[ch->seg_idx - 1];
+            uint32_t start_ms = (uint32_t)seg->ms * ch->piece / ch->pieces;
+            uint32_t end_ms = (uint32_t)seg->ms * (ch->piece + 1) / ch->pieces;
+            int32_t span = (int32_t)seg->to - ch->ramp_from;
+
+            ch->piece++;
+            led_output(ch, (uint8_t)(ch->ramp_from + span * ch->piece / ch->pieces), end_ms - start_ms, now);
+            ch->deadline_us = ch->seg_start_us + (int64_t)end_ms * 1000;
+            return;
+        }
+
+        if (ch->seg_idx >= ch->seg_count)
+        {
+            ch->cycles++;
+            if (ch->hold)
+            {
+                ch->deadline_us = 0;
+                return;
+            }
+            if (ch->count != 0 && ch->cycles >= ch->count)
+            {
+                // Endlicher Effekt fertig: Ebene freigeben
+                if (ch->owner >= 0)
+                    ch->layer_active[ch->owner] = false;
+                led_select(ch, now);
+                if (led_notify)
+                    led_notify();
+                continue;
+            }
+            ch->seg_idx = 0;
+        }
+
+        seg = &ch->seg[ch->seg_idx++];
+
+        if (seg->ramp && seg->ms > 0 && seg->to != ch->cur)
+        {
+            uint16_t pieces = (seg->ms + LED_PIECE_MAX_MS - 1) / LED_PIECE_MAX_MS;
+            ch->pieces = pieces < LED_RAMP_PIECES_MIN ? LED_RAMP_PIECES_MIN : pieces;
+            ch->piece = 0;
+            ch->ramp_from = ch->cur;
+            ch->seg_start_us = now;
+            continue;
+        }
+
+        ch->pieces = 0;
+        if (seg->to != ch->cur)
+            led_output(ch, seg->to, 0, now);
+
+        if (seg->ms > 0)
+        {
+            ch->deadline_us = now + (int64_t)seg->ms * 1000;
+            return;
+        }
+    }
+}
+
+/* Fällige Schritte ausführen und den Timer auf die nächste Deadline setzen */
+static void led_run_locked(int64_t now)
+{
+    uint32_t t0 = prof_begin();
+    int64_t next = 0;
+
+    for (int i = 0; i < LED_COUNT; i++)
+    {
+        led_channel_t *ch = &leds[i];
+
+        while (ch->deadline_us != 0 && ch->deadline_us <= now)
+            led_advance(ch);
+
+        if (ch->deadline_us != 0 && (next == 0 || ch->deadline_us < next))
+            next = ch->deadline_us;
+    }
+
+    esp_timer_stop(led_timer);
+    if (next != 0)
+        esp_timer_start_once(led_timer, (uint64_t)(next > now ? next - now : 0));
+
+    prof_end(PROF_LED, t0); // unter led_lock: ein Schreiber zur Zeit
+}
+
+static void led_timer_cb(void *arg)
+{
+    (void)arg;
+
+    xSemaphoreTake(led_lock, portMAX_DELAY);
+    led_run_locked(esp_timer_get_time());
+    xSemaphoreGive(led_lock);
+}
+
+/* ===================== API ===================== */
+
+void led_init(void)
+{
+    const esp_timer_create_args_t args = {
+        .callback = led_timer_cb,
+        .name = "led",
+    };
+
+    for (int b = 0; b < 256; b++)
+        gamma_duty[b] = (uint16_t)(LED_DUTY_MAX * powf(b / 255.0f, LED_GAMMA) + 0.5f);
+
+    hw_fade = ledc_fade_func_install(0) == ESP_OK;
+    if (!hw_fade)
+        ESP_LOGW(TAG, "no fade hardware, stepping ramps in software");
+
+    led_lock = xSemaphoreCreateMutex();
+    esp_timer_create(&args, &led_timer);
+
+    for (int i = 0; i < LED_COUNT; i++)
+    {
+        memset(leds[i].layer_active, 0, sizeof(leds[i].layer_active));
+        leds[i].owner = -1;
+        leds[i].deadline_us = 0;
+        leds[i].fade_end_us = 0;
+    }
+}
+
+void led_play(led_id_t led, led_prio_t prio, const led_fx_t *fx)
+{
+    led_channel_t *ch = &leds[led];
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(led_lock, portMAX_DELAY);
+
+    ch->layers[prio] = *fx;
+    ch->layer_active[prio] = true;
+
+    if ((int)prio >= ch->owner)
+    {
+        ch->owner = prio;
+        led_start(ch, &ch->layers[prio], now);
+        led_run_locked(now);
+    }
+
+    xSemaphoreGive(led_lock);
+}
+
+void led_release(led_id_t led, led_prio_t prio)
+{
+    led_channel_t *ch = &leds[led];
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(led_lock, portMAX_DELAY);
+
+    bool was_active = ch->layer_active[prio];
+    ch->layer_active[prio] = false;
+
+    if (was_active && ch->owner == (int)prio)
+    {
+        led_select(ch, now);
+        led_run_locked(now);
+    }
+
+    xSemaphoreGive(led_lock);
+}
+
+bool led_busy(led_id_t led, led_prio_t prio)
+{
+    return leds[led].layer_active[prio];
+}
+
+void led_set_notify(void (*cb)(void))
+{
+    led_notify = cb;
+}
+
+uint32_t led_writes(void)
+{
+    return writes;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "driver/ledc.h"
+
+/*
+ * LED-Effekt-Engine für die LEDC-Kanäle (Orb und P1/P2 RGB).
+ *
+ * Effekte bestehen aus Sprüngen und Rampen. Rampen laufen über die
+ * LEDC-Fade-Hardware in kurzen Stücken entlang einer Gamma-Tabelle, ein
+ * esp_timer stößt nur die Stückgrenzen an. Ohne Fade-Hardware werden die
+ * Stücke direkt als Duty gesetzt.
+ *
+ * Pro Kanal gibt es eine Ebene je Priorität. Es läuft immer die höchste
+ * belegte Ebene; endet oder verschwindet sie, übernimmt die nächstniedrigere
+ * wieder von vorn. So kämpfen Idle-Atmen, Mode-Blinken und Tasten-Blitze
+ * nicht mehr um denselben Kanal.
+ */
+
+/*
+ * LED-Kanäle liegen in der Low-Speed-Gruppe: nur dort kann der LEDC-Timer
+ * mit RTC8M laufen und im Light Sleep weiter-PWMen (siehe power.h).
+ */
+#define LED_LEDC_MODE LEDC_LOW_SPEED_MODE
+
+typedef enum
+{
+    LED_ORB = 0,
+    LED_P1_R,
+    LED_P1_G,
+    LED_P1_B,
+    LED_P2_R,
+    LED_P2_B, // P2 grün (Kanal 5) ist nicht bestückt
+    LED_COUNT
+} led_id_t;
+
+typedef enum
+{
+    LED_PRIO_BASE = 0, // Grundzustand des Modes, z.B. Atmen im Idle
+    LED_PRIO_MODE,     // Mode-Wechsel-Blinken
+    LED_PRIO_EVENT,    // Tasten, Quiz-Gewinner
+    LED_PRIO_COUNT
+} led_prio_t;
+
+typedef enum
+{
+    LED_FX_OFF = 0, // aus, bleibt stehen
+    LED_FX_ON,      // @level, bleibt stehen
+    LED_FX_FADE,    // in @fade_ms auf @level, bleibt stehen
+    LED_FX_BLINK,   // @on_ms @level, @off_ms @low, @count mal
+    LED_FX_PULSE,   // @on_ms @level, in @fade_ms auf @low, @off_ms halten, @count mal
+    LED_FX_BREATHE, // in @fade_ms auf @level und zurück auf @low, @count mal
+} led_fx_kind_t;
+
+/* Helligkeiten 0..255, linear empfunden (Gamma wird intern korrigiert) */
+typedef struct
+{
+    led_fx_kind_t kind;
+    uint8_t level;
+    uint8_t low;
+    uint16_t on_ms;
+    uint16_t off_ms;
+    uint16_t fade_ms;
+    uint16_t count; // 0 = endlos (BLINK/PULSE/BREATHE)
+} led_fx_t;
+
+/* Nach ledc_channel_config() aller LED-Kanäle aufrufen */
+void led_init(void);
+
+/**
+ * led_play - Effekt auf einer Ebene setzen
+ * @led: Kanal
+ * @prio: Ebene; ersetzt einen Effekt gleicher Priorität
+ * @fx: Effekt, wird kopiert
+ *
+ * Läuft sofort an, wenn keine höhere Ebene belegt ist. Eine laufende
+ * Hardware-Rampe wird noch zu Ende gefahren (höchstens LED_PIECE_MAX_MS).
+ */
+void led_play(led_id_t led, led_prio_t prio, const led_fx_t *fx);
+
+/* Ebene freigeben, die nächstniedrigere übernimmt */
+void led_release(led_id_t led, led_prio_t prio);
+
+/* Ob auf der Ebene noch ein Effekt liegt (endliche Effekte geben sie selbst frei) */
+bool led_busy(led_id_t led, led_prio_t prio);
+
+/**
+ * led_set_notify - Rückruf, wenn ein endlicher Effekt seine Ebene freigibt
+ *
+ * Läuft im esp_timer-Task, z.B. um die Hauptschleife zu wecken.
+ */
+void led_set_notify(void (*cb)(void));
+
+/* Anzahl der LEDC-Zugriffe seit dem Start, als Maß für die CPU-Last */
+uint32_t led_writes(void);
@@ -0,0 +1,150 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "driver/uart.h"
+#include "hal/uart_ll.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#include "midi_in.h"
+#include "input.h"
+#include "power.h"
+#include "spsc.h"
+
+static const char *TAG = "MIDI_IN";
+
+#define MIDI_IN_INTR_MASK (UART_INTR_RXFIFO_FULL | UART_INTR_RXFIFO_TOUT | \
+                           UART_INTR_RXFIFO_OVF | UART_INTR_FRAM_ERR | UART_INTR_PARITY_ERR)
+
+// ISR -> UI-Task
+static midi_msg_t msg_buf[MIDI_IN_QUEUE_LEN];
+static spsc_t msgs;
+
+// Nur die ISR greift zu, solange der Empfang läuft
+static midi_parser_t parser;
+static midi_in_stats_t stats;
+
+static bool enabled = false;
+
+static void IRAM_ATTR midi_in_isr(void *arg)
+{
+    uart_dev_t *hw = UART_LL_GET_HW(MIDI_IN_UART);
+    uint32_t status = uart_ll_get_intsts_mask(hw);
+    bool wake = false;
+    uint32_t len;
+
+    (void)arg;
+
+    while ((len = uart_ll_get_rxfifo_len(hw)) > 0)
+    {
+        uint8_t buf[16];
+        if (len > sizeof(buf))
+            len = sizeof(buf);
+
+        uart_ll_read_rxfifo(hw, buf, len);
+        stats.bytes += len;
+
+        int64_t now = esp_timer_get_time();
+        for (uint32_t i = 0; i < len; i++)
+        {
+            midi_msg_t msg;
+            if (!midi_parse(&parser, buf[i], &msg))
+                continue;
+
+            msg.time_us = now;
+            if (spsc_push(&msgs, &msg))
+            {
+                stats.messages++;
+                wake = true;
+            }
+            else
+            {
+                stats.dropped++;
+            }
+        }
+    }
+
+    if (status & UART_INTR_RXFIFO_OVF)
+    {
+        stats.overflows++;
+        uart_ll_rxfifo_rst(hw);
+        midi_parser_init(&parser); // Nachricht unvollständig
+    }
+    if (status & (UART_INTR_FRAM_ERR | UART_INTR_PARITY_ERR))
+        stats.errors++;
+
+    uart_ll_clr_intsts_mask(hw, status);
+
+    if (wake)
+        input_wake_from_isr();
+}
+
+void midi_in_init(gpio_num_t rx_pin)
+{
+    const uart_config_t cfg = {
+        .baud_rate = MIDI_IN_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_APB, // stabil, solange die Power-Sperre gehalten wird
+    };
+
+    // Jedes Byte sofort melden; Timeout nur als Rückfall
+    const uart_intr_config_t intr = {
+        .intr_enable_mask = 0,
+        .rxfifo_full_thresh = 1,
+        .rx_timeout_thresh = 2,
+    };
+
+    spsc_init(&msgs, msg_buf, sizeof(msg_buf[0]), MIDI_IN_QUEUE_LEN);
+    midi_parser_init(&parser);
+
+    uart_param_config(MIDI_IN_UART, &cfg);
+    uart_set_pin(MIDI_IN_UART, UART_PIN_NO_CHANGE, rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    uart_intr_config(MIDI_IN_UART, &intr);
+    uart_disable_intr_mask(MIDI_IN_UART, MIDI_IN_INTR_MASK);
+
+    esp_err_t err = uart_isr_register(MIDI_IN_UART, midi_in_isr, NULL, 0, NULL);
+    if (err != ESP_OK)
+        ESP_LOGW(TAG, "uart_isr_register failed: %s", esp_err_to_name(err));
+
+    ESP_LOGI(TAG, "UART%d RX on GPIO%d, %d baud", MIDI_IN_UART, rx_pin, MIDI_IN_BAUD);
+}
+
+void midi_in_enable(bool enable)
+{
+    midi_msg_t msg;
+
+    if (enable == enabled)
+        return;
+
+    enabled = enable;
+
+    if (enable)
+    {
+        power_acquire(POWER_LOCK_MIDI);
+        midi_parser_init(&parser);
+        uart_ll_rxfifo_rst(UART_LL_GET_HW(MIDI_IN_UART));
+        uart_clear_intr_status(MIDI_IN_UART, MIDI_IN_INTR_MASK);
+        uart_enable_intr_mask(MIDI_IN_UART, MIDI_IN_INTR_MASK);
+        return;
+    }
+
+    uart_disable_intr_mask(MIDI_IN_UART, MIDI_IN_INTR_MASK);
+    power_release(POWER_LOCK_MIDI);
+
+    while (spsc_pop(&msgs, &msg))
+        ;
+}
+
+bool midi_in_get(midi_msg_t *msg)
+{
+    return spsc_pop(&msgs, msg);
+}
+
+const midi_in_stats_t *midi_in_stats(void)
+{
+    return &stats;
+}
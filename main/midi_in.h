@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "driver/gpio.h"
+#include "driver/uart.h"
+
+#include "midi_parser.h"
+
+/*
+ * MIDI-In über UART2, nur RX (31250 Baud, 8N1).
+ *
+ * Ohne UART-Treiber und Event-Queue: eine eigene ISR liest das RX-FIFO bei
+ * jedem Byte (Schwelle 1), parst direkt (midi_parser.h) und legt fertige
+ * Nachrichten in eine lock-freie SPSC-Queue zum UI-Task, den sie sofort
+ * weckt. Note-On bis PlayTone() kostet so nur ISR + Task-Wechsel statt
+ * einer Loop-Periode.
+ *
+ * Der UART braucht den APB-Takt: solange MIDI-In aktiv ist, hält es eine
+ * Power-Sperre (kein Light Sleep). Deshalb nur im MIDI-Mode einschalten.
+ */
+
+#define MIDI_IN_UART UART_NUM_2
+#define MIDI_IN_BAUD 31250
+#define MIDI_IN_QUEUE_LEN 32
+
+typedef struct
+{
+    uint32_t bytes;     // empfangene Bytes
+    uint32_t messages;  // gemeldete Nachrichten
+    uint32_t dropped;   // Queue voll
+    uint32_t overflows; // RX-FIFO übergelaufen
+    uint32_t errors;    // Frame-/Paritätsfehler
+} midi_in_stats_t;
+
+/* UART konfigurieren und ISR installieren, Empfang bleibt noch aus */
+void midi_in_init(gpio_num_t rx_pin);
+
+/**
+ * midi_in_enable - Empfang ein- oder ausschalten (UI-Task)
+ *
+ * Beim Ausschalten werden noch wartende Nachrichten verworfen.
+ */
+void midi_in_enable(bool enable);
+
+/* Nächste Nachricht holen (UI-Task), false wenn keine wartet */
+bool midi_in_get(midi_msg_t *msg);
+
+const midi_in_stats_t *midi_in_stats(void);
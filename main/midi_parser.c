@@ -0,0 +1,97 @@
+#include "midi_parser.h"
+
+#define MIDI_CC_ALL_SOUND_OFF 120
+#define MIDI_CC_ALL_NOTES_OFF 123
+
+void midi_parser_init(midi_parser_t *p)
+{
+    p->status = 0;
+    p->count = 0;
+    p->need = 0;
+    p->sysex = false;
+}
+
+/* Datenbytes nach einem Statusbyte */
+static uint8_t midi_data_len(uint8_t status)
+{
+    switch (status & 0xf0)
+    {
+    case 0xc0: // Program Change
+    case 0xd0: // Channel Pressure
+        return 1;
+    case 0xf0:
+        return status == 0xf2 ? 2 : (status == 0xf1 || status == 0xf3) ? 1 : 0;
+    default:
+        return 2;
+    }
+}
+
+static bool midi_complete(const midi_parser_t *p, midi_msg_t *msg)
+{
+    uint8_t kind = p->status & 0xf0;
+
+    msg->channel = p->status & 0x0f;
+
+    switch (kind)
+    {
+    case 0x90:
+    case 0x80:
+        msg->type = kind == 0x90 && p->data[1] > 0 ? MIDI_MSG_NOTE_ON : MIDI_MSG_NOTE_OFF;
+        msg->note = p->data[0];
+        msg->velocity = p->data[1];
+        return true;
+
+    case 0xb0:
+        if (p->data[0] != MIDI_CC_ALL_SOUND_OFF && p->data[0] != MIDI_CC_ALL_NOTES_OFF)
+            return false;
+        msg->type = MIDI_MSG_ALL_OFF;
+        msg->note = 0;
+        msg->velocity = 0;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool midi_parse(midi_parser_t *p, uint8_t byte, midi_msg_t *msg)
+{
+    if (byte >= 0xf8)
+        return false; // Realtime (Clock, Active Sensing, ...): ändert nichts
+
+    if (byte & 0x80)
+    {
+        p->sysex = byte == 0xf0;
+        p->count = 0;
+
+        if (byte >= 0xf0)
+        {
+            // Sysex/System Common: kein Running Status danach, Daten überlesen
+            p->status = 0;
+            p->need = midi_data_len(byte);
+            return false;
+        }
+
+        p->status = byte;
+        p->need = midi_data_len(byte);
+        return false;
+    }
+
+    if (p->sysex)
+        return false;
+
+    if (!p->status)
+    {
+        // Daten von System Common oder ohne bekannten Status: verwerfen
+        if (p->need && ++p->count == p->need)
+            p->need = p->count = 0;
+        return false;
+    }
+
+    p->data[p->count++] = byte;
+    if (p->count < p->need)
+        return false;
+
+    p->count = 0; // Running Status: nächstes Datenbyte beginnt neue Nachricht
+    return midi_complete(p, msg);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Inkrementeller Parser für den MIDI-Bytestrom (31250 Baud, DIN-Buchse).
+ *
+ * Reine Logik ohne Hardwarezugriff: ein Aufruf pro empfangenem Byte, auf
+ * dem Target direkt in der UART-ISR, auf dem Host mit Byte-Strömen aus dem
+ * Simulator. Kein Puffer außer den zwei Datenbytes der laufenden Nachricht.
+ *
+ * Behandelt Running Status, Realtime-Bytes (0xF8..0xFF) mitten in einer
+ * Nachricht, Sysex und System-Common (beenden den Running Status) sowie
+ * Note-On mit Velocity 0 als Note-Off. Gemeldet werden nur Nachrichten,
+ * die für die Tonausgabe zählen.
+ */
+
+typedef enum
+{
+    MIDI_MSG_NOTE_ON,
+    MIDI_MSG_NOTE_OFF,
+    MIDI_MSG_ALL_OFF, // CC 120 (All Sound Off) oder CC 123 (All Notes Off)
+} midi_msg_type_t;
+
+typedef struct
+{
+    int64_t time_us; // Empfang des letzten Bytes, setzt der Aufrufer
+    midi_msg_type_t type;
+    uint8_t channel;
+    uint8_t note;
+    uint8_t velocity;
+} midi_msg_t;
+
+typedef struct
+{
+    uint8_t status;  // laufende Nachricht bzw. Running Status, 0 = keiner
+    uint8_t data[2];
+    uint8_t count;   // bisher empfangene Datenbytes
+    uint8_t need;    // Datenbytes der laufenden Nachricht
+    bool sysex;
+} midi_parser_t;
+
+void midi_parser_init(midi_parser_t *p);
+
+/**
+ * midi_parse - ein Byte verarbeiten
+ * @msg: Ausgabe, nur gültig wenn true zurückkommt
+ *
+ * Gibt true zurück, wenn mit diesem Byte eine relevante Nachricht
+ * vollständig ist. time_us bleibt unverändert.
+ */
+bool midi_parse(midi_parser_t *p, uint8_t byte, midi_msg_t *msg);
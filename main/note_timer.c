@@ -0,0 +1,47 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "note_timer.h"
+
+bool note_timer_calc(uint32_t freq_hz, note_timer_t *t)
+{
+    const uint64_t clk = (uint64_t)NOTE_TIMER_CLK_HZ << 8;
+    uint64_t best_num = 0;
+    uint64_t best_den = 0;
+    bool found = false;
+
+    if (freq_hz == 0 || freq_hz > UINT16_MAX)
+        return false;
+
+    for (uint32_t res = NOTE_TIMER_RES_MIN; res <= NOTE_TIMER_RES_MAX; res++)
+    {
+        uint64_t steps = (uint64_t)freq_hz << res;
+        uint64_t div = (clk + steps / 2) / steps;
+
+        if (div < NOTE_TIMER_DIV_MIN || div > NOTE_TIMER_DIV_MAX)
+            continue;
+
+        // Relativer Fehler |clk - div * steps| / (div * steps), über Kreuz verglichen
+        uint64_t den = div * steps;
+        uint64_t num = clk > den ? clk - den : den - clk;
+        if (!found || num * best_den < best_num * den)
+        {
+            t->div = (uint32_t)div;
+            t->res = (uint8_t)res;
+            best_num = num;
+            best_den = den;
+            found = true;
+        }
+    }
+
+    if (found)
+        t->hz = (uint16_t)(note_timer_millihz(t) / 1000);
+    return found;
+}
+
+uint32_t note_timer_millihz(const note_timer_t *t)
+{
+    uint64_t den = (uint64_t)t->div << t->res;
+
+    return (uint32_t)((((uint64_t)NOTE_TIMER_CLK_HZ << 8) * 1000 + den / 2) / den);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Teiler und Auflösung des Buzzer-Timers pro Ton.
+ *
+ * Ein High-Speed-Timer am APB-Takt läuft mit
+ *   f = NOTE_TIMER_CLK_HZ * 256 / (div * 2^res),
+ * div ist ein 10.8-Festkommateiler. Eine feste Auflösung verschenkt
+ * Genauigkeit und reicht mit 10 Bit nur bis ~76 Hz hinunter. Für jede
+ * MIDI-Note steht deshalb die Auflösung mit dem kleinsten Tonhöhenfehler in
+ * note_timers[], zur Build-Zeit von tools/notetable.py erzeugt (Grenzen
+ * hier müssen dazu passen). Ein Tonwechsel schreibt nur noch diese Werte,
+ * statt wie ledc_set_freq() den Teiler zur Laufzeit zu suchen.
+ *
+ * Die Duty zählt in Schritten von 2^-res: 50 % sind 2^(res-1). Unter
+ * NOTE_TIMER_RES_MIN würden Hüllkurven zu grob, über NOTE_TIMER_RES_MAX
+ * passt die Duty nicht mehr in die 16 Bit von envelope.h.
+ */
+
+#define NOTE_TIMER_NOTES 128
+#define NOTE_TIMER_CLK_HZ 80000000 // APB
+#define NOTE_TIMER_RES_MIN 10
+#define NOTE_TIMER_RES_MAX 15
+#define NOTE_TIMER_DIV_MIN 0x100   // 1.0
+#define NOTE_TIMER_DIV_MAX 0x3ffff // 1023.996
+
+typedef struct
+{
+    uint32_t div; // 10.8-Festkomma, für ledc_timer_set()
+    uint16_t hz;  // tatsächliche Frequenz, abgerundet: Perioden für Hüllkurven
+    uint8_t res;  // Duty-Auflösung in Bit
+} note_timer_t;
+
+/* Generiert: MIDI-Note (A4 = 69 = 440 Hz) -> Timer */
+extern const note_timer_t note_timers[NOTE_TIMER_NOTES];
+
+/**
+ * note_timer_calc - Timer für eine Frequenz, die keine Note ist
+ *
+ * Dieselbe Regel wie tools/notetable.py, aber zur Laufzeit: der Ton-
+ * wechsel kostet dann einige 64-Bit-Divisionen. Gibt false zurück, wenn
+ * kein Teiler passt.
+ */
+bool note_timer_calc(uint32_t freq_hz, note_timer_t *t);
+
+/* Tatsächliche Frequenz in mHz, für Berichte */
+uint32_t note_timer_millihz(const note_timer_t *t);
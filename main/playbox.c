@@ -1,471 +1,423 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include <math.h> // für sinf()
+#include <string.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 #include "driver/gpio.h"
 #include "driver/ledc.h"
-#include "driver/adc.h"
-#include "driver/dac.h"
 #include "esp_log.h"
-
-#include "songs.h"
-
-/* ===================== GPIO DEFINES ===================== */
-
-/* PWM / LED / Buzzer */
-#define OUT_LED_PIN GPIO_NUM_14
-#define IN_LED_PIN GPIO_NUM_27 // Steuerung / Taster
-#define BUZZER_PIN GPIO_NUM_12
-
-#define OUT_P1_R_PIN GPIO_NUM_21
-#define OUT_P1_G_PIN GPIO_NUM_1 // UART ungenutzt
-#define OUT_P1_B_PIN GPIO_NUM_3 // UART ungenutzt
-#define OUT_P2_R_PIN GPIO_NUM_4
-#define OUT_P2_G_PIN GPIO_NUM_17
-#define OUT_P2_B_PIN GPIO_NUM_16
-
-/* Joystick / Buttons P1 */
-#define IN_P1_TOP_PIN GPIO_NUM_22
-#define IN_P1_DOWN_PIN GPIO_NUM_19
-#define IN_P1_LEFT_PIN GPIO_NUM_23
-#define IN_P1_RIGHT_PIN GPIO_NUM_18
-#define IN_P1_FIRE_PIN GPIO_NUM_5
-
-/* Joystick / Buttons P2 */
-#define IN_P2_TOP_PIN GPIO_NUM_32
-#define IN_P2_DOWN_PIN GPIO_NUM_33
-#define IN_P2_LEFT_PIN GPIO_NUM_34
-#define IN_P2_RIGHT_PIN GPIO_NUM_35
-#define IN_P2_FIRE_PIN GPIO_NUM_13
-
-/* ADC Pins */
-#define ADC0_PIN GPIO_NUM_36
-#define ADC1_PIN GPIO_NUM_37
-#define ADC2_PIN GPIO_NUM_38
-#define ADC3_PIN GPIO_NUM_39
-
-/* DAC Pins */
-#define DAC1_PIN GPIO_NUM_25
-#define DAC2_PIN GPIO_NUM_26
+#include "esp_timer.h"
+
+#include "playbox.h"
+#include "sequencer.h"
+#include "songs_packed.h"
+#include "input.h"
+#include "quiz.h"
+#include "audio.h"
+#include "synth.h"
+#include "led.h"
+#include "power.h"
+#include "songlib.h"
+#include "midi_in.h"
+#include "analog.h"
+#include "profiler.h"
+#include "recorder.h"
+#include "chain.h"
+#include "dlog.h"
+#include "boot.h"
+#ifdef PLAYBOX_SYNTH_BENCH
+#include "synth_bench.h"
+#endif
 
 /* ===================== LEDC CONFIG ===================== */
 #define LED_PWM_FREQ_HZ 80
 #define LED_PWM_RES LEDC_TIMER_13_BIT
 
-#define BUZZER_PWM_FREQ_HZ 2000
-#define BUZZER_PWM_RES LEDC_TIMER_10_BIT
-#define BUZZER_LEDC_CHANNEL LEDC_CHANNEL_0
-#define BUZZER_LEDC_TIMER LEDC_TIMER_0
-
-#define MAX_TONE_SEQUENCE 16
-
-#define ORB_PWM_MAX 7000
-#define ORB_PWM_MIN 800
-#define ORB_FADE_STEP 20
-#define ORB_FADE_MS 20
+/* Helligkeiten 0..255 für led.c, Gamma-korrigiert */
+#define ORB_LEVEL_MAX 240 // ~ Duty 7000
+#define ORB_LEVEL_MIN 90  // ~ Duty 800
+#define ORB_BREATH_MS 1250 // halbe Atemperiode
 #define ORB_BLINK_MS 250
 #define ORB_BEEP_BLINK_MS 100
-
-// Globale Variable für den Sinuswinkel
-static float orb_breath_angle = 0.0f;
+#define ORB_QUIZ_FADE_MS 3500
 
 static bool quizmaster_triggered = false;
-static int last_p1_state = 1;
-static int last_p2_state = 1;
 
-/* ===================== MODES ===================== */
-typedef enum
-{
-    IDLE_MODE = 0,
-    BEEP_MODE,
-    MIDI_MODE,
-    QUIZMASTER_MODE,
-    TONLEITER_MODE,
-    MODE_COUNT
-} Mode;
+static quiz_arbiter_t quiz;
 
-volatile Mode currentMode = IDLE_MODE;
+/* ===================== SPIELER ===================== */
+#define PLAYER_BUTTONS 5
+#define PLAYER_NO_LED LED_COUNT // nur der Orb blitzt
 
-// Array mit Flags pro Mode, um Pieps/Sequenz nur einmal auszulösen
-static bool mode_done_flags[MODE_COUNT] = {0};
-
-
-/* ===================== BUZZER STATE ===================== */
-typedef struct
-{
-    int remaining_steps;
-    TickType_t last_tick;
-} buzzer_state_t;
-
-static buzzer_state_t buzzer = {0};
-
-/* ===================== BUZZER / TONE ===================== */
+/* Eingänge und LEDs eines Spielers */
 typedef struct
 {
-    int remaining_ticks;
-    TickType_t last_tick;
-    uint32_t frequency;
-} buzzer_tone_t;
-
-static buzzer_tone_t tone = {0};
-
-typedef struct
-{
-    tone_step_t steps[MAX_TONE_SEQUENCE];
-    int count;         // Anzahl der Töne in der Sequenz
-    int current_index; // aktuell gespielter Ton
-    bool active;       // ob Sequenz läuft
-} tone_sequence_t;
-
-static tone_sequence_t sequence = {0};
+    input_id_t buttons[PLAYER_BUTTONS]; // BeepMode-Notentaster, INPUT_NONE = fehlt
+    uint16_t beep_hz[PLAYER_BUTTONS];
+    input_id_t buzzer;                  // Quizmaster-Taster
+    uint16_t quiz_hz;                   // Antwortton
+    led_id_t quiz_led;                  // leuchtet für den Gewinner
+    led_id_t beep_led;                  // blitzt bei jedem Notentaster
+} player_t;
+
+/* Spieler an der Kette: ein Buzzer, Note und Antwortton gleich */
+#define CHAIN_PLAYER(n, hz)                                                             \
+    {                                                                                   \
+        .buttons = {INPUT_CHAIN(n), INPUT_NONE, INPUT_NONE, INPUT_NONE, INPUT_NONE},    \
+        .beep_hz = {hz}, .buzzer = INPUT_CHAIN(n), .quiz_hz = hz,                       \
+        .quiz_led = PLAYER_NO_LED, .beep_led = PLAYER_NO_LED,                           \
+    }
 
-typedef enum
-{
-    SONG_ODE = 0,
-    SONG_HAPPY,
-    SONG_HALLELUJAH,
-    SONG_ENTCHEN,
-    SONG_COUNT
-} midi_song_t;
+static const player_t player_table[QUIZ_MAX_PLAYERS] = {
+    {
+        .buttons = {IN_P1_TOP_PIN, IN_P1_DOWN_PIN, IN_P1_LEFT_PIN, IN_P1_RIGHT_PIN, IN_P1_FIRE_PIN},
+        .beep_hz = {262, 294, 330, 349, 392}, // C4, D4, E4, F4, G4
+        .buzzer = IN_P1_TOP_PIN, .quiz_hz = 523,
+        .quiz_led = LED_P1_R, .beep_led = LED_P1_B,
+    },
+    {
+        .buttons = {IN_P2_TOP_PIN, IN_P2_DOWN_PIN, IN_P2_LEFT_PIN, IN_P2_RIGHT_PIN, IN_P2_FIRE_PIN},
+        .beep_hz = {440, 494, 523, 587, 659}, // A4, B4, C5, D5, E5
+        .buzzer = IN_P2_TOP_PIN, .quiz_hz = 659,
+        .quiz_led = LED_P2_R, .beep_led = LED_P2_B,
+    },
+    CHAIN_PLAYER(0, 698),  // F5
+    CHAIN_PLAYER(1, 784),  // G5
+    CHAIN_PLAYER(2, 880),  // A5
+    CHAIN_PLAYER(3, 988),  // B5
+    CHAIN_PLAYER(4, 1047), // C6
+    CHAIN_PLAYER(5, 1175), // D6
+};
+
+_Static_assert(PLAYBOX_CHAIN_PLAYERS <= QUIZ_MAX_PLAYERS - 2, "chain players exceed quiz players");
+_Static_assert(2 * PLAYER_BUTTONS + PLAYBOX_CHAIN_PLAYERS <= REC_BUTTONS, "beep buttons exceed recorder");
+
+static int player_count = 2;
+
+/*
+ * Aus der Tabelle beim Start: Eingang -> Spieler bzw. Notentaster. Die
+ * Modi gehen nur die gesetzten Bits von pressed & Maske durch, der Aufwand
+ * hängt an den Drücken, nicht an der Zahl der Spieler.
+ */
+static int8_t player_of_input[INPUT_COUNT];
+static int8_t beep_of_input[INPUT_COUNT];
+static uint64_t quiz_mask = 0;
+static uint64_t beep_mask = 0;
 
-static midi_song_t currentSong = SONG_ODE;
+/* BeepMode: ein Ton pro Taster, Index wie in der Aufnahme (recorder.h) */
+static uint16_t beep_freqs[REC_BUTTONS];
+static led_id_t beep_leds[REC_BUTTONS];
+static int beep_count = 0;
 
-typedef enum
+static void players_init(void)
 {
-    MIDI_WAIT, // Warten auf Button-Eingabe oder Liedstart
-    MIDI_PLAY, // Lied gerade abspielen
-    MIDI_NEXT, // Nächstes Lied
-    MIDI_PREV, // Vorheriges Lied
-} midi_state_t;
+    player_count = 2 + (chain_bits() > 0 ? PLAYBOX_CHAIN_PLAYERS : 0);
 
-/**
- * PlayTone - spielt einen Ton auf dem passiven Buzzer
- * @freq_hz: Frequenz in Hz
- * @duration_ms: Dauer in Millisekunden
- *
- * Non-blocking: Ton wird in buzzer_update() gestoppt
- */
-void PlayTone(uint32_t freq_hz, uint32_t duration_ms)
-{
-    // LEDC Timer auf gewünschte Frequenz setzen
-    ledc_set_freq(LEDC_LOW_SPEED_MODE, BUZZER_LEDC_TIMER, freq_hz);
-    ledc_set_duty(LEDC_LOW_SPEED_MODE, BUZZER_LEDC_CHANNEL, 128); // 50% Duty
-    ledc_update_duty(LEDC_LOW_SPEED_MODE, BUZZER_LEDC_CHANNEL);
+    memset(player_of_input, -1, sizeof(player_of_input));
+    memset(beep_of_input, -1, sizeof(beep_of_input));
+    quiz_mask = 0;
+    beep_mask = 0;
+    beep_count = 0;
+    quiz_arbiter_init(&quiz, QUIZ_TIE_WINDOW_US);
 
-    tone.remaining_ticks = pdMS_TO_TICKS(duration_ms);
-    tone.last_tick = xTaskGetTickCount();
-    tone.frequency = freq_hz;
-}
+    for (int p = 0; p < player_count; p++)
+    {
+        const player_t *pl = &player_table[p];
 
-/**
- * buzzer_update - muss regelmäßig aufgerufen werden, stoppt Ton wenn fertig
- */
-void buzzer_update(void)
-{
-    TickType_t now = xTaskGetTickCount();
+        player_of_input[pl->buzzer] = (int8_t)p;
+        quiz_mask |= 1ULL << pl->buzzer;
+        // Ketten-Stempel kommen aus dem Scan: ± eine halbe Periode (input.c)
+        if (pl->buzzer >= INPUT_GPIO_COUNT)
+            quiz_set_stamp_error(&quiz, p, INPUT_SCAN_US / 2);
 
-    if (tone.remaining_ticks > 0)
-    {
-        if (now - tone.last_tick >= 1)
+        for (int b = 0; b < PLAYER_BUTTONS && pl->buttons[b] != INPUT_NONE; b++)
         {
-            tone.remaining_ticks--;
-            tone.last_tick = now;
-
-            if (tone.remaining_ticks <= 0)
-            {
-                // Ton beenden
-                ledc_set_duty(LEDC_LOW_SPEED_MODE, BUZZER_LEDC_CHANNEL, 0);
-                ledc_update_duty(LEDC_LOW_SPEED_MODE, BUZZER_LEDC_CHANNEL);
-            }
+            beep_of_input[pl->buttons[b]] = (int8_t)beep_count;
+            beep_mask |= 1ULL << pl->buttons[b];
+            beep_freqs[beep_count] = pl->beep_hz[b];
+            beep_leds[beep_count] = pl->beep_led;
+            beep_count++;
         }
     }
+
+    ESP_LOGI("APP", "%d players, %d note buttons", player_count, beep_count);
 }
 
-void PlayToneSequence(const tone_step_t *steps, int count)
+int playbox_players(void)
 {
-    if (count > MAX_TONE_SEQUENCE)
-        count = MAX_TONE_SEQUENCE;
+    return player_count;
+}
 
-    for (int i = 0; i < count; i++)
-    {
-        sequence.steps[i] = steps[i];
-    }
+// Flanken des aktuellen Schleifendurchlaufs (aus der ISR-Queue)
+static input_frame_t input_frame;
 
-    sequence.count = count;
-    sequence.current_index = 0;
-    sequence.active = true;
+/* ===================== MODES ===================== */
+// Gehört dem UI-Task, andere Tasks bekommen nur Kommandos
+static Mode currentMode = IDLE_MODE;
 
-    // ersten Ton sofort starten
-    if (count > 0)
-    {
-        PlayTone(sequence.steps[0].freq_hz, sequence.steps[0].duration_ms);
-    }
-}
+// Array mit Flags pro Mode, um Pieps/Sequenz nur einmal auszulösen
+static bool mode_done_flags[MODE_COUNT] = {0};
 
-/* Muss im Loop oder Task regelmäßig aufgerufen werden */
-void ToneSequence_Update(void)
+// Eingebaute Lieder, falls die Liederbibliothek leer ist oder fehlt
+static const song_t *const builtin_songs[] = {
+    &ode_an_die_freude_song,
+    &melody_happy_birthday_song,
+    &melody_hallelujah_motif_song,
+    &alle_meine_entchen_song,
+};
+
+#define BUILTIN_SONG_COUNT (int)(sizeof(builtin_songs) / sizeof(builtin_songs[0]))
+
+static int currentSong = 0;
+
+typedef enum
 {
-    if (!sequence.active)
-        return;
+    MIDI_WAIT, // Warten auf Button-Eingabe oder Liedstart
+    MIDI_PLAY, // Lied gerade abspielen
+    MIDI_NEXT, // Nächstes Lied
+    MIDI_PREV, // Vorheriges Lied
+} midi_state_t;
 
-    // Wenn der aktuelle Ton vorbei ist, nächsten Ton starten
-    if (tone.remaining_ticks <= 0)
-    {
-        sequence.current_index++;
-        if (sequence.current_index < sequence.count)
-        {
-            PlayTone(sequence.steps[sequence.current_index].freq_hz,
-                     sequence.steps[sequence.current_index].duration_ms);
-        }
-        else
-        {
-            // Sequenz fertig
-            sequence.active = false;
-        }
-    }
+/* Lieder aus der Bibliothek im Flash, sonst die eingebauten */
+static int song_count(void)
+{
+    int n = songlib_count();
+    return n > 0 ? n : BUILTIN_SONG_COUNT;
 }
 
 void Play_current_song(void)
 {
-    switch (currentSong)
-    {
-    case SONG_ODE:
-        PlayToneSequence(
-            ode_an_die_freude,
-            ode_an_die_freude_len);
-        break;
-
-    case SONG_HAPPY:
-        PlayToneSequence(
-            melody_happy_birthday,
-            melody_happy_birthday_len);
-        break;
+    songlib_entry_t e;
 
-    case SONG_HALLELUJAH:
-        PlayToneSequence(
-            melody_hallelujah_motif,
-            melody_hallelujah_motif_len);
-        break;
-    case SONG_ENTCHEN:
-        PlayToneSequence(
-            alle_meine_entchen,
-            alle_meine_entchen_len);
-        break;
-
-    default:
-        break;
+    if (!songlib_get(currentSong, &e))
+    {
+        // Ohne Bibliothek oder bei einem ungültigen Eintrag: currentSong zählt
+        // dann evtl. über die Bibliothek und kann über die eingebauten hinaus
+        PlayToneSequence(SEQ_PRIO_MUSIC, builtin_songs[currentSong % BUILTIN_SONG_COUNT]);
+        return;
     }
-}
 
-void StopToneSequence(void)
-{
-    sequence.active = false;
-    tone.remaining_ticks = 0;
+    if (e.kind == SONGLIB_KIND_SMF)
+        PlayMidiFile(SEQ_PRIO_MUSIC, e.data, e.length);
+    else
+        PlayToneSequence(SEQ_PRIO_MUSIC, &(song_t){.data = e.data, .words = (uint16_t)(e.length / 2)});
 
-    ledc_set_duty(LEDC_LOW_SPEED_MODE, BUZZER_LEDC_CHANNEL, 0);
-    ledc_update_duty(LEDC_LOW_SPEED_MODE, BUZZER_LEDC_CHANNEL);
+    // Der Log-Satz trägt nur Integer: statt des Namens Art und Größe
+    DLOGI(DLOG_SONG, e.kind == SONGLIB_KIND_SMF ? "%d: SMF, %u bytes" : "%d: packed, %u bytes",
+          currentSong, (unsigned)e.length);
 }
 
 /* ===================== MIDI SONG MODE ===================== */
 void MidiSongMode(void)
 {
     // Song wechseln
-    currentSong = (currentSong + 1) % SONG_COUNT;
+    currentSong = (currentSong + 1) % song_count();
 
     // Log
-    ESP_LOGI("SONG", "Changed to %d", currentSong);
+    DLOGI(DLOG_SONG, "Changed to %d", currentSong);
 
     // Song abspielen
     Play_current_song();
 }
 
-/* ===================== ORB LED STATE ===================== */
-typedef struct
-{
-    int target_blinks;    // Anzahl der Blinks bei Mode-Effekt
-    int blinks_done;      // bisher erledigt
-    bool led_on;          // aktueller Zustand
-    TickType_t last_tick; // letztes Update
-    uint16_t duty;        // aktueller PWM Duty
-    int fade_dir;         // +1 = heller, -1 = dunkler
-} orb_state_t;
+/* ===================== MIDI LIVE (MIDI-In) ===================== */
+#define MIDI_LIVE_HOLD_MS 10000 // falls ein Note-Off verloren geht
 
-static orb_state_t orb = {0};
+static uint32_t midi_held[4];  // 128 Bit: gehaltene Noten
+static int midi_sounding = -1; // Note auf dem Buzzer, -1 = keine
 
-/* ===================== ORB LED ===================== */
-
-void orb_update(void)
+static int midi_top_note(void)
 {
-    TickType_t now = xTaskGetTickCount();
-
-    // === Smooth Breath Effekt im Idle ===
-    if (currentMode == IDLE_MODE)
+    for (int w = 3; w >= 0; w--)
     {
-        if (now - orb.last_tick >= pdMS_TO_TICKS(ORB_FADE_MS))
-        {
-            orb.last_tick = now;
+        if (midi_held[w])
+            return w * 32 + 31 - __builtin_clz(midi_held[w]);
+    }
+    return -1;
+}
 
-            float sin_val = (sinf(orb_breath_angle) + 1.0f) / 2.0f;
-            orb.duty = ORB_PWM_MIN + (uint16_t)(sin_val * (ORB_PWM_MAX - ORB_PWM_MIN));
+static void midi_live_buzzer(int note)
+{
+    if (note < 0)
+        StopToneSequence(SEQ_PRIO_MUSIC);
+    else
+        PlayTone(SEQ_PRIO_MUSIC, song_note_hz((uint8_t)note), MIDI_LIVE_HOLD_MS);
+    midi_sounding = note;
+}
 
-            ledc_set_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7, orb.duty);
-            ledc_update_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7);
+/* Alle live gehaltenen Noten beenden, z.B. beim Verlassen des MIDI-Mode */
+static void midi_live_reset(void)
+{
+    if (midi_top_note() >= 0)
+        synth_stop_all();
+    if (midi_sounding >= 0)
+        StopToneSequence(SEQ_PRIO_MUSIC);
 
-            orb_breath_angle += 0.05f;
-            if (orb_breath_angle > 2 * M_PI)
-                orb_breath_angle -= 2 * M_PI;
-        }
+    memset(midi_held, 0, sizeof(midi_held));
+    midi_sounding = -1;
+}
 
-        return; // kein weiterer Blinkcode
-    }
+/*
+ * Noten vom MIDI-In: der Buzzer spielt einstimmig die höchste gehaltene
+ * Note, der DAC-Synth alle. Die UART-ISR weckt den UI-Task direkt, das
+ * Note-On geht also ohne Umweg über die Loop-Periode an den Sequenzer.
+ */
+void MidiLiveInput(void)
+{
+    midi_msg_t msg;
 
-    // Andere Modes außer BEEP_MODE: Blinkverhalten
-    if (currentMode != BEEP_MODE)
+    while (midi_in_get(&msg))
     {
-        if (orb.blinks_done >= orb.target_blinks)
-            return;
+        uint32_t bit = 1u << (msg.note & 31);
 
-        if (now - orb.last_tick >= pdMS_TO_TICKS(ORB_BLINK_MS))
+        switch (msg.type)
         {
-            orb.last_tick = now;
-            orb.led_on = !orb.led_on;
-            ledc_set_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7, orb.led_on ? ORB_PWM_MAX : 0);
-            ledc_update_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7);
+        case MIDI_MSG_NOTE_ON:
+            // Live-Noten spielen in der Musik-Klasse: die erste ersetzt ein laufendes Lied
+            midi_held[msg.note >> 5] |= bit;
+            if (msg.note >= midi_sounding)
+                midi_live_buzzer(msg.note);
+            synth_note_on(msg.note + 1, song_note_hz(msg.note), MIDI_LIVE_HOLD_MS,
+                          SYNTH_WAVE_TRIANGLE, (uint8_t)(msg.velocity << 1));
+            break;
 
-            if (!orb.led_on)
-                orb.blinks_done++;
+        case MIDI_MSG_NOTE_OFF:
+            midi_held[msg.note >> 5] &= ~bit;
+            synth_note_off(msg.note + 1);
+            if (msg.note == midi_sounding)
+                midi_live_buzzer(midi_top_note());
+            break;
+
+        case MIDI_MSG_ALL_OFF:
+            midi_live_reset();
+            break;
         }
     }
 }
 
+/* ===================== ORB LED ===================== */
+
+static const led_fx_t orb_breathe = {
+    .kind = LED_FX_BREATHE, .level = ORB_LEVEL_MAX, .low = ORB_LEVEL_MIN, .fade_ms = ORB_BREATH_MS};
 
+static const led_fx_t orb_beep_flash = {
+    .kind = LED_FX_BLINK, .level = ORB_LEVEL_MAX, .on_ms = ORB_BEEP_BLINK_MS, .count = 1};
+
+static const led_fx_t orb_quiz_flash = {
+    .kind = LED_FX_PULSE, .level = ORB_LEVEL_MAX, .on_ms = ORB_BEEP_BLINK_MS,
+    .fade_ms = ORB_QUIZ_FADE_MS, .count = 1};
+
+/* Grundzustand und Blinken für den aktuellen Mode: Idle atmet, sonst aus */
+static void orb_mode_effect(void)
+{
+    led_fx_t blink = {.kind = LED_FX_BLINK, .level = ORB_LEVEL_MAX,
+                      .on_ms = ORB_BLINK_MS, .off_ms = ORB_BLINK_MS};
+
+    if (currentMode == IDLE_MODE)
+        led_play(LED_ORB, LED_PRIO_BASE, &orb_breathe);
+    else
+        led_play(LED_ORB, LED_PRIO_BASE, &(led_fx_t){.kind = LED_FX_OFF});
+
+    // Anzahl Blinks = Mode-Nummer
+    blink.count = (uint16_t)currentMode;
+    if (blink.count > 0)
+        led_play(LED_ORB, LED_PRIO_MODE, &blink);
+    else
+        led_release(LED_ORB, LED_PRIO_MODE);
+}
 
 // === Mode-Effekt Trigger anpassen ===
 void mode_effects_trigger(void)
 {
-    orb.blinks_done = 0;
-    orb.last_tick = xTaskGetTickCount();
-
     // Alle Mode-Flags zurücksetzen
     for (int i = 0; i < MODE_COUNT; i++)
         mode_done_flags[i] = false;
 
-    switch (currentMode)
-    {
-        case IDLE_MODE:        orb.target_blinks = 0; break;
-        case BEEP_MODE:        orb.target_blinks = 1; break;
-        case MIDI_MODE:        orb.target_blinks = 2; break;
-        case QUIZMASTER_MODE:  orb.target_blinks = 3; break;
-        case TONLEITER_MODE:   orb.target_blinks = 4; break;
-        default:               orb.target_blinks = 0; break;
-    }
+    // Blitze aus dem alten Mode nicht über das Mode-Blinken legen
+    for (int l = 0; l < LED_COUNT; l++)
+        led_release((led_id_t)l, LED_PRIO_EVENT);
+
+    orb_mode_effect();
 }
 
 /* ===================== MODI Implemenation ===================== */
 
-void BeepMode(void)
+/* Ein Notentaster, live oder aus der Aufnahme */
+static void beep_note(int i)
 {
-    // Array mit Pins für P1 und P2
-    const gpio_num_t pins[10] = {
-        IN_P1_TOP_PIN, IN_P1_DOWN_PIN, IN_P1_LEFT_PIN, IN_P1_RIGHT_PIN, IN_P1_FIRE_PIN,
-        IN_P2_TOP_PIN, IN_P2_DOWN_PIN, IN_P2_LEFT_PIN, IN_P2_RIGHT_PIN, IN_P2_FIRE_PIN
-    };
+    PlayTone(SEQ_PRIO_SFX, beep_freqs[i], 200); // Ton abspielen, wartet ggf. auf das Intro
 
-    // Frequenzen für jeden Button
-    const uint32_t freqs[10] = {
-        262, 294, 330, 349, 392,   // P1: C4, D4, E4, F4, G4
-        440, 494, 523, 587, 659    // P2: A4, B4, C5, D5, E5
-    };
+    // Zusätzlich auf dem DAC-Synth: gleichzeitige Tasten klingen als Akkord
+    synth_play(beep_freqs[i], 400, SYNTH_WAVE_TRIANGLE, 96);
 
-    static int last_state[10] = {1,1,1,1,1,1,1,1,1,1};
-    static TickType_t beep_orb_end_tick = 0;
+    // ORB und die blaue LED des Spielers kurz aufblitzen lassen
+    led_play(LED_ORB, LED_PRIO_EVENT, &orb_beep_flash);
+    if (beep_leds[i] != PLAYER_NO_LED)
+        led_play(beep_leds[i], LED_PRIO_EVENT, &orb_beep_flash);
+}
 
-    TickType_t now = xTaskGetTickCount();
+void BeepMode(const input_frame_t *in)
+{
+    uint64_t pressed = in->pressed & beep_mask;
 
-    for (int i = 0; i < 10; i++)
+    // Nur gedrückte Notentaster (Flanke aus der ISR bzw. dem Ketten-Scan)
+    while (pressed)
     {
-        int state = gpio_get_level(pins[i]);
-
-        // Edge Detect: Button gedrückt
-        if (state == 0 && last_state[i] == 1)
-        {
-            PlayTone(freqs[i], 200); // Ton abspielen
-
-            // ORB LED direkt einschalten
-            ledc_set_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7, ORB_PWM_MAX);
-            ledc_update_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7);
-
-            // Timer für LED ausschalten setzen
-            beep_orb_end_tick = now + pdMS_TO_TICKS(ORB_BEEP_BLINK_MS);
-        }
-
-        last_state[i] = state;
-    }
+        int id = __builtin_ctzll(pressed);
+        int i = beep_of_input[id];
 
-    // LED nach Ablauf ausschalten
-    if (beep_orb_end_tick != 0 && now >= beep_orb_end_tick)
-    {
-        ledc_set_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7, 0);
-        ledc_update_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7);
-        beep_orb_end_tick = 0;
+        beep_note(i);
+        // Erst nach dem Ton: die Aufnahme verzögert ihn nicht
+        rec_press((uint8_t)i, in->press_time_us[id]);
+        pressed &= pressed - 1;
     }
 }
 
-void QuizmasterMode(void)
+void QuizmasterMode(const input_frame_t *in)
 {
-    static TickType_t quiz_orb_end_tick = 0;
-    static uint16_t current_duty = 0;  // aktueller PWM-Wert
-    TickType_t now = xTaskGetTickCount();
-
-    int p1_state = gpio_get_level(IN_P1_TOP_PIN);
-    int p2_state = gpio_get_level(IN_P2_TOP_PIN);
+    int leader = quiz_winner(&quiz);
+    int runner_up = quiz.runner_up;
 
-    // --- Edge Detect Player 1 ---
-    if (p1_state == 0 && last_p1_state == 1 && !quizmaster_triggered)
+    // Alle Drücke dieses Durchlaufs mit Zeitstempel einreichen, der
+    // früheste gewinnt unabhängig von der Reihenfolge hier
+    uint64_t pressed = in->pressed & quiz_mask;
+    while (pressed)
     {
-        PlayTone(523, 300);
-        quizmaster_triggered = true;
-        current_duty = ORB_PWM_MAX;
-        ledc_set_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7, current_duty);
-        ledc_update_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7);
-        quiz_orb_end_tick = now + pdMS_TO_TICKS(ORB_BEEP_BLINK_MS);
+        int id = __builtin_ctzll(pressed);
+        quiz_submit(&quiz, player_of_input[id], in->press_time_us[id]);
+        pressed &= pressed - 1;
     }
 
-    // --- Edge Detect Player 2 ---
-    if (p2_state == 0 && last_p2_state == 1 && !quizmaster_triggered)
+    // Nur die LEDs des alten und des neuen Führenden anfassen
+    int winner = quiz_winner(&quiz);
+    if (winner != leader)
     {
-        PlayTone(659, 300);
+        PlayTone(SEQ_PRIO_SFX, player_table[winner].quiz_hz, 300);
         quizmaster_triggered = true;
-        current_duty = ORB_PWM_MAX;
-        ledc_set_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7, current_duty);
-        ledc_update_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7);
-        quiz_orb_end_tick = now + pdMS_TO_TICKS(ORB_BEEP_BLINK_MS);
+        led_play(LED_ORB, LED_PRIO_EVENT, &orb_quiz_flash);
+        if (leader != QUIZ_NO_PLAYER && player_table[leader].quiz_led != PLAYER_NO_LED)
+            led_release(player_table[leader].quiz_led, LED_PRIO_EVENT);
+        if (player_table[winner].quiz_led != PLAYER_NO_LED)
+            led_play(player_table[winner].quiz_led, LED_PRIO_EVENT, &orb_quiz_flash);
     }
 
-    // --- LED sanft ausfaden ---
-    if (quiz_orb_end_tick != 0 && now >= quiz_orb_end_tick)
+    // Abstand zum Zweiten erst nach dem Ton loggen
+    if (quiz.runner_up != runner_up && quiz.runner_up != QUIZ_NO_PLAYER)
     {
-        if (current_duty > ORB_FADE_STEP)
-            current_duty -= ORB_FADE_STEP;
-        else
-            current_duty = 0;
-
-        ledc_set_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7, current_duty);
-        ledc_update_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_7);
-
-        if (current_duty == 0)
-        {
-            quiz_orb_end_tick = 0;
-            quizmaster_triggered = false; // Reset für nächste Frage
-        }
+        DLOGI(DLOG_QUIZ, quiz.tie ? "P%d first, P%d +%d us +-%d (TIE)" : "P%d first, P%d +%d us +-%d",
+              winner + 1, quiz.runner_up + 1, (int)quiz.stats.last_margin_us,
+              (int)quiz.stats.last_margin_err_us);
     }
 
-    last_p1_state = p1_state;
-    last_p2_state = p2_state;
+    // Orb ist ausgefadet (led.c gibt die Ebene frei): nächste Frage
+    if (quizmaster_triggered && !led_busy(LED_ORB, LED_PRIO_EVENT))
+    {
+        quizmaster_triggered = false;
+        quiz_arbiter_reset(&quiz);
+    }
 }
 
 
@@ -475,142 +427,159 @@ void QuizmasterMode(void)
 
 /* ===================== MODI HANDLER ===================== */
 
-void HandleIdleMode(void)
+void HandleIdleMode(const input_frame_t *in)
 {
-    static bool initialized = false;
-
-    if (!initialized)
+    // Atmen läuft komplett in led.c; P1 oben spielt die letzte BeepMode-Session
+    if (input_pressed(in, IN_P1_TOP_PIN))
     {
-        orb.fade_dir = 1;
-        orb.duty = ORB_PWM_MIN;
-        orb.last_tick = xTaskGetTickCount();
-        orb.target_blinks = 0;
-        orb.blinks_done = 0;
-        initialized = true;
+        if (rec_playing())
+            rec_play_stop();
+        else if (rec_play_start(esp_timer_get_time()))
+        {
+            playbox_hw_need(PLAYBOX_HW_RGB | PLAYBOX_HW_AUDIO); // Töne und Blitze wie im BeepMode
+            DLOGI(DLOG_REC, "replay %u presses", (unsigned)rec_stats()->events);
+        }
     }
 
-    if (currentMode != IDLE_MODE)
-        initialized = false;
+    // Aufnahmen mit Ketten-Spielern: ohne Kette fehlen deren Töne
+    int i;
+    while ((i = rec_play_due(esp_timer_get_time())) >= 0)
+    {
+        if (i < beep_count)
+            beep_note(i);
+    }
 }
 
-void HandleBeepMode(void)
+void HandleBeepMode(const input_frame_t *in)
 {
     if (!mode_done_flags[BEEP_MODE])
     {
-        PlayToneSequence(beep_mode_tones, beep_mode_len);
-        orb.target_blinks = 1;
-        orb.blinks_done = 0;
+        PlayToneSequence(SEQ_PRIO_CHIME, &beep_mode_tones_song);
         mode_done_flags[BEEP_MODE] = true;
     }
 
-    BeepMode();
+    BeepMode(in);
 }
 
-void HandleMidiMode(void)
+void HandleMidiMode(const input_frame_t *in)
 {
-    static int last_left_state = 1;
-    static int last_right_state = 1;
-
-    if (currentMode != MIDI_MODE)
-    {
-        last_left_state = 1;
-        last_right_state = 1;
-        StopToneSequence();
-        orb.blinks_done = 0;
-        orb.target_blinks = 0;
-        return;
-    }
-
     if (!mode_done_flags[MIDI_MODE])
     {
-        PlayToneSequence(midi_mode_tones, midi_mode_len);
-        orb.target_blinks = 2;
-        orb.blinks_done = 0;
+        PlayToneSequence(SEQ_PRIO_CHIME, &midi_mode_tones_song);
         mode_done_flags[MIDI_MODE] = true;
     }
 
-    int left_state = gpio_get_level(IN_P1_LEFT_PIN);
-    int right_state = gpio_get_level(IN_P1_RIGHT_PIN);
-
-    if (left_state == 0 && last_left_state == 1)
+    // Ersetzt das laufende Lied; während des Intros beginnt es direkt danach
+    if (input_pressed(in, IN_P1_LEFT_PIN))
     {
-        StopToneSequence();
-        currentSong = (currentSong - 1 + SONG_COUNT) % SONG_COUNT;
+        currentSong = (currentSong - 1 + song_count()) % song_count();
         Play_current_song();
     }
 
-    if (right_state == 0 && last_right_state == 1)
+    if (input_pressed(in, IN_P1_RIGHT_PIN))
     {
-        StopToneSequence();
-        currentSong = (currentSong + 1) % SONG_COUNT;
+        currentSong = (currentSong + 1) % song_count();
         Play_current_song();
     }
 
-    last_left_state = left_state;
-    last_right_state = right_state;
+    MidiLiveInput();
 }
 
-void HandleQuizmasterMode(void)
+void HandleQuizmasterMode(const input_frame_t *in)
 {
     if (!mode_done_flags[QUIZMASTER_MODE])
     {
-        PlayToneSequence(quizmaster_mode_tones, quizmaster_mode_len); // Intro
-        orb.target_blinks = 3;
-        orb.blinks_done = 0;
+        PlayToneSequence(SEQ_PRIO_CHIME, &quizmaster_mode_tones_song); // Intro
         mode_done_flags[QUIZMASTER_MODE] = true;
 
         quizmaster_triggered = false; // Reset für neue Frage
-        last_p1_state = 1;
-        last_p2_state = 1;
+        quiz_arbiter_reset(&quiz);
     }
 
-    QuizmasterMode();
+    QuizmasterMode(in);
+}
+
+const quiz_stats_t *Quizmaster_stats(void)
+{
+    return &quiz.stats;
 }
 
 void HandleTonleiterMode(void)
 {
     if (!mode_done_flags[TONLEITER_MODE])
     {
-        PlayToneSequence(tonleiter_mode_tones, tonleiter_mode_len);
-        orb.target_blinks = 4;
-        orb.blinks_done = 0;
+        PlayToneSequence(SEQ_PRIO_CHIME, &tonleiter_mode_tones_song);
         mode_done_flags[TONLEITER_MODE] = true;
     }
 }
 
 
 /* ===================== PIN INIT ===================== */
-void init_pins(void)
+/*
+ * In der Reihenfolge des Starts: erst der Buzzer für den Startsong, dann
+ * die Taster, dann der Orb. Die RGB-LEDs der Spieler, DAC und ADC kommen
+ * erst mit dem ersten Mode, der sie braucht (playbox_hw_need()).
+ */
+
+/* Buzzer PWM (HIGH SPEED), siehe sequencer.h */
+static void init_buzzer_pins(void)
+{
+    ledc_timer_config_t buzzer_timer = {
+        .speed_mode = BUZZER_LEDC_MODE,
+        .duty_resolution = BUZZER_PWM_RES,
+        .timer_num = BUZZER_LEDC_TIMER,
+        .freq_hz = BUZZER_PWM_FREQ_HZ,
+        .clk_cfg = LEDC_AUTO_CLK};
+    ledc_timer_config(&buzzer_timer);
+
+    ledc_channel_config_t ledc_channel = {
+        .gpio_num = BUZZER_PIN,
+        .speed_mode = BUZZER_LEDC_MODE,
+        .channel = BUZZER_LEDC_CHANNEL,
+        .timer_sel = BUZZER_LEDC_TIMER,
+        .intr_type = LEDC_INTR_DISABLE,
+        .duty = 0};
+    ledc_channel_config(&ledc_channel);
+}
+
+/* P1 + P2 Joysticks / Buttons + IN_LED_PIN, Flanken per ISR */
+static void init_input_pins(void)
 {
     gpio_config_t io_conf = {0};
 
-    /* ---------------- Inputs ---------------- */
-    // P1 + P2 Joysticks / Buttons + IN_LED_PIN
-    io_conf.pin_bit_mask = (1ULL << IN_P1_TOP_PIN) |
-                           (1ULL << IN_P1_DOWN_PIN) |
-                           (1ULL << IN_P1_LEFT_PIN) |
-                           (1ULL << IN_P1_RIGHT_PIN) |
-                           (1ULL << IN_P1_FIRE_PIN) |
-                           (1ULL << IN_P2_TOP_PIN) |
-                           (1ULL << IN_P2_DOWN_PIN) |
-                           (1ULL << IN_P2_LEFT_PIN) |
-                           (1ULL << IN_P2_RIGHT_PIN) |
-                           (1ULL << IN_P2_FIRE_PIN) |
-                           (1ULL << IN_LED_PIN);
+    const uint64_t input_mask = (1ULL << IN_P1_TOP_PIN) |
+                                (1ULL << IN_P1_DOWN_PIN) |
+                                (1ULL << IN_P1_LEFT_PIN) |
+                                (1ULL << IN_P1_RIGHT_PIN) |
+                                (1ULL << IN_P1_FIRE_PIN) |
+                                (1ULL << IN_P2_TOP_PIN) |
+                                (1ULL << IN_P2_DOWN_PIN) |
+                                (1ULL << IN_P2_LEFT_PIN) |
+                                (1ULL << IN_P2_RIGHT_PIN) |
+                                (1ULL << IN_P2_FIRE_PIN) |
+                                (1ULL << IN_LED_PIN);
+    io_conf.pin_bit_mask = input_mask;
     io_conf.mode = GPIO_MODE_INPUT;
     io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
     io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    io_conf.intr_type = GPIO_INTR_DISABLE;
+    io_conf.intr_type = GPIO_INTR_ANYEDGE;
     gpio_config(&io_conf);
 
-    /* ---------------- Outputs ---------------- */
+    input_init(input_mask);
+}
+
+/* LED-Ausgänge, Timer der LEDs und der Orb; die RGB-Kanäle folgen in init_rgb_pins() */
+static void init_led_pins(void)
+{
+    gpio_config_t io_conf = {0};
+
+    // Alle LED-Pins gleich als Ausgang auf low: die RGB-LEDs bleiben bis zu ihrem Kanal aus
     io_conf.pin_bit_mask = (1ULL << OUT_LED_PIN) |
-                           (1ULL << BUZZER_PIN) |
                            (1ULL << OUT_P1_R_PIN) |
                            //(1ULL << OUT_P1_G_PIN) |
                            //(1ULL << OUT_P1_B_PIN) |
                            (1ULL << OUT_P2_R_PIN) |
-                           (1ULL << OUT_P2_G_PIN) |
+                           //(1ULL << OUT_P2_G_PIN) | // SCLK der Kette
                            (1ULL << OUT_P2_B_PIN);
     io_conf.mode = GPIO_MODE_OUTPUT;
     io_conf.pull_up_en = GPIO_PULLUP_DISABLE;
@@ -618,21 +587,34 @@ void init_pins(void)
     io_conf.intr_type = GPIO_INTR_DISABLE;
     gpio_config(&io_conf);
 
-    /* ---------------- LEDC PWM ---------------- */
     // Timer für RGB LEDs
     ledc_timer_config_t ledc_timer = {
-        .speed_mode = LEDC_HIGH_SPEED_MODE,
+        .speed_mode = LED_LEDC_MODE,
         .duty_resolution = LED_PWM_RES,
         .timer_num = LEDC_TIMER_1,
         .freq_hz = LED_PWM_FREQ_HZ,
-        .clk_cfg = LEDC_AUTO_CLK};
+        .clk_cfg = LEDC_USE_RTC8M_CLK}; // läuft im Light Sleep weiter
     ledc_timer_config(&ledc_timer);
 
+    // OUT_LED / ORB LED
+    ledc_channel_config_t ledc_channel = {
+        .gpio_num = OUT_LED_PIN,
+        .speed_mode = LED_LEDC_MODE,
+        .channel = LEDC_CHANNEL_7,
+        .timer_sel = LEDC_TIMER_1,
+        .intr_type = LEDC_INTR_DISABLE,
+        .duty = 0};
+    ledc_channel_config(&ledc_channel);
+}
+
+/* RGB-LEDs der Spieler an LEDC_TIMER_1 */
+static void init_rgb_pins(void)
+{
     ledc_channel_config_t ledc_channel = {0};
 
     // P1 RGB
     ledc_channel.gpio_num = OUT_P1_R_PIN;
-    ledc_channel.speed_mode = LEDC_HIGH_SPEED_MODE;
+    ledc_channel.speed_mode = LED_LEDC_MODE;
     ledc_channel.channel = LEDC_CHANNEL_1;
     ledc_channel.timer_sel = LEDC_TIMER_1;
     ledc_channel.intr_type = LEDC_INTR_DISABLE;
@@ -659,107 +641,288 @@ void init_pins(void)
     ledc_channel.gpio_num = OUT_P2_B_PIN;
     ledc_channel.channel = LEDC_CHANNEL_6;
     ledc_channel_config(&ledc_channel);
+}
 
-    // OUT_LED / ORB LED
-    ledc_channel.gpio_num = OUT_LED_PIN;
-    ledc_channel.channel = LEDC_CHANNEL_7;
-    ledc_channel_config(&ledc_channel);
+/* ===================== LAZY INIT ===================== */
+/*
+ * Nach dem Reset zählt nur der Weg zum ersten Ton. Was erst ein Mode
+ * braucht, startet beim ersten Wechsel dorthin (bzw. mit der ersten
+ * Wiedergabe im Idle) und bleibt danach an: ein Mode-Druck kostet dann
+ * einmal die Treiber-Installation, der Wechsel-Chime spielt schon.
+ */
+static const uint8_t mode_hw[MODE_COUNT] = {
+    [IDLE_MODE] = 0,
+    [BEEP_MODE] = PLAYBOX_HW_RGB | PLAYBOX_HW_AUDIO | PLAYBOX_HW_ANALOG,
+    [MIDI_MODE] = PLAYBOX_HW_AUDIO | PLAYBOX_HW_ANALOG,
+    [QUIZMASTER_MODE] = PLAYBOX_HW_RGB | PLAYBOX_HW_ANALOG,
+    [TONLEITER_MODE] = PLAYBOX_HW_ANALOG,
+};
 
-    // Buzzer PWM (LOW SPEED)
-    ledc_timer_config_t buzzer_timer = {
-        .speed_mode = LEDC_LOW_SPEED_MODE,
-        .duty_resolution = BUZZER_PWM_RES,
-        .timer_num = BUZZER_LEDC_TIMER,
-        .freq_hz = BUZZER_PWM_FREQ_HZ,
-        .clk_cfg = LEDC_AUTO_CLK};
-    ledc_timer_config(&buzzer_timer);
+static uint32_t hw_ready = 0;
 
-    ledc_channel.gpio_num = BUZZER_PIN;
-    ledc_channel.speed_mode = LEDC_LOW_SPEED_MODE;
-    ledc_channel.channel = BUZZER_LEDC_CHANNEL;
-    ledc_channel.timer_sel = BUZZER_LEDC_TIMER;
-    ledc_channel.duty = 0;
-    ledc_channel_config(&ledc_channel);
+void playbox_hw_need(uint32_t hw)
+{
+    hw &= ~hw_ready;
+    if (!hw)
+        return;
+
+    // RGB-Kanäle mit Duty 0: led.c hat für sie bisher nur "aus" geschrieben
+    if (hw & PLAYBOX_HW_RGB)
+        init_rgb_pins();
+    // GPIO25/GPIO26 übernimmt der I2S-Treiber
+    if (hw & PLAYBOX_HW_AUDIO)
+        audio_init();
+    // ADC1_CHANNEL_0..3, Abtastung erst mit analog_enable()
+    if (hw & PLAYBOX_HW_ANALOG)
+        analog_init();
+
+    hw_ready |= hw;
+}
 
-    /* ---------------- ADC ---------------- */
-    adc1_config_width(ADC_WIDTH_BIT_12);
-    adc1_config_channel_atten(ADC1_CHANNEL_0, ADC_ATTEN_DB_11);
-    adc1_config_channel_atten(ADC1_CHANNEL_1, ADC_ATTEN_DB_11);
-    adc1_config_channel_atten(ADC1_CHANNEL_2, ADC_ATTEN_DB_11);
-    adc1_config_channel_atten(ADC1_CHANNEL_3, ADC_ATTEN_DB_11);
+#define APP_LOG_PERIOD_MS 1000
+#define APP_TASK_LOG_EVERY 10 // Task-Statistik bei jedem 10. Log
 
-    /* ---------------- DAC ---------------- */
-    dac_output_enable(DAC_CHANNEL_1); // GPIO25
-    dac_output_enable(DAC_CHANNEL_2); // GPIO26
+/* Profiler-Bericht: beide Feuertaster so lange halten. UART0-RX (GPIO3)
+ * treibt die P1-LED, eine Konsolen-Eingabe gibt es nicht. */
+#define APP_PROF_HOLD_MS 2000
+
+static TickType_t last_log_tick = 0;
+static uint32_t log_count = 0;
+static task_stats_t task_stats;
+
+static uint32_t stack_free(TaskHandle_t task)
+{
+    return task ? (uint32_t)uxTaskGetStackHighWaterMark(task) : 0;
 }
 
-void app_main(void)
+/* Verzögerung ISR -> UI-Task für alle Drücke dieses Durchlaufs */
+static void task_stats_input(const input_frame_t *in)
+{
+    int64_t now = esp_timer_get_time();
+    uint64_t pressed = in->pressed;
+
+    while (pressed)
+    {
+        int pin = __builtin_ctzll(pressed);
+        int64_t late = now - in->press_time_us[pin];
+
+        if (late > task_stats.ui_late_max_us)
+            task_stats.ui_late_max_us = late;
+        prof_input_edge(in->press_time_us[pin]);
+        pressed &= pressed - 1;
+    }
+}
+
+static uint64_t held_pins = 0;
+static int64_t prof_chord_us = 0; // seit dann halten beide Feuertaster, 0 = nicht
+
+/* Beide Feuertaster APP_PROF_HOLD_MS gehalten: einmal Profiler-Bericht */
+static void prof_chord(const input_frame_t *in)
 {
-    ESP_LOGI("APP", "BOOT");
+    const uint64_t chord = (1ULL << IN_P1_FIRE_PIN) | (1ULL << IN_P2_FIRE_PIN);
+    int64_t now = esp_timer_get_time();
+
+    held_pins = (held_pins | in->pressed) & ~in->released;
+
+    if ((held_pins & chord) != chord)
+    {
+        prof_chord_us = 0;
+        return;
+    }
 
-    init_pins();
+    if (prof_chord_us == 0)
+        prof_chord_us = now;
+    else if (prof_chord_us > 0 && now - prof_chord_us >= APP_PROF_HOLD_MS * 1000LL)
+    {
+        prof_dump();
+        prof_chord_us = -1; // erst nach dem Loslassen wieder
+    }
+}
+
+const task_stats_t *Playbox_task_stats(void)
+{
+    task_stats.ui_stack_free = (uint32_t)uxTaskGetStackHighWaterMark(NULL);
+    task_stats.seq_stack_free = stack_free(sequencer_task());
+    task_stats.audio_stack_free = stack_free(audio_task());
+    task_stats.analog_stack_free = stack_free(analog_task());
+    return &task_stats;
+}
+
+void playbox_init(void)
+{
+    boot_mark(BOOT_APP_START);
+
+    dlog_init(); // vor allem, was per DLOGx loggt
+    power_init();
+
+    /* ===== Startsong: Buzzer zuerst ===== */
+    init_buzzer_pins();
+    buzzer_init();
+    boot_mark(BOOT_BUZZER_READY);
+    PlayToneSequence(SEQ_PRIO_CHIME, &win95_true_boot_song);
+    boot_mark(BOOT_SONG_QUEUED);
+
+    // Ab hier läuft der Song auf Core 1; Logs und Treiber halten ihn nicht mehr auf
+    init_input_pins(); // Mode-Taster und Spieler
+    boot_mark(BOOT_INPUT_LIVE);
+    // SCLK, /PL und MISO übernimmt der SPI-Treiber; ohne Kette bleiben sie frei
+    chain_init(PLAYBOX_CHAIN_PLAYERS);
+    players_init(); // nach chain_init(): Ketten-Spieler nur, wenn sie da ist
+    init_led_pins();
+    led_init();
+    led_set_notify(input_wake); // z.B. Quiz-Blitz ausgefadet
+    orb_mode_effect(); // Idle: Orb atmet
+    songlib_init();
+    rec_init();
+    rec_set_notify(input_wake); // Wiedergabe: nächster Druck fällig
+#ifdef PLAYBOX_SYNTH_BENCH
+    synth_bench_run(); // vor dem Audio-Task, damit nichts mitläuft
+#endif
+    midi_in_init(IN_MIDI_RX_PIN);
+    prof_reset(); // Bericht ohne den Start
 
     ESP_LOGI("APP", "AFTER_INIT");
+    boot_mark(BOOT_INIT_DONE);
 
-    int last_switch = 1;
+    last_log_tick = xTaskGetTickCount();
+}
 
-    /* ===== Startsong ===== */
-    PlayToneSequence(
-        win95_true_boot,
-        win95_true_boot_len);
+void playbox_loop_once(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    uint32_t loop_t0 = prof_begin();
 
-    TickType_t last_log_tick = xTaskGetTickCount();
+    prof_loop_start(esp_timer_get_time());
 
-    while (true)
+    // Alle Flanken seit dem letzten Durchlauf abholen
+    uint32_t t0 = prof_begin();
+    input_collect(&input_frame);
+    prof_end(PROF_INPUT, t0);
+    task_stats_input(&input_frame);
+    prof_chord(&input_frame);
+
+    // Mode-Button Edge Detect
+    bool mode_changed = input_pressed(&input_frame, IN_LED_PIN);
+    if (mode_changed)
     {
-        TickType_t now = xTaskGetTickCount();
+        Mode previous = currentMode;
+        currentMode = (currentMode + 1) % MODE_COUNT;
+        mode_effects_trigger();   /* <-- FIX */
+
+        // BeepMode-Session ab dem Mode-Druck aufnehmen, beim Verlassen speichern
+        rec_play_stop();
+        if (currentMode == BEEP_MODE)
+            rec_start(input_frame.press_time_us[IN_LED_PIN]);
+        else if (previous == BEEP_MODE)
+            rec_stop();
+
+        // Lied und Tasten-Töne gehören dem alten Mode; ein Intro klingt aus
+        StopToneSequence(SEQ_PRIO_MUSIC);
+        StopToneSequence(SEQ_PRIO_SFX);
+
+        // UART nur im MIDI-Mode: hält solange den Light Sleep an
+        if (currentMode != MIDI_MODE)
+            midi_live_reset();
+        midi_in_enable(currentMode == MIDI_MODE);
+        // Kette nur, wo Spieler drücken: sonst hielte der 1-kHz-Scan die CPU wach
+        input_chain_enable(currentMode == BEEP_MODE || currentMode == QUIZMASTER_MODE);
+    }
 
-        // Mode-Button Edge Detect
-        int state = gpio_get_level(IN_LED_PIN);
-        if (state == 0 && last_switch == 1)
-        {
-            currentMode = (currentMode + 1) % MODE_COUNT;
-            ESP_LOGI("MODE", "Changed to %d", currentMode);
-            mode_effects_trigger();   /* <-- FIX */
-        }
+    // Handler einmalig aufrufen
+    t0 = prof_begin();
+    switch (currentMode)
+    {
+    case IDLE_MODE:
+        HandleIdleMode(&input_frame);
+        break;
+    case BEEP_MODE:
+        HandleBeepMode(&input_frame);
+        prof_end(PROF_MODE_BEEP, t0);
+        break;
+    case MIDI_MODE:
+        HandleMidiMode(&input_frame);
+        prof_end(PROF_MODE_MIDI, t0);
+        break;
+    case QUIZMASTER_MODE:
+        HandleQuizmasterMode(&input_frame);
+        prof_end(PROF_MODE_QUIZ, t0);
+        break;
+    case TONLEITER_MODE:
+        HandleTonleiterMode();
+        prof_end(PROF_MODE_TONLEITER, t0);
+        break;
+    default:
+        break;
+    }
 
-        last_switch = state; /* <-- FIX: immer updaten */
-        // Handler einmalig aufrufen
-        switch (currentMode)
-        {
-        case IDLE_MODE:
-            HandleIdleMode();
-            break;
-        case BEEP_MODE:
-            HandleBeepMode();
-            break;
-        case MIDI_MODE:
-            HandleMidiMode();
-            break;
-        case QUIZMASTER_MODE:
-            HandleQuizmasterMode();
-            break;
-        case TONLEITER_MODE:
-            HandleTonleiterMode();
-            break;
-        default:
-            break;
-        }
+    // ===== Runtime Updates zentral =====
+    // (Töne laufen über tone_timer, LED-Effekte über led.c, nicht über den Loop)
+
+    // Erst klingt das Intro des neuen Modes, dann kommt die Hardware, die er braucht:
+    // wie beim Start hält kein Treiber-Setup den Ton auf
+    if (mode_changed)
+    {
+        playbox_hw_need(mode_hw[currentMode]);
+        analog_enable(currentMode != IDLE_MODE); // Idle: keine Weckrufe durch die Abtastung
+        DLOGI(DLOG_MODE, "Changed to %d", currentMode);
+    }
 
-        //last_switch = state;
+    // ===== Optional: periodisches Loggen =====
+    if (now - last_log_tick >= pdMS_TO_TICKS(APP_LOG_PERIOD_MS))
+    {
+        DLOGI(DLOG_APP, "Running... Mode=%d Song=%d", currentMode, currentSong);
+        last_log_tick = now;
 
-        // ===== Runtime Updates zentral =====
-        buzzer_update();
-        ToneSequence_Update();
-        orb_update();
+        if (log_count == 0)
+            boot_report(); // einmal, wenn der Start längst durch ist
 
-        // ===== Optional: periodisches Loggen =====
-        if (now - last_log_tick >= pdMS_TO_TICKS(1000))
+        if (++log_count % APP_TASK_LOG_EVERY == 0)
         {
-            ESP_LOGI("APP", "Running... Mode=%d Song=%d", currentMode, currentSong);
-            last_log_tick = now;
+            const task_stats_t *ts = Playbox_task_stats();
+            const tone_timing_t *tt = Tone_timing_stats();
+            DLOGI(DLOG_TASKS, "stack free ui=%u seq=%u audio=%u analog=%u B",
+                  (unsigned)ts->ui_stack_free, (unsigned)ts->seq_stack_free,
+                  (unsigned)ts->audio_stack_free, (unsigned)ts->analog_stack_free);
+            DLOGI(DLOG_TASKS, "late max ui=%d seq=%d us", (int)ts->ui_late_max_us,
+                  (int)tt->max_abs_err_us);
         }
+    }
+
+    prof_end(PROF_LOOP, loop_t0);
+}
 
-        vTaskDelay(pdMS_TO_TICKS(10));
+Mode playbox_mode(void)
+{
+    return currentMode;
+}
+
+void playbox_wait(TickType_t max_wait)
+{
+    TickType_t elapsed = xTaskGetTickCount() - last_log_tick;
+    TickType_t period = pdMS_TO_TICKS(APP_LOG_PERIOD_MS);
+    TickType_t wait = elapsed < period ? period - elapsed : 0;
+
+    // Feuertaster-Griff läuft: pünktlich zum Bericht aufwachen
+    if (prof_chord_us > 0)
+    {
+        int64_t left_us = prof_chord_us + APP_PROF_HOLD_MS * 1000LL - esp_timer_get_time();
+        TickType_t left = left_us > 0 ? pdMS_TO_TICKS((left_us + 999) / 1000) + 1 : 0;
+        if (left < wait)
+            wait = left;
+    }
+
+    input_wait(wait < max_wait ? wait : max_wait);
+}
+
+void app_main(void)
+{
+    // Default WARN (sdkconfig) spart die IDF-Startmeldungen vor app_main, ab hier wieder INFO
+    esp_log_level_set("*", ESP_LOG_INFO);
+    playbox_init();
+
+    while (true)
+    {
+        playbox_loop_once();
+        playbox_wait(portMAX_DELAY);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+
+#include "songfmt.h"
+#include "sequencer.h"
+#include "quiz.h"
+
+/* ===================== GPIO DEFINES ===================== */
+
+/* PWM / LED / Buzzer */
+#define OUT_LED_PIN GPIO_NUM_14
+#define IN_LED_PIN GPIO_NUM_27 // Steuerung / Taster
+#define BUZZER_PIN GPIO_NUM_12
+
+#define OUT_P1_R_PIN GPIO_NUM_21
+#define OUT_P1_G_PIN GPIO_NUM_1 // UART ungenutzt
+#define OUT_P1_B_PIN GPIO_NUM_3 // UART ungenutzt
+#define OUT_P2_R_PIN GPIO_NUM_4
+#define OUT_P2_G_PIN GPIO_NUM_17
+#define OUT_P2_B_PIN GPIO_NUM_16
+
+/* Joystick / Buttons P1 */
+#define IN_P1_TOP_PIN GPIO_NUM_22
+#define IN_P1_DOWN_PIN GPIO_NUM_19
+#define IN_P1_LEFT_PIN GPIO_NUM_23
+#define IN_P1_RIGHT_PIN GPIO_NUM_18
+#define IN_P1_FIRE_PIN GPIO_NUM_5
+
+/* Joystick / Buttons P2 */
+#define IN_P2_TOP_PIN GPIO_NUM_32
+#define IN_P2_DOWN_PIN GPIO_NUM_33
+#define IN_P2_LEFT_PIN GPIO_NUM_34
+#define IN_P2_RIGHT_PIN GPIO_NUM_35
+#define IN_P2_FIRE_PIN GPIO_NUM_13
+
+/* Weitere Spieler: 74HC165-Kette an GPIO0/2/17, siehe chain.h */
+
+/* MIDI-In (UART2 RX über die GPIO-Matrix), Optokoppler-Ausgang idle high */
+#define IN_MIDI_RX_PIN GPIO_NUM_15 // GPIO1/3 (UART0) treiben die P1-LEDs
+
+/* ADC Pins */
+#define ADC0_PIN GPIO_NUM_36
+#define ADC1_PIN GPIO_NUM_37
+#define ADC2_PIN GPIO_NUM_38
+#define ADC3_PIN GPIO_NUM_39
+
+/* DAC Pins */
+#define DAC1_PIN GPIO_NUM_25
+#define DAC2_PIN GPIO_NUM_26
+
+/* ===================== MODES ===================== */
+typedef enum
+{
+    IDLE_MODE = 0,
+    BEEP_MODE,
+    MIDI_MODE,
+    QUIZMASTER_MODE,
+    TONLEITER_MODE,
+    MODE_COUNT
+} Mode;
+
+/* Aktueller Mode, nur für den UI-Task und den Host-Simulator */
+Mode playbox_mode(void);
+
+/* ===================== SPIELER ===================== */
+/*
+ * P1 und P2 an den GPIOs, dahinter PLAYBOX_CHAIN_PLAYERS Spieler mit je
+ * einem Buzzer an der Schieberegister-Kette (Eingang 0, 1, ...). Ohne
+ * erkannte Kette spielen nur P1 und P2.
+ */
+#ifndef PLAYBOX_CHAIN_PLAYERS
+#define PLAYBOX_CHAIN_PLAYERS 6 // überschreibbar per -D, höchstens QUIZ_MAX_PLAYERS - 2
+#endif
+
+/* Spieler dieser Sitzung, 2 + PLAYBOX_CHAIN_PLAYERS mit Kette */
+int playbox_players(void);
+
+/* ===================== QUIZMASTER ===================== */
+/* Gewinner, Gleichstände und gemessene Abstände aller Runden */
+const quiz_stats_t *Quizmaster_stats(void);
+
+/* ===================== TASKS ===================== */
+/*
+ * UI-Task (app_main, Core 0): Eingaben, Modi, LEDs.
+ * Sequenzer- und Audio-Task (Core 1): Buzzer und DAC, nur über Queues erreichbar.
+ * Analog-Task (Core 1): ADC-Abtastung, Werte per Momentaufnahme (analog.h).
+ */
+typedef struct
+{
+    uint32_t ui_stack_free; // kleinster freier Stack seit dem Start, Bytes
+    uint32_t seq_stack_free;
+    uint32_t audio_stack_free;
+    uint32_t analog_stack_free;
+    int64_t ui_late_max_us; // Taster-ISR bis Auswertung im UI-Task
+} task_stats_t;
+
+/* Aus dem UI-Task aufrufen (dessen Stack wird mit gemessen) */
+const task_stats_t *Playbox_task_stats(void);
+
+/* ===================== PERIPHERIE ===================== */
+/* Startet playbox_init() nicht, sondern der erste Mode, der sie braucht */
+#define PLAYBOX_HW_RGB (1u << 0)    // RGB-LEDs der Spieler (LEDC-Kanäle 1..6)
+#define PLAYBOX_HW_AUDIO (1u << 1)  // Synth und I2S-DAC, audio_init()
+#define PLAYBOX_HW_ANALOG (1u << 2) // ADC-Abtastung, analog_init()
+
+/**
+ * playbox_hw_need - Peripherie @hw starten, falls noch nicht geschehen
+ * @hw: PLAYBOX_HW_x, verodert
+ *
+ * Nur aus dem UI-Task (bzw. dem Simulator vor direkten Synth-Aufrufen).
+ */
+void playbox_hw_need(uint32_t hw);
+
+/* ===================== APP ===================== */
+/**
+ * playbox_init - Buzzer starten, Startsong anstoßen, dann den Rest
+ *
+ * Zeitstempel der Phasen siehe boot.h. Wird von app_main() einmalig
+ * aufgerufen, auf dem Host vom Simulator.
+ */
+void playbox_init(void);
+
+/**
+ * playbox_loop_once - ein Durchlauf der Hauptschleife (ohne Warten)
+ *
+ * Der Host-Simulator steuert damit die Schleife gegen die virtuelle Uhr.
+ */
+void playbox_loop_once(void);
+
+/**
+ * playbox_wait - bis zum nächsten Ereignis blockieren
+ * @max_wait: höchstens so viele Ticks warten (portMAX_DELAY: unbegrenzt)
+ *
+ * Weckt bei Tastenflanken, input_wake() (z.B. LED-Effekt fertig) und zum
+ * nächsten periodischen Log. Töne und LED-Rampen laufen über esp_timer und
+ * brauchen die Schleife nicht; dazwischen darf die CPU in den Light Sleep.
+ */
+void playbox_wait(TickType_t max_wait);
@@ -0,0 +1,76 @@
+#include <stddef.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "sdkconfig.h"
+
+#include "power.h"
+
+static const char *TAG = "POWER";
+
+/* Unterhalb von 80 MHz sinkt auch der APB-Takt, daher die Sperren für Audio */
+#define POWER_MIN_FREQ_MHZ 40
+
+static esp_pm_lock_handle_t locks[POWER_LOCK_COUNT];
+static bool held[POWER_LOCK_COUNT];
+
+static const char *const lock_names[POWER_LOCK_COUNT] = {
+    [POWER_LOCK_BUZZER] = "buzzer",
+    [POWER_LOCK_SYNTH] = "synth",
+    [POWER_LOCK_MIDI] = "midi",
+};
+
+void power_init(void)
+{
+#ifdef CONFIG_PM_ENABLE
+    esp_pm_config_esp32_t cfg = {
+        .max_freq_mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = POWER_MIN_FREQ_MHZ,
+        .light_sleep_enable = true,
+    };
+
+    esp_err_t err = esp_pm_configure(&cfg);
+    if (err != ESP_OK)
+        ESP_LOGW(TAG, "esp_pm_configure failed: %s", esp_err_to_name(err));
+
+    // LEDC-Low-Speed mit RTC8M soll im Light Sleep weiter-PWMen
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC8M, ESP_PD_OPTION_ON);
+#else
+    ESP_LOGW(TAG, "CONFIG_PM_ENABLE off, no light sleep");
+#endif
+
+    for (int i = 0; i < POWER_LOCK_COUNT; i++)
+    {
+        // Ohne CONFIG_PM_ENABLE liefert das ESP_ERR_NOT_SUPPORTED, die Sperre bleibt NULL
+        if (esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, lock_names[i], &locks[i]) != ESP_OK)
+            locks[i] = NULL;
+        held[i] = false;
+    }
+}
+
+void power_acquire(power_lock_t lock)
+{
+    if (held[lock])
+        return;
+
+    held[lock] = true;
+    if (locks[lock])
+        esp_pm_lock_acquire(locks[lock]);
+}
+
+void power_release(power_lock_t lock)
+{
+    if (!held[lock])
+        return;
+
+    held[lock] = false;
+    if (locks[lock])
+        esp_pm_lock_release(locks[lock]);
+}
+
+bool power_held(power_lock_t lock)
+{
+    return held[lock];
+}
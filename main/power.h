@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdbool.h>
+
+/*
+ * Energiesparen mit esp_pm: dynamische CPU-Frequenz und automatischer
+ * Light Sleep, sobald kein Task läuft und keine Sperre gehalten wird.
+ *
+ * Sperren gibt es nur für Peripherie am APB-Takt: Buzzer (LEDC-High-Speed),
+ * I2S-DAC und der MIDI-UART. LEDs laufen auf RTC8M weiter, Taster und
+ * esp_timer wecken die CPU.
+ */
+
+typedef enum
+{
+    POWER_LOCK_BUZZER = 0,
+    POWER_LOCK_SYNTH,
+    POWER_LOCK_MIDI,
+    POWER_LOCK_COUNT
+} power_lock_t;
+
+/* Vor allen Treibern, die Sperren brauchen, aufrufen */
+void power_init(void);
+
+/**
+ * power_acquire - Light Sleep und Frequenzabsenkung für @lock verhindern
+ *
+ * Mehrfaches Anfordern derselben Sperre zählt nicht mit; jede Sperre hat
+ * genau einen Besitzer (Sequenzer, Audio-Task bzw. UI-Task für MIDI-In).
+ */
+void power_acquire(power_lock_t lock);
+void power_release(power_lock_t lock);
+
+bool power_held(power_lock_t lock);
@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "esp_log.h"
+
+#include "profiler.h"
+#include "seqlock.h"
+
+static const char *TAG = "PROF";
+
+static const char *const section_names[PROF_SECTION_COUNT] = {
+    [PROF_LOOP] = "loop",
+    [PROF_INPUT] = "input",
+    [PROF_MODE_BEEP] = "mode_beep",
+    [PROF_MODE_MIDI] = "mode_midi",
+    [PROF_MODE_QUIZ] = "mode_quiz",
+    [PROF_MODE_TONLEITER] = "mode_tonleiter",
+    [PROF_SEQ_CMD] = "seq_cmd",
+    [PROF_SEQ_TICK] = "seq_tick",
+    [PROF_SEQ_NOTE] = "seq_note",
+    [PROF_LED] = "led",
+};
+
+/*
+ * Jeder Datensatz trägt die Generation, in der er begonnen wurde. Nach
+ * prof_reset() passt sie nicht mehr: der Schreiber beginnt leer, Leser
+ * sehen bis dahin Nullen.
+ */
+typedef struct
+{
+    unsigned gen;
+    prof_cycles_t v;
+} cycles_rec_t;
+
+typedef struct
+{
+    unsigned gen;
+    uint32_t v[PROF_HIST_BUCKETS];
+} hist_rec_t;
+
+typedef struct
+{
+    unsigned gen;
+    prof_timing_t v;
+} timing_rec_t;
+
+typedef struct
+{
+    unsigned gen;
+    prof_latency_t v;
+} latency_rec_t;
+
+static atomic_uint generation;
+
+// Je ein Schreiber: Abschnitte ihr Task, Histogramm der UI-Task, Rest der Sequenzer
+static struct
+{
+    seqlock_t lock;
+    cycles_rec_t rec;
+} sections[PROF_SECTION_COUNT];
+
+static struct
+{
+    seqlock_t lock;
+    hist_rec_t rec;
+} loop_hist;
+
+static struct
+{
+    seqlock_t lock;
+    timing_rec_t rec;
+} tone[PROF_TONE_EDGE_COUNT];
+
+static struct
+{
+    seqlock_t lock;
+    latency_rec_t rec;
+} latency;
+
+static int64_t last_loop_us = -1; // nur UI-Task
+
+// UI-Task -> Sequenzer: untere 32 Bit des offenen Tastendrucks, 0 = keiner
+static atomic_uint pending_press;
+
+/* Schreiber: true, wenn der Satz nach einem prof_reset() leer beginnen muss */
+static bool rec_stale(unsigned *gen)
+{
+    unsigned g = atomic_load_explicit(&generation, memory_order_relaxed);
+
+    if (*gen == g)
+        return false;
+
+    *gen = g;
+    return true;
+}
+
+/* Leser: konsistente Kopie, false wenn sie aus einer alten Generation stammt */
+static bool rec_read(seqlock_t *lock, void *copy, const void *rec, size_t size)
+{
+    seqlock_read(lock, copy, rec, size);
+    return *(const unsigned *)copy == atomic_load(&generation);
+}
+
+void prof_end(prof_section_t section, uint32_t t0)
+{
+    uint32_t cycles = esp_cpu_get_ccount() - t0;
+    cycles_rec_t r = sections[section].rec;
+
+    if (rec_stale(&r.gen))
+        memset(&r.v, 0, sizeof(r.v));
+
+    r.v.count++;
+    r.v.total_cycles += cycles;
+    if (cycles > r.v.max_cycles)
+        r.v.max_cycles = cycles;
+
+    seqlock_write(&sections[section].lock, &sections[section].rec, &r, sizeof(r));
+}
+
+void prof_loop_start(int64_t now_us)
+{
+    int64_t last = last_loop_us;
+
+    last_loop_us = now_us;
+    if (last < 0)
+        return;
+
+    uint32_t ms = (uint32_t)((now_us - last) / 1000);
+    int bucket = ms == 0 ? 0 : 32 - __builtin_clz(ms);
+    if (bucket >= PROF_HIST_BUCKETS)
+        bucket = PROF_HIST_BUCKETS - 1;
+
+    hist_rec_t r = loop_hist.rec;
+    if (rec_stale(&r.gen))
+        memset(r.v, 0, sizeof(r.v));
+    r.v[bucket]++;
+
+    seqlock_write(&loop_hist.lock, &loop_hist.rec, &r, sizeof(r));
+}
+
+void prof_tone_edge(prof_tone_edge_t edge, int64_t late_us)
+{
+    timing_rec_t r = tone[edge].rec;
+
+    if (rec_stale(&r.gen))
+        memset(&r.v, 0, sizeof(r.v));
+
+    r.v.count++;
+    if (late_us >= 0)
+    {
+        r.v.total_abs_us += (uint64_t)late_us;
+        if (late_us > r.v.max_late_us)
+            r.v.max_late_us = (int32_t)late_us;
+    }
+    else
+    {
+        r.v.total_abs_us += (uint64_t)-late_us;
+        if (-late_us > r.v.max_early_us)
+            r.v.max_early_us = (int32_t)-late_us;
+    }
+
+    seqlock_write(&tone[edge].lock, &tone[edge].rec, &r, sizeof(r));
+}
+
+void prof_input_edge(int64_t press_us)
+{
+    uint32_t t = (uint32_t)press_us | 1; // nie 0, 1 µs Fehler ist egal
+    uint32_t open = atomic_load(&pending_press);
+
+    // Ein offener Druck zählt, bis er zu alt ist: gemessen wird der erste
+    if (open == 0 || t - open > PROF_LATENCY_WINDOW_US)
+        atomic_store(&pending_press, t);
+}
+
+void prof_input_sounded(int64_t now_us)
+{
+    uint32_t press = atomic_exchange(&pending_press, 0);
+    uint32_t us = (uint32_t)now_us - press;
+
+    if (press == 0 || us > PROF_LATENCY_WINDOW_US)
+        return;
+
+    latency_rec_t r = latency.rec;
+    if (rec_stale(&r.gen))
+        memset(&r.v, 0, sizeof(r.v));
+
+    r.v.count++;
+    r.v.total_us += us;
+    if (us > r.v.max_us)
+        r.v.max_us = us;
+
+    seqlock_write(&latency.lock, &latency.rec, &r, sizeof(r));
+}
+
+const char *prof_section_name(prof_section_t section)
+{
+    return section < PROF_SECTION_COUNT ? section_names[section] : "?";
+}
+
+void prof_read(prof_report_t *report)
+{
+    cycles_rec_t c;
+    hist_rec_t h;
+    timing_rec_t t;
+    latency_rec_t l;
+
+    memset(report, 0, sizeof(*report));
+
+    for (int i = 0; i < PROF_SECTION_COUNT; i++)
+    {
+        if (rec_read(&sections[i].lock, &c, &sections[i].rec, sizeof(c)))
+            report->section[i] = c.v;
+    }
+
+    if (rec_read(&loop_hist.lock, &h, &loop_hist.rec, sizeof(h)))
+        memcpy(report->loop_hist, h.v, sizeof(h.v));
+
+    for (int i = 0; i < PROF_TONE_EDGE_COUNT; i++)
+    {
+        if (rec_read(&tone[i].lock, &t, &tone[i].rec, sizeof(t)))
+            report->tone[i] = t.v;
+    }
+
+    if (rec_read(&latency.lock, &l, &latency.rec, sizeof(l)))
+        report->latency = l.v;
+}
+
+void prof_reset(void)
+{
+    atomic_fetch_add(&generation, 1);
+}
+
+void prof_dump(void)
+{
+    static const char *const edge_names[PROF_TONE_EDGE_COUNT] = {"start", "stop"};
+    static prof_report_t r; // nicht auf den Stack des UI-Tasks
+    char line[160];
+    int n = 0;
+
+    prof_read(&r);
+    prof_reset();
+
+    ESP_LOGI(TAG, "%-15s %7s %9s %9s  [cycles]", "section", "count", "mean", "max");
+    for (int i = 0; i < PROF_SECTION_COUNT; i++)
+    {
+        const prof_cycles_t *c = &r.section[i];
+
+        if (c->count == 0)
+            continue;
+        ESP_LOGI(TAG, "%-15s %7u %9u %9u", prof_section_name(i), (unsigned)c->count,
+                 (unsigned)(c->total_cycles / c->count), (unsigned)c->max_cycles);
+    }
+
+    // Fach i: Perioden ab 2^(i-1) ms
+    for (int i = 0; i < PROF_HIST_BUCKETS; i++)
+    {
+        unsigned from = i == 0 ? 0 : 1u << (i - 1);
+        n += snprintf(line + n, sizeof(line) - n, " %s%u:%u", i == PROF_HIST_BUCKETS - 1 ? ">=" : "",
+                      from, (unsigned)r.loop_hist[i]);
+    }
+    ESP_LOGI(TAG, "loop period [ms]%s", line);
+
+    for (int i = 0; i < PROF_TONE_EDGE_COUNT; i++)
+    {
+        const prof_timing_t *t = &r.tone[i];
+
+        ESP_LOGI(TAG, "tone %-5s n=%u mean|err|=%uus late max=%dus early max=%dus", edge_names[i],
+                 (unsigned)t->count, t->count ? (unsigned)(t->total_abs_us / t->count) : 0,
+                 (int)t->max_late_us, (int)t->max_early_us);
+    }
+
+    ESP_LOGI(TAG, "input->tone n=%u mean=%uus max=%uus", (unsigned)r.latency.count,
+             r.latency.count ? (unsigned)(r.latency.total_us / r.latency.count) : 0,
+             (unsigned)r.latency.max_us);
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_cpu.h"
+
+/*
+ * Laufzeit-Profiler, bleibt auch im Produktions-Build an.
+ *
+ * Misst Zyklen (esp_cpu_get_ccount()) pro Abschnitt, die Periode der
+ * Hauptschleife als Histogramm, geplante gegen tatsächliche Notengrenzen
+ * und die Zeit vom Tastendruck bis zum Ton. Jeder Block hat genau einen
+ * Schreiber (oder mehrere hinter derselben Sperre) und wird per seqlock.h
+ * veröffentlicht: Messen wartet nie, ein Abschnitt kostet ~100 Zyklen.
+ *
+ * ccount zählt pro Core, jeder Abschnitt läuft in einem angehefteten Task
+ * und wechselt den Core nicht. Mit dynamischer CPU-Frequenz (power.h) sind
+ * Zyklen das Maß für die Arbeit, nicht für die Zeit.
+ *
+ * Ausgabe über das Log mit prof_dump(); danach beginnen alle Zähler
+ * neu, jeder Dump deckt also die Zeit seit dem letzten ab.
+ */
+
+typedef enum
+{
+    PROF_LOOP = 0,       // playbox_loop_once() gesamt
+    PROF_INPUT,          // input_collect()
+    PROF_MODE_BEEP,      // Mode-Handler
+    PROF_MODE_MIDI,
+    PROF_MODE_QUIZ,
+    PROF_MODE_TONLEITER,
+    PROF_SEQ_CMD,        // ein Kommando im Sequenzer-Task
+    PROF_SEQ_TICK,       // Rampen, Notengrenze und Timer im Sequenzer-Task
+    PROF_SEQ_NOTE,       // Buzzer-Timer auf einen neuen Ton stellen (note_timer.h)
+    PROF_LED,            // LED-Effekte: Schritte und Timer
+    PROF_SECTION_COUNT
+} prof_section_t;
+
+typedef enum
+{
+    PROF_TONE_START = 0, // Ton hörbar: Frequenz gesetzt, Attack läuft
+    PROF_TONE_STOP,      // Release beginnt bzw. harter Schnitt
+    PROF_TONE_EDGE_COUNT
+} prof_tone_edge_t;
+
+/* Schleifenperiode: Fach 0 < 1 ms, Fach i ab 2^(i-1) ms, das letzte ab 1024 ms */
+#define PROF_HIST_BUCKETS 12
+
+/* Ein Tastendruck, der so lange ohne Ton bleibt, zählt nicht als Latenz */
+#define PROF_LATENCY_WINDOW_US 100000
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} prof_cycles_t;
+
+typedef struct
+{
+    uint32_t count;
+    int32_t max_late_us;  // größte Verspätung gegenüber dem Plan
+    int32_t max_early_us; // größter Vorlauf, 0 wenn nie zu früh
+    uint64_t total_abs_us;
+} prof_timing_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+} prof_latency_t;
+
+typedef struct
+{
+    prof_cycles_t section[PROF_SECTION_COUNT];
+    uint32_t loop_hist[PROF_HIST_BUCKETS];
+    prof_timing_t tone[PROF_TONE_EDGE_COUNT];
+    prof_latency_t latency;
+} prof_report_t;
+
+static inline uint32_t prof_begin(void)
+{
+    return esp_cpu_get_ccount();
+}
+
+/* Abschnitt @section beenden, @t0 von prof_begin() im selben Task */
+void prof_end(prof_section_t section, uint32_t t0);
+
+/* Anfang eines Schleifendurchlaufs (UI-Task), @now_us: esp_timer-Zeit */
+void prof_loop_start(int64_t now_us);
+
+/* Notengrenze @edge, @late_us = ist - soll (Sequenzer-Task) */
+void prof_tone_edge(prof_tone_edge_t edge, int64_t late_us);
+
+/**
+ * prof_input_edge - Tastendruck vormerken (UI-Task)
+ * @press_us: Zeitstempel der ersten Flanke aus der ISR
+ *
+ * Der nächste Ton auf ein Kommando hin schließt die Messung ab. Ein noch
+ * offener Druck bleibt stehen, bis er älter als PROF_LATENCY_WINDOW_US ist.
+ */
+void prof_input_edge(int64_t press_us);
+
+/* Ton auf ein Kommando hin hörbar (Sequenzer-Task) */
+void prof_input_sounded(int64_t now_us);
+
+/* Kurzname für Berichte, z.B. "seq_tick" */
+const char *prof_section_name(prof_section_t section);
+
+/* Konsistente Kopie aller Zähler, aus jedem Task */
+void prof_read(prof_report_t *report);
+
+/* Alle Zähler beginnen neu; die Schreiber übernehmen das bei ihrer nächsten Messung */
+void prof_reset(void);
+
+/* Bericht ins Log, danach prof_reset() */
+void prof_dump(void);
@@ -0,0 +1,127 @@
+#include "quiz.h"
+
+void quiz_arbiter_init(quiz_arbiter_t *arb, int64_t tie_window_us)
+{
+    arb->tie_window_us = tie_window_us;
+    arb->winner = QUIZ_NO_PLAYER; // keine Runde abzuschließen
+    for (int p = 0; p < QUIZ_MAX_PLAYERS; p++)
+        arb->stamp_err_us[p] = 0;
+    arb->stats = (quiz_stats_t){
+        .last_winner = QUIZ_NO_PLAYER,
+        .last_margin_us = -1,
+        .min_margin_us = -1,
+    };
+
+    quiz_arbiter_reset(arb);
+}
+
+void quiz_set_stamp_error(quiz_arbiter_t *arb, int player, int64_t err_us)
+{
+    if (player >= 0 && player < QUIZ_MAX_PLAYERS && err_us >= 0)
+        arb->stamp_err_us[player] = err_us;
+}
+
+/* Fenster für das Paar @a, @b: was beide Stempel nicht auflösen, ist gleich */
+static int64_t quiz_window(const quiz_arbiter_t *arb, int a, int b)
+{
+    return arb->tie_window_us + arb->stamp_err_us[a] + arb->stamp_err_us[b];
+}
+
+/*
+ * Runde schließen: erst jetzt steht die Reihenfolge fest. Ein später
+ * zugestellter, früherer Druck kann Platz 1/2 bis hierhin noch umstellen,
+ * ein vorläufiger Abstand zählt deshalb nicht für min_margin_us.
+ */
+static void quiz_close_round(quiz_arbiter_t *arb)
+{
+    quiz_stats_t *st = &arb->stats;
+
+    if (arb->winner == QUIZ_NO_PLAYER || arb->runner_up == QUIZ_NO_PLAYER)
+        return;
+
+    int64_t margin = arb->second_us - arb->first_us;
+    if (st->min_margin_us < 0 || margin < st->min_margin_us)
+        st->min_margin_us = margin;
+}
+
+void quiz_arbiter_reset(quiz_arbiter_t *arb)
+{
+    quiz_close_round(arb);
+
+    arb->winner = QUIZ_NO_PLAYER;
+    arb->runner_up = QUIZ_NO_PLAYER;
+    arb->first_us = 0;
+    arb->second_us = 0;
+    arb->pressed = 0;
+    arb->tie = false;
+}
+
+/* Statistik nach jeder Änderung an Platz 1/2 neu ableiten */
+static void quiz_update_stats(quiz_arbiter_t *arb, bool new_round)
+{
+    quiz_stats_t *st = &arb->stats;
+
+    if (new_round)
+        st->rounds++;
+    else if (st->last_winner != arb->winner)
+        st->wins[st->last_winner]--; // Führung hat gewechselt
+
+    if (st->last_winner != arb->winner || new_round)
+        st->wins[arb->winner]++;
+
+    st->last_winner = arb->winner;
+
+    if (arb->runner_up == QUIZ_NO_PLAYER)
+    {
+        st->last_margin_us = -1;
+        st->last_margin_err_us = 0;
+        return;
+    }
+
+    int64_t margin = arb->second_us - arb->first_us;
+    st->last_margin_us = margin;
+    st->last_margin_err_us = arb->stamp_err_us[arb->winner] + arb->stamp_err_us[arb->runner_up];
+
+    bool tie = margin <= quiz_window(arb, arb->winner, arb->runner_up);
+    if (tie && !arb->tie)
+        st->ties++;
+    else if (!tie && arb->tie)
+        st->ties--;
+    arb->tie = tie;
+}
+
+quiz_result_t quiz_submit(quiz_arbiter_t *arb, int player, int64_t time_us)
+{
+    if (player < 0 || player >= QUIZ_MAX_PLAYERS || (arb->pressed & (1u << player)))
+        return QUIZ_IGNORED;
+
+    arb->pressed |= 1u << player;
+
+    if (arb->winner == QUIZ_NO_PLAYER)
+    {
+        arb->winner = player;
+        arb->first_us = time_us;
+        quiz_update_stats(arb, true);
+        return QUIZ_FIRST;
+    }
+
+    if (time_us < arb->first_us)
+    {
+        // Verspätet zugestellt, aber früher gedrückt
+        arb->runner_up = arb->winner;
+        arb->second_us = arb->first_us;
+        arb->winner = player;
+        arb->first_us = time_us;
+        quiz_update_stats(arb, false);
+        return QUIZ_FIRST;
+    }
+
+    if (arb->runner_up == QUIZ_NO_PLAYER || time_us < arb->second_us)
+    {
+        arb->runner_up = player;
+        arb->second_us = time_us;
+        quiz_update_stats(arb, false);
+    }
+
+    return time_us - arb->first_us <= quiz_window(arb, arb->winner, player) ? QUIZ_TIE : QUIZ_LATE;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Quizmaster-Arbitrierung nach Hardware-Zeitstempel.
+ *
+ * Reine Logik ohne Hardwarezugriff: die Zeitstempel kommen aus der
+ * Eingabe-ISR (esp_timer, µs) oder auf dem Host direkt aus dem Test.
+ *
+ * Stempel aus einem Scan statt einer ISR (Schieberegister-Kette) sind
+ * nur auf ± eine halbe Scan-Periode genau. Mit quiz_set_stamp_error()
+ * wächst das Gleichstandsfenster eines Paares um beide Unsicherheiten:
+ * was der Scan nicht auflösen kann, gilt als Gleichstand statt als
+ * Sieg nach Scan-Phase.
+ */
+
+#define QUIZ_MAX_PLAYERS 8
+
+/* Zwei Drücke näher als das gelten als Gleichstand (überschreibbar per -D) */
+#ifndef QUIZ_TIE_WINDOW_US
+#define QUIZ_TIE_WINDOW_US 1000
+#endif
+
+#define QUIZ_NO_PLAYER -1
+
+typedef enum
+{
+    QUIZ_IGNORED = 0, // Spieler hat in dieser Runde schon gedrückt
+    QUIZ_FIRST,       // neuer erster Druck (Gewinner)
+    QUIZ_TIE,         // innerhalb des Gleichstandsfensters zum Gewinner
+    QUIZ_LATE,        // später als das Fenster, Abstand gemessen
+} quiz_result_t;
+
+/* Lesbare Statistik über alle Runden */
+typedef struct
+{
+    uint32_t rounds;      // entschiedene Runden
+    uint32_t ties;        // Runden mit Gleichstand
+    uint32_t wins[QUIZ_MAX_PLAYERS];
+    int last_winner;
+    int64_t last_margin_us;  // Abstand Gewinner -> Zweiter (laufende Runde, vorläufig), -1 wenn keiner
+    int64_t last_margin_err_us; // ± Unsicherheit von last_margin_us, 0 bei zwei ISR-Stempeln
+    int64_t min_margin_us;   // knappster Abstand abgeschlossener Runden, -1 wenn keiner
+} quiz_stats_t;
+
+typedef struct
+{
+    int64_t tie_window_us;
+    int64_t stamp_err_us[QUIZ_MAX_PLAYERS]; // ± pro Spieler, 0 = ISR-Stempel
+    int winner;           // QUIZ_NO_PLAYER solange offen
+    int64_t first_us;
+    int runner_up;
+    int64_t second_us;
+    uint32_t pressed;     // Bit n = Spieler n hat gedrückt
+    bool tie;
+    quiz_stats_t stats;
+} quiz_arbiter_t;
+
+/* Alle Spieler mit exakten Stempeln; danach ggf. quiz_set_stamp_error() */
+void quiz_arbiter_init(quiz_arbiter_t *arb, int64_t tie_window_us);
+
+/**
+ * quiz_set_stamp_error - Genauigkeit der Zeitstempel von @player
+ * @err_us: ± µs, z.B. INPUT_SCAN_US / 2 für einen Ketten-Eingang
+ *
+ * Zwei Drücke gelten als Gleichstand, solange ihr Abstand höchstens
+ * tie_window_us plus beide Unsicherheiten beträgt.
+ */
+void quiz_set_stamp_error(quiz_arbiter_t *arb, int player, int64_t err_us);
+
+/* Neue Frage: die laufende Runde abschließen (min_margin_us) und eine neue öffnen */
+void quiz_arbiter_reset(quiz_arbiter_t *arb);
+
+/**
+ * quiz_submit - Druck eines Spielers mit Zeitstempel einreichen
+ * @player: Index 0..QUIZ_MAX_PLAYERS-1
+ * @time_us: Zeitstempel der Flanke
+ *
+ * Die Reihenfolge der Aufrufe ist egal: ein später eingereichter, aber
+ * früherer Zeitstempel übernimmt die Führung (Ergebnis QUIZ_FIRST).
+ */
+quiz_result_t quiz_submit(quiz_arbiter_t *arb, int player, int64_t time_us);
+
+static inline int quiz_winner(const quiz_arbiter_t *arb)
+{
+    return arb->winner;
+}
@@ -0,0 +1,449 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#include "recorder.h"
+#include "dlog.h"
+
+#define REC_TASK_CORE 0  // neben der UI: schreibt nur, wenn sie wartet
+#define REC_TASK_PRIO 1
+#define REC_TASK_STACK 3072 // NVS-Bibliothek
+
+#define REC_BUTTON_BITS 4
+#define REC_DELTA_MAX (UINT32_MAX >> REC_BUTTON_BITS) // ~2,4 h (8590 s) bei 32 µs
+#define REC_VARINT_MAX 5
+
+static const char *TAG = "REC";
+
+/*
+ * Beim Aufnehmen ein Ring mit laufenden Positionen (head - tail = belegt),
+ * nach rec_stop() linear ab take[0]. Die UI schreibt, der Speicher-Task
+ * liest nur, solange saving gesetzt ist; rec_start() wartet das ab.
+ */
+static uint8_t take[REC_RING_BYTES];
+static uint32_t head;
+static uint32_t tail;
+static int64_t last_tick;
+static bool recording = false;
+static atomic_bool saving;
+
+// Wiedergabe: nächstes Ereignis, schon dekodiert
+static bool playing = false;
+static uint32_t play_pos;
+static int64_t play_at_us;
+static uint8_t play_button;
+
+static rec_stats_t stats;
+static bool nvs_ready = false;
+static TaskHandle_t task = NULL;
+static esp_timer_handle_t play_timer = NULL;
+static void (*rec_notify)(void) = NULL;
+
+/* ===================== Kodierung ===================== */
+
+static int varint_put(uint8_t *out, uint32_t v)
+{
+    int n = 0;
+
+    while (v >= 0x80)
+    {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+bool rec_decode(const uint8_t *data, uint32_t len, uint32_t *pos, rec_event_t *ev)
+{
+    uint32_t v = 0;
+
+    for (int shift = 0; shift < 7 * REC_VARINT_MAX; shift += 7)
+    {
+        if (*pos >= len)
+            return false;
+
+        uint8_t b = data[(*pos)++];
+        v |= (uint32_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+        {
+            ev->button = (uint8_t)(v & ((1u << REC_BUTTON_BITS) - 1));
+            ev->delta_ticks = v >> REC_BUTTON_BITS;
+            return ev->button < REC_BUTTONS;
+        }
+    }
+    return false;
+}
+
+/* Ältesten Druck aus dem Ring werfen: bis hinter das erste Byte ohne Fortsetzungsbit */
+static void ring_drop_oldest(void)
+{
+    while (take[tail++ % REC_RING_BYTES] & 0x80)
+        ;
+    stats.events--;
+    stats.overwritten++;
+}
+
+static void reverse(uint8_t *p, uint32_t n)
+{
+    for (uint32_t i = 0; i < n / 2; i++)
+    {
+        uint8_t t = p[i];
+        p[i] = p[n - 1 - i];
+        p[n - 1 - i] = t;
+    }
+}
+
+/* Ring an Ort und Stelle nach take[0..bytes) drehen: dreimal umkehren */
+static void ring_linearize(void)
+{
+    uint32_t bytes = head - tail;
+    uint32_t start = tail % REC_RING_BYTES;
+
+    reverse(take, start);
+    reverse(take + start, REC_RING_BYTES - start);
+    reverse(take, REC_RING_BYTES);
+
+    tail = 0;
+    head = bytes;
+}
+
+/* ===================== Aufnahme ===================== */
+
+bool rec_start(int64_t start_us)
+{
+    if (atomic_load(&saving))
+    {
+        stats.busy++;
+        return false;
+    }
+
+    rec_play_stop();
+    head = tail = 0;
+    stats.events = 0;
+    stats.bytes = 0;
+    stats.overwritten = 0;
+    last_tick = start_us / REC_TICK_US;
+    recording = true;
+    return true;
+}
+
+void rec_press(uint8_t button, int64_t press_us)
+{
+    uint8_t buf[REC_VARINT_MAX];
+
+    if (!recording || button >= REC_BUTTONS)
+        return;
+
+    // Drücke eines Durchlaufs kommen nach Pin, nicht nach Zeit: nie rückwärts
+    int64_t tick = press_us / REC_TICK_US;
+    if (tick < last_tick)
+        tick = last_tick;
+    int64_t delta = tick - last_tick;
+    if (delta > REC_DELTA_MAX)
+        delta = REC_DELTA_MAX;
+    last_tick = tick;
+
+    int n = varint_put(buf, (uint32_t)delta << REC_BUTTON_BITS | button);
+    while (head - tail + (uint32_t)n > REC_RING_BYTES)
+        ring_drop_oldest();
+    for (int i = 0; i < n; i++)
+        take[head++ % REC_RING_BYTES] = buf[i];
+
+    stats.events++;
+    stats.bytes = head - tail;
+}
+
+bool rec_stop(void)
+{
+    if (!recording)
+        return false;
+
+    recording = false;
+    ring_linearize();
+    if (stats.events == 0)
+    {
+        // Leere Session: die gespeicherte Aufnahme bleibt die letzte
+        rec_load();
+        return false;
+    }
+    if (!nvs_ready || task == NULL)
+        return false;
+
+    atomic_store(&saving, true);
+    xTaskNotifyGive(task);
+    return true;
+}
+
+bool rec_recording(void)
+{
+    return recording;
+}
+
+bool rec_saving(void)
+{
+    return atomic_load(&saving);
+}
+
+size_t rec_image(uint8_t *buf, size_t size)
+{
+    rec_header_t hdr = {
+        .magic = REC_MAGIC,
+        .version = REC_VERSION,
+        .count = (uint16_t)stats.events,
+        .bytes = head,
+        .tick_us = REC_TICK_US,
+    };
+
+    if (recording || size < sizeof(hdr) + head)
+        return 0;
+
+    memcpy(buf, &hdr, sizeof(hdr));
+    memcpy(buf + sizeof(hdr), take, head);
+    return sizeof(hdr) + head;
+}
+
+const rec_stats_t *rec_stats(void)
+{
+    return &stats;
+}
+
+/* ===================== NVS ===================== */
+
+/* "c0".."c255": uint8_t passt mit Null sicher in 8 Byte */
+_Static_assert(REC_NVS_CHUNKS <= 255, "chunk index exceeds uint8_t");
+
+static void chunk_key(char *key, size_t size, uint8_t i)
+{
+    snprintf(key, size, "c%u", (unsigned)i);
+}
+
+/* take[0..head) unter REC_NVS_NAMESPACE ablegen, Header zuletzt */
+static esp_err_t rec_save(void)
+{
+    rec_header_t hdr = {
+        .magic = REC_MAGIC,
+        .version = REC_VERSION,
+        .count = (uint16_t)stats.events,
+        .bytes = head,
+        .tick_us = REC_TICK_US,
+    };
+    int chunks = (int)((head + REC_NVS_CHUNK - 1) / REC_NVS_CHUNK);
+    nvs_handle_t h;
+    char key[8];
+
+    esp_err_t err = nvs_open(REC_NVS_NAMESPACE, NVS_READWRITE, &h);
+    if (err != ESP_OK)
+        return err;
+
+    // Bricht das Schreiben ab, bleibt keine halbe Aufnahme gültig
+    err = nvs_erase_key(h, "hdr");
+    if (err == ESP_ERR_NVS_NOT_FOUND)
+        err = ESP_OK;
+
+    for (int i = 0; i < chunks && err == ESP_OK; i++)
+    {
+        uint32_t off = (uint32_t)i * REC_NVS_CHUNK;
+        uint32_t n = head - off < REC_NVS_CHUNK ? head - off : REC_NVS_CHUNK;
+
+        chunk_key(key, sizeof(key), (uint8_t)i);
+        err = nvs_set_blob(h, key, take + off, n);
+        stats.chunk_writes++;
+    }
+
+    // Stücke einer längeren Aufnahme davor
+    for (int i = chunks; i < REC_NVS_CHUNKS && err == ESP_OK; i++)
+    {
+        chunk_key(key, sizeof(key), (uint8_t)i);
+        err = nvs_erase_key(h, key);
+        if (err == ESP_ERR_NVS_NOT_FOUND)
+            err = ESP_OK;
+    }
+
+    if (err == ESP_OK)
+        err = nvs_set_blob(h, "hdr", &hdr, sizeof(hdr));
+    if (err == ESP_OK)
+        err = nvs_commit(h);
+    nvs_close(h);
+    return err;
+}
+
+bool rec_load(void)
+{
+    rec_header_t hdr;
+    size_t len = sizeof(hdr);
+    nvs_handle_t h;
+    char key[8];
+    bool ok;
+
+    if (!nvs_ready || recording || atomic_load(&saving))
+        return false;
+    if (nvs_open(REC_NVS_NAMESPACE, NVS_READONLY, &h) != ESP_OK)
+        return false;
+
+    ok = nvs_get_blob(h, "hdr", &hdr, &len) == ESP_OK && len == sizeof(hdr) &&
+         hdr.magic == REC_MAGIC && hdr.version == REC_VERSION && hdr.tick_us == REC_TICK_US &&
+         hdr.bytes <= REC_RING_BYTES;
+
+    for (uint32_t off = 0; ok && off < hdr.bytes; off += REC_NVS_CHUNK)
+    {
+        size_t n = hdr.bytes - off < REC_NVS_CHUNK ? hdr.bytes - off : REC_NVS_CHUNK;
+        len = n;
+        chunk_key(key, sizeof(key), (uint8_t)(off / REC_NVS_CHUNK));
+        ok = nvs_get_blob(h, key, take + off, &len) == ESP_OK && len == n;
+    }
+    nvs_close(h);
+
+    // Nur vollständig dekodierbare Aufnahmen mit passender Anzahl
+    uint32_t pos = 0, count = 0;
+    rec_event_t ev;
+    while (ok && pos < hdr.bytes && rec_decode(take, hdr.bytes, &pos, &ev))
+        count++;
+    ok = ok && pos == hdr.bytes && count == hdr.count;
+
+    rec_play_stop();
+    tail = 0;
+    head = ok ? hdr.bytes : 0;
+    stats.events = ok ? count : 0;
+    stats.bytes = head;
+    return ok;
+}
+
+static void rec_task_fn(void *arg)
+{
+    (void)arg;
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        esp_err_t err = rec_save();
+        if (err == ESP_OK)
+        {
+            stats.saves++;
+            DLOGI(DLOG_REC, "saved %u presses, %u bytes", (unsigned)stats.events, (unsigned)head);
+        }
+        else
+        {
+            stats.save_errors++;
+            DLOGW(DLOG_REC, "save failed: %d", (int)err);
+        }
+        atomic_store(&saving, false);
+    }
+}
+
+/* ===================== Wiedergabe ===================== */
+
+static void play_timer_cb(void *arg)
+{
+    (void)arg;
+
+    if (rec_notify)
+        rec_notify();
+}
+
+/* Nächstes Ereignis dekodieren und den Wecker dafür stellen */
+static void play_advance(int64_t at_us)
+{
+    rec_event_t ev;
+
+    if (!rec_decode(take, head, &play_pos, &ev))
+    {
+        playing = false;
+        return;
+    }
+
+    play_button = ev.button;
+    play_at_us = at_us + (int64_t)ev.delta_ticks * REC_TICK_US;
+
+    int64_t now = esp_timer_get_time();
+    esp_timer_stop(play_timer);
+    esp_timer_start_once(play_timer, (uint64_t)(play_at_us > now ? play_at_us - now : 0));
+}
+
+bool rec_play_start(int64_t now_us)
+{
+    rec_event_t ev;
+    uint32_t pos = 0;
+
+    if (recording || !rec_decode(take, head, &pos, &ev))
+        return false;
+
+    // Ohne den Vorlauf bis zum ersten Druck
+    play_pos = pos;
+    play_button = ev.button;
+    play_at_us = now_us;
+    playing = true;
+    return true;
+}
+
+void rec_play_stop(void)
+{
+    playing = false;
+    if (play_timer)
+        esp_timer_stop(play_timer);
+}
+
+bool rec_playing(void)
+{
+    return playing;
+}
+
+int rec_play_due(int64_t now_us)
+{
+    if (!playing || now_us < play_at_us)
+        return -1;
+
+    int button = play_button;
+    play_advance(play_at_us);
+    return button;
+}
+
+/* ===================== Init ===================== */
+
+void rec_set_notify(void (*cb)(void))
+{
+    rec_notify = cb;
+}
+
+void rec_init(void)
+{
+    const esp_timer_create_args_t args = {
+        .callback = play_timer_cb,
+        .name = "rec",
+    };
+
+    atomic_init(&saving, false);
+    esp_timer_create(&args, &play_timer);
+
+    // Volle oder mit neuerem Format beschriebene Partition: leeren, wie im IDF-Beispiel
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        nvs_flash_erase();
+        err = nvs_flash_init();
+    }
+    nvs_ready = err == ESP_OK;
+    if (!nvs_ready)
+    {
+        ESP_LOGW(TAG, "no NVS (%s), recordings stay in RAM", esp_err_to_name(err));
+        return;
+    }
+
+    xTaskCreatePinnedToCore(rec_task_fn, "rec", REC_TASK_STACK, NULL, REC_TASK_PRIO, &task,
+                            REC_TASK_CORE);
+
+    if (rec_load())
+        ESP_LOGI(TAG, "last recording: %u presses, %u bytes", (unsigned)stats.events,
+                 (unsigned)stats.bytes);
+}
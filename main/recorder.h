@@ -0,0 +1,138 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Aufnahme und Wiedergabe von BeepMode-Sessions.
+ *
+ * Jeder Druck auf einen der REC_BUTTONS Notentaster wird mit dem
+ * ISR-Zeitstempel abgelegt, als Abstand zum vorigen Druck in Ticks zu
+ * REC_TICK_US: ein LEB128-Wert (delta << 4 | taste), 7 Bit pro Byte, das
+ * oberste Bit sagt "es folgt noch eins". Bis 32 ms Abstand reichen 2 Byte,
+ * bis 4,2 s 3 Byte. Ein Ring hält die letzten REC_RING_BYTES; läuft er
+ * über, fallen die ältesten Drücke weg, und der erste Abstand zählt ab dem
+ * verworfenen Vorgänger.
+ *
+ * rec_press() kommt im UI-Task nach dem Ton und kostet einige Dutzend
+ * Zyklen: der Weg vom Druck zum Ton bleibt unverändert.
+ *
+ * Image (NVS, tools/recdump.py, playbox_sim --rec), little endian:
+ *   rec_header_t, dann header.bytes Byte Ereignisse
+ * Der erste Abstand zählt ab dem Start der Aufnahme (Mode-Druck). In NVS
+ * (Namespace REC_NVS_NAMESPACE) liegen die Ereignisse in Stücken zu
+ * REC_NVS_CHUNK Byte unter "c0", "c1", ..., der Header zuletzt unter "hdr":
+ * ohne "hdr" gilt nichts als gespeichert.
+ */
+
+#define REC_BUTTONS 16 // 4 Bit im Ereignis: P1, P2 und bis zu 6 Ketten-Spieler
+#define REC_TICK_US 32
+#define REC_RING_BYTES 4096
+#define REC_MAGIC 0x43455250 // "PREC"
+#define REC_VERSION 1
+
+/*
+ * NVS schreibt in Einträgen zu 32 Byte, 126 pro 4-KiB-Seite. Ein Blob
+ * kostet seine Daten plus einen Daten-Header und einen Index-Eintrag:
+ * 61 + 2 = 63, zwei Stücke füllen eine Seite ohne Verschnitt. Geschrieben
+ * wird nur beim Ende einer Aufnahme, nie pro Druck.
+ */
+#define REC_NVS_NAMESPACE "rec"
+#define REC_NVS_CHUNK (61 * 32)
+#define REC_NVS_CHUNKS ((REC_RING_BYTES + REC_NVS_CHUNK - 1) / REC_NVS_CHUNK)
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;   // Ereignisse
+    uint32_t bytes;   // Länge der Ereignisdaten
+    uint32_t tick_us; // REC_TICK_US der Aufnahme
+} rec_header_t;
+
+typedef struct
+{
+    uint8_t button;       // 0..REC_BUTTONS-1, Reihenfolge wie die Spieler-Tabelle
+    uint32_t delta_ticks; // Abstand zum vorigen Druck
+} rec_event_t;
+
+typedef struct
+{
+    uint32_t events;      // in der aktuellen Aufnahme
+    uint32_t bytes;
+    uint32_t overwritten; // davon wegen vollem Ring verworfen
+    uint32_t busy;        // nicht begonnen, weil noch gespeichert wurde
+    uint32_t saves;       // vollständig nach NVS geschrieben
+    uint32_t save_errors;
+    uint32_t chunk_writes; // nvs_set_blob() für Ereignisse, insgesamt
+} rec_stats_t;
+
+/* NVS öffnen, Speicher-Task starten und die letzte Aufnahme laden */
+void rec_init(void);
+
+/* Rückruf (UI-Task wecken), wenn bei der Wiedergabe ein Druck fällig wird */
+void rec_set_notify(void (*cb)(void));
+
+/**
+ * rec_start - neue Aufnahme, verwirft die im RAM
+ * @start_us: Bezugszeit für den ersten Abstand
+ *
+ * Gibt false zurück, solange die vorige Aufnahme noch gespeichert wird.
+ */
+bool rec_start(int64_t start_us);
+
+/* Druck auf Taste @button, @press_us aus der ISR; nur während einer Aufnahme */
+void rec_press(uint8_t button, int64_t press_us);
+
+/**
+ * rec_stop - Aufnahme beenden und im Hintergrund nach NVS schreiben
+ *
+ * Gibt false zurück, wenn nichts aufgenommen wurde (dann bleibt NVS, wie es
+ * war). Der Schreib-Task läuft mit niedriger Priorität auf Core 0, also
+ * nur, wenn die UI wartet; solange blockiert der Flash-Zugriff beide Cores.
+ */
+bool rec_stop(void);
+
+bool rec_recording(void);
+bool rec_saving(void);
+
+/* Letzte gespeicherte Aufnahme aus NVS in den RAM; false, wenn keine da ist */
+bool rec_load(void);
+
+/**
+ * rec_play_start - Wiedergabe der Aufnahme im RAM
+ *
+ * Beginnt sofort mit dem ersten Druck, die Abstände danach wie
+ * aufgenommen. Gibt false zurück, wenn es nichts zu spielen gibt.
+ */
+bool rec_play_start(int64_t now_us);
+void rec_play_stop(void);
+bool rec_playing(void);
+
+/**
+ * rec_play_due - nächsten fälligen Druck abholen
+ *
+ * Gibt die Taste zurück oder -1, wenn bis @now_us nichts fällig ist. Im
+ * UI-Task in einer Schleife aufrufen; das Ende beendet die Wiedergabe.
+ */
+int rec_play_due(int64_t now_us);
+
+/**
+ * rec_image - Aufnahme im RAM als Image
+ * @buf: Ziel, mindestens sizeof(rec_header_t) + Ereignisbytes
+ *
+ * Gibt die Länge zurück, 0 wenn @size nicht reicht oder gerade
+ * aufgenommen wird.
+ */
+size_t rec_image(uint8_t *buf, size_t size);
+
+/**
+ * rec_decode - ein Ereignis aus Ereignisbytes lesen
+ * @pos: Leseposition, wird weitergesetzt
+ *
+ * Gibt false zurück am Ende oder bei einem abgeschnittenen Wert.
+ */
+bool rec_decode(const uint8_t *data, uint32_t len, uint32_t *pos, rec_event_t *ev);
+
+const rec_stats_t *rec_stats(void);
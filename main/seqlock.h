@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+
+/*
+ * Sequenzzähler für Momentaufnahmen mit genau einem Schreiber.
+ *
+ * Für Zustand, den ein Task auf Core 1 laufend erneuert und andere nur
+ * lesen: der Schreiber wartet nie, Leser wiederholen die Kopie, falls sie
+ * in ein Update gefallen ist. Ungerader Zähler = Update läuft.
+ *
+ * Nur für kleine, kopierbare Strukturen; blockiert nie.
+ */
+
+typedef struct
+{
+    atomic_uint seq;
+} seqlock_t;
+
+static inline void seqlock_init(seqlock_t *sl)
+{
+    atomic_init(&sl->seq, 0);
+}
+
+/* Schreiber: @dst mit @src überschreiben */
+static inline void seqlock_write(seqlock_t *sl, void *dst, const void *src, size_t size)
+{
+    unsigned s = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&sl->seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(dst, src, size);
+    atomic_store_explicit(&sl->seq, s + 2, memory_order_release);
+}
+
+/* Leser: konsistente Kopie von @src nach @dst, gibt den Zählerstand zurück */
+static inline unsigned seqlock_read(seqlock_t *sl, void *dst, const void *src, size_t size)
+{
+    unsigned s1, s2;
+
+    do
+    {
+        s1 = atomic_load_explicit(&sl->seq, memory_order_acquire);
+        memcpy(dst, src, size);
+        atomic_thread_fence(memory_order_acquire);
+        s2 = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+    } while ((s1 & 1) || s1 != s2);
+
+    return s1;
+}
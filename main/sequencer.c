@@ -0,0 +1,668 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "driver/ledc.h"
+#include "esp_timer.h"
+
+#include "sequencer.h"
+#include "spsc.h"
+#include "smf.h"
+#include "envelope.h"
+#include "note_timer.h"
+#include "power.h"
+#include "profiler.h"
+#include "boot.h"
+#include "dlog.h"
+
+#define SEQ_TASK_CORE 1 // neben dem Audio-Task, UI und esp_timer laufen auf Core 0
+#define SEQ_TASK_PRIO 12 // über dem Audio-Task: eine Notengrenze ist kürzer als ein Block
+#define SEQ_TASK_STACK 2048
+#define SEQ_CMD_QUEUE_LEN 16
+
+typedef enum
+{
+    SEQ_CMD_TONE,
+    SEQ_CMD_SONG,
+    SEQ_CMD_MIDI,
+    SEQ_CMD_STOP,
+    SEQ_CMD_VOLUME,
+    SEQ_CMD_ENVELOPE,
+} seq_cmd_type_t;
+
+typedef struct
+{
+    seq_cmd_type_t type;
+    seq_prio_t prio;     // TONE, SONG, MIDI, STOP
+    bool chain;          // SEQ_CMD_SONG: an die Stimme der Klasse anhängen
+    uint32_t freq_hz;
+    uint32_t duration_ms;
+    song_t song;         // SEQ_CMD_SONG: Kopie der Beschreibung, Daten im Flash
+    const uint8_t *midi; // SEQ_CMD_MIDI: SMF-Datei im gemappten Flash
+    size_t midi_size;
+    uint8_t volume;      // SEQ_CMD_VOLUME: Prozent
+    tone_env_t env;      // SEQ_CMD_ENVELOPE
+} seq_cmd_t;
+
+/* ===================== BUZZER / TONE ===================== */
+typedef struct
+{
+    int64_t start_us;    // Beginn des aktuellen Tons (esp_timer-Zeit)
+    int64_t deadline_us; // absolutes Ende des aktuellen Tons
+    int64_t fade_end_us; // bis dahin läuft eine Hardware-Rampe, siehe buzzer_fade_stop()
+    uint32_t frequency;  // tatsächliche Frequenz des Timers, abgerundet; 0 = still
+    uint32_t level;      // Duty am Ende der letzten Rampe, in Schritten von 2^-res
+    uint8_t res;         // Duty-Auflösung des Timers, siehe note_timer.h
+    env_plan_t plan;     // Rampen des aktuellen Tons
+    bool playing;
+} buzzer_tone_t;
+
+/* ===================== STIMMEN ===================== */
+/* Eine Stimme pro Prioritätsklasse, siehe sequencer.h */
+typedef struct
+{
+    // Quelle der Schritte, Song und SMF dekodieren direkt aus dem Flash
+    union
+    {
+        song_cursor_t cursor; // gepackter Song
+        smf_mono_t midi;      // Standard MIDI File
+    };
+    seq_cmd_type_t kind; // SEQ_CMD_TONE, _SONG oder _MIDI
+    tone_step_t step;    // laufender Schritt; verdrängt: Dauer = Rest
+    tone_env_t env;      // aus dem Song-Header oder die Vorgabe
+    bool active;         // belegt: klingt oder wartet
+    bool has_step;       // step ist angefangen und noch nicht fertig
+    bool tone_left;      // SEQ_CMD_TONE: der eine Schritt steht noch aus
+    bool sounded;        // erster hörbarer Schritt gespielt (Latenzmessung)
+    bool has_next;
+    seq_cmd_t next;      // ChainToneSequence(): folgt ohne Lücke
+} seq_voice_t;
+
+/* Verdrängt: Rest der Note später spielen oder die Stimme verwerfen */
+static const bool prio_resumes[SEQ_PRIO_COUNT] = {
+    [SEQ_PRIO_MUSIC] = true,
+    [SEQ_PRIO_SFX] = false,
+    [SEQ_PRIO_CHIME] = false,
+};
+
+// Nur der Sequenzer-Task greift auf tone/voices zu
+static buzzer_tone_t tone = {0};
+static seq_voice_t voices[SEQ_PRIO_COUNT] = {0};
+static int owner = -1; // Klasse am Buzzer; -1: still oder Release nach einem Stopp
+static tone_timing_t tone_timing = {0};
+static tone_env_t default_env = BUZZER_ENV_DEFAULT;
+static uint32_t peak_duty = 0; // in BUZZER_PWM_RES-Schritten
+
+// UI-Task -> Sequenzer-Task
+static seq_cmd_t cmd_buf[SEQ_CMD_QUEUE_LEN];
+static spsc_t cmds;
+static uint32_t cmd_dropped = 0;
+
+// One-Shot-Timer für die nächste Notengrenze, weckt nur den Task
+static esp_timer_handle_t tone_timer = NULL;
+static TaskHandle_t seq_task = NULL;
+
+/* Lautstärke in Prozent -> Duty nach dem Attack; quadratisch, das Ohr hört logarithmisch */
+static uint32_t volume_duty(uint8_t percent)
+{
+    if (percent > 100)
+        percent = 100;
+
+    return BUZZER_DUTY_MAX * percent * percent / 10000;
+}
+
+/* Duty in BUZZER_PWM_RES-Schritten -> Schritte der aktuellen Auflösung */
+static uint32_t duty_at_res(uint32_t duty)
+{
+    return duty << (tone.res - BUZZER_PWM_RES);
+}
+
+static bool fade_busy(int64_t now)
+{
+    return now < tone.fade_end_us;
+}
+
+/*
+ * Laufende Rampe abbrechen, die Duty bleibt auf ihrem aktuellen Wert.
+ * Jeder andere Zugriff auf den Kanal würde bis zum Ende der Rampe
+ * blockieren; so wartet kein Kommando auf ein Stück der Hüllkurve.
+ */
+static void buzzer_fade_stop(void)
+{
+    if (!fade_busy(esp_timer_get_time()))
+        return;
+
+    ledc_fade_stop(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL);
+    tone.level = ledc_get_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL);
+    tone.fade_end_us = 0;
+}
+
+/* Harter Sprung, eine laufende Rampe endet dabei */
+static void buzzer_duty(uint32_t duty)
+{
+    buzzer_fade_stop();
+    ledc_set_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL, duty);
+    ledc_update_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL);
+    tone.level = duty;
+}
+
+static void buzzer_fade(const env_fade_t *f, int64_t now)
+{
+    if (f->len_us == 0)
+    {
+        buzzer_duty(f->duty);
+        return;
+    }
+
+    buzzer_fade_stop();
+    // Ohne Fade-Dienst (siehe led_init()) bleibt nur der harte Sprung
+    if (ledc_set_fade_with_step(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL, f->duty, f->scale, f->cycle_num) != ESP_OK)
+    {
+        buzzer_duty(f->duty);
+        return;
+    }
+    ledc_fade_start(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL, LEDC_FADE_NO_WAIT);
+    tone.level = f->duty;
+    tone.fade_end_us = now + f->len_us;
+}
+
+/**
+ * buzzer_freq - Timer auf @freq_hz umstellen, ohne ihn neu zu starten
+ *
+ * Noten kommen fertig aus note_timers[], nur andere Frequenzen rechnet
+ * note_timer_calc(). Der Timer läuft mit seiner Phase weiter (Legato).
+ * Wechselt die Auflösung unter einem klingenden Ton, wird dessen Duty
+ * umgerechnet; das alte Tastverhältnis gilt höchstens noch eine Periode.
+ * Gibt die tatsächliche Frequenz abgerundet zurück, 0 wenn kein Teiler passt.
+ */
+static uint32_t buzzer_freq(uint32_t freq_hz)
+{
+    uint8_t note = song_hz_note(freq_hz);
+    note_timer_t t;
+
+    if (note != 0)
+        t = note_timers[note];
+    else if (!note_timer_calc(freq_hz, &t))
+        return 0;
+
+    ledc_timer_set(BUZZER_LEDC_MODE, BUZZER_LEDC_TIMER, t.div, t.res, LEDC_APB_CLK);
+    if (t.res == tone.res)
+        return t.hz;
+
+    uint32_t level = t.res > tone.res ? tone.level << (t.res - tone.res) : tone.level >> (tone.res - t.res);
+    tone.res = t.res;
+    if (tone.level > 0)
+        buzzer_duty(level);
+    return t.hz;
+}
+
+/* Fällige Rampen des aktuellen Tons starten */
+static void env_run(int64_t now)
+{
+    uint32_t at;
+    env_fade_t f;
+
+    // Ein Stück nach dem anderen: das nächste erst, wenn die Hardware frei ist
+    while (!fade_busy(now) && env_next_at(&tone.plan, &at) && now >= tone.start_us + at)
+    {
+        env_next(&tone.plan, &f);
+        if (f.duty == 0)
+            prof_tone_edge(PROF_TONE_STOP, now - (tone.start_us + f.at_us));
+        buzzer_fade(&f, now);
+    }
+}
+
+/* Timer auf das nächste Ereignis: Rampe oder Notengrenze */
+static void seq_schedule(void)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t next = INT64_MAX;
+
+    if (tone.playing)
+        next = tone.deadline_us;
+    uint32_t at;
+    if (env_next_at(&tone.plan, &at) && tone.start_us + at < next)
+        next = tone.start_us + at;
+
+    esp_timer_stop(tone_timer); // läuft evtl. nicht, Fehler egal
+    if (next == INT64_MAX)
+        return;
+
+    esp_timer_start_once(tone_timer, next > now ? (uint64_t)(next - now) : 0);
+}
+
+/* Ton ab @start_us starten, Rampen und Grenze absolut planen */
+static void tone_start(uint32_t freq_hz, int64_t start_us, uint32_t duration_ms, const tone_env_t *env)
+{
+    buzzer_fade_stop(); // der neue Ton setzt am aktuellen Pegel an
+    tone.start_us = start_us;
+    tone.deadline_us = start_us + (int64_t)duration_ms * 1000;
+    env_clear(&tone.plan);
+    tone.playing = true;
+    power_acquire(POWER_LOCK_BUZZER); // kein Light Sleep, solange der Buzzer klingt
+
+    uint32_t t0 = prof_begin();
+    tone.frequency = freq_hz != 0 ? buzzer_freq(freq_hz) : 0;
+    prof_end(PROF_SEQ_NOTE, t0);
+
+    if (tone.frequency == 0)
+    {
+        // Pause (oder kein Teiler): Kanal stumm, Timer bleibt
+        if (tone.level > 0)
+            buzzer_duty(0);
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    prof_tone_edge(PROF_TONE_START, now - start_us);
+    boot_mark(BOOT_FIRST_NOTE); // zählt nur beim ersten Ton
+    env_plan(&tone.plan, env, tone.level, duty_at_res(peak_duty), tone.frequency, duration_ms * 1000);
+    env_run(now);
+}
+
+/* Ton ist aus: Kanal stumm und Sperre frei */
+static void tone_end(void)
+{
+    tone.playing = false;
+    env_clear(&tone.plan);
+
+    if (tone.level > 0)
+        buzzer_duty(0);
+    power_release(POWER_LOCK_BUZZER);
+}
+
+/* Quelle einer Stimme aus einem Auftrag; false bei ungültiger MIDI-Datei */
+static bool voice_load(seq_voice_t *v, const seq_cmd_t *cmd)
+{
+    v->kind = cmd->type;
+    v->env = default_env;
+    v->has_step = false;
+    v->sounded = false;
+
+    switch (cmd->type)
+    {
+    case SEQ_CMD_TONE:
+        v->step = (tone_step_t){.freq_hz = cmd->freq_hz, .duration_ms = cmd->duration_ms};
+        v->tone_left = true;
+        return true;
+
+    case SEQ_CMD_SONG:
+        song_cursor_init(&v->cursor, &cmd->song);
+        if (!song_envelope(&cmd->song, &v->env))
+            v->env = default_env;
+        return true;
+
+    case SEQ_CMD_MIDI:
+        if (smf_mono_init(&v->midi, cmd->midi, cmd->midi_size))
+            return true;
+        DLOGW(DLOG_SEQ, "invalid MIDI file");
+        return false;
+
+    default:
+        return false;
+    }
+}
+
+/* Nächster Schritt nach v->step; am Ende der Quelle weiter mit dem angehängten Auftrag */
+static bool voice_next(seq_voice_t *v)
+{
+    for (;;)
+    {
+        bool ok;
+
+        if (v->kind == SEQ_CMD_TONE)
+        {
+            ok = v->tone_left;
+            v->tone_left = false;
+        }
+        else if (v->kind == SEQ_CMD_SONG)
+        {
+            ok = song_cursor_next(&v->cursor, &v->step);
+        }
+        else
+        {
+            ok = smf_mono_next(&v->midi, &v->step);
+        }
+
+        if (ok)
+        {
+            v->has_step = true;
+            return true;
+        }
+
+        if (!v->has_next)
+            return false;
+        seq_cmd_t next = v->next;
+        v->has_next = false;
+        if (!voice_load(v, &next))
+            return false;
+    }
+}
+
+/* Höchste belegte Klasse, -1 wenn keine */
+static int voice_top(void)
+{
+    for (int p = SEQ_PRIO_COUNT - 1; p >= 0; p--)
+    {
+        if (voices[p].active)
+            return p;
+    }
+    return -1;
+}
+
+/**
+ * voice_select - höchste belegte Klasse ab @start_us spielen lassen
+ *
+ * Eine erschöpfte Stimme gibt ihre Klasse frei, dann ist die nächst-
+ * niedrigere dran: mit dem Rest ihrer unterbrochenen Note oder ihrem
+ * nächsten Schritt. Gibt false zurück, wenn keine Klasse mehr etwas hat;
+ * der laufende Ton bleibt dann dem Aufrufer.
+ */
+static bool voice_select(int64_t start_us)
+{
+    int p;
+
+    while ((p = voice_top()) >= 0)
+    {
+        seq_voice_t *v = &voices[p];
+
+        if (v->has_step || voice_next(v))
+        {
+            owner = p;
+            tone_start(v->step.freq_hz, start_us, v->step.duration_ms, &v->env);
+            if (!v->sounded && v->step.freq_hz != 0)
+            {
+                v->sounded = true;
+                prof_input_sounded(esp_timer_get_time());
+            }
+            return true;
+        }
+        v->active = false;
+    }
+
+    owner = -1;
+    return false;
+}
+
+/* Die klingende Klasse weicht einer höheren: Rest der Note merken oder verwerfen */
+static void voice_preempt(int64_t now)
+{
+    seq_voice_t *v = &voices[owner];
+    int64_t left_us = tone.deadline_us - now;
+
+    if (!prio_resumes[owner])
+        v->active = false;
+    else if (left_us >= 1000)
+        v->step.duration_ms = (uint32_t)(left_us / 1000);
+    else
+        v->has_step = false; // praktisch fertig
+    owner = -1;
+}
+
+/* Abbruch: Release ab jetzt statt hartem Schnitt, danach die nächste Klasse */
+static void tone_stop(const tone_env_t *env)
+{
+    uint32_t release_us = env_ramp_us(env->release_ms * 1000u, tone.level, tone.frequency);
+    int64_t now = esp_timer_get_time();
+
+    if (!tone.playing)
+        return;
+
+    buzzer_fade_stop();
+    if (!env_release(&tone.plan, tone.level, tone.frequency, release_us))
+    {
+        tone_end();
+        voice_select(now);
+        return;
+    }
+
+    tone.start_us = now;
+    tone.deadline_us = now + release_us;
+    env_run(now);
+}
+
+static void seq_stop(seq_prio_t prio)
+{
+    seq_voice_t *v = &voices[prio];
+
+    v->active = false;
+    v->has_next = false;
+
+    // Wartende Stimmen verschwinden still, die klingende mit ihrer Release
+    if (owner != (int)prio)
+        return;
+    owner = -1;
+    tone_stop(&v->env);
+}
+
+static void seq_play(const seq_cmd_t *cmd)
+{
+    seq_voice_t *v = &voices[cmd->prio];
+
+    if (cmd->chain && v->active)
+    {
+        v->next = *cmd;
+        v->has_next = true;
+        return;
+    }
+
+    if (!voice_load(v, cmd))
+    {
+        seq_stop(cmd->prio);
+        return;
+    }
+    v->active = true;
+    v->has_next = false;
+
+    // Höhere Klasse belegt (oder deren Release läuft): warten
+    if (voice_top() != (int)cmd->prio)
+        return;
+
+    if (owner >= 0 && owner != (int)cmd->prio)
+        voice_preempt(esp_timer_get_time());
+    if (!voice_select(esp_timer_get_time()))
+        tone_stop(&default_env); // leere Quelle
+}
+
+static void seq_handle_cmd(const seq_cmd_t *cmd)
+{
+    switch (cmd->type)
+    {
+    case SEQ_CMD_TONE:
+    case SEQ_CMD_SONG:
+    case SEQ_CMD_MIDI:
+        seq_play(cmd);
+        break;
+
+    case SEQ_CMD_STOP:
+        seq_stop(cmd->prio);
+        break;
+
+    case SEQ_CMD_VOLUME:
+        peak_duty = volume_duty(cmd->volume); // ab dem nächsten Ton
+        break;
+
+    case SEQ_CMD_ENVELOPE:
+        default_env = cmd->env;
+        break;
+    }
+}
+
+/**
+ * seq_boundary - fällige Notengrenze abarbeiten
+ *
+ * Der nächste Ton beginnt an der geplanten Deadline, nicht "jetzt": so
+ * summieren sich Verzögerungen von Timer und Task nicht über das Lied auf.
+ */
+static void seq_boundary(int64_t now)
+{
+    // Veraltet: inzwischen gestoppt oder per PlayTone neu gestartet
+    if (!tone.playing || now < tone.deadline_us)
+        return;
+
+    int64_t err = now - tone.deadline_us;
+    tone_timing.boundaries++;
+    tone_timing.total_abs_err_us += err;
+    if (err > tone_timing.max_abs_err_us)
+        tone_timing.max_abs_err_us = err;
+
+    // Nächster Schritt der Klasse oder die nächstniedrigere, ohne Lücke ab der Deadline
+    if (owner >= 0)
+        voices[owner].has_step = false;
+    if (voice_select(tone.deadline_us))
+        return;
+
+    // Alles fertig, die Release ist schon durch; sonst harter Schnitt
+    if (tone.level > 0)
+        prof_tone_edge(PROF_TONE_STOP, err);
+    tone_end();
+}
+
+static void sequencer_task_fn(void *arg)
+{
+    seq_cmd_t cmd;
+
+    (void)arg;
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Erst neue Kommandos, dann die Grenze: ein PlayTone ersetzt sie.
+        // Eine laufende Rampe bricht buzzer_fade_stop() ab.
+        while (spsc_pop(&cmds, &cmd))
+        {
+            uint32_t t0 = prof_begin();
+            seq_handle_cmd(&cmd);
+            prof_end(PROF_SEQ_CMD, t0);
+        }
+
+        uint32_t t0 = prof_begin();
+        int64_t now = esp_timer_get_time();
+        env_run(now);
+        seq_boundary(now);
+        seq_schedule();
+        prof_end(PROF_SEQ_TICK, t0);
+    }
+}
+
+/* esp_timer-Task (Core 0): nur wecken, die Arbeit macht der Sequenzer-Task */
+static void tone_timer_cb(void *arg)
+{
+    (void)arg;
+    xTaskNotifyGive(seq_task);
+}
+
+void buzzer_init(void)
+{
+    const esp_timer_create_args_t args = {
+        .callback = tone_timer_cb,
+        .name = "tone",
+    };
+
+    spsc_init(&cmds, cmd_buf, sizeof(cmd_buf[0]), SEQ_CMD_QUEUE_LEN);
+    esp_timer_create(&args, &tone_timer);
+    peak_duty = volume_duty(BUZZER_VOLUME_DEFAULT);
+    tone.res = BUZZER_PWM_RES; // wie in init_buzzer_pins() konfiguriert
+
+    xTaskCreatePinnedToCore(sequencer_task_fn, "seq", SEQ_TASK_STACK, NULL,
+                            SEQ_TASK_PRIO, &seq_task, SEQ_TASK_CORE);
+}
+
+static void seq_post(const seq_cmd_t *cmd)
+{
+    if (!spsc_push(&cmds, cmd))
+    {
+        cmd_dropped++;
+        DLOGW(DLOG_SEQ, "command queue full");
+        return;
+    }
+
+    xTaskNotifyGive(seq_task);
+}
+
+/**
+ * PlayTone - spielt einen Ton auf dem passiven Buzzer
+ * @prio: Klasse, ersetzt deren laufenden Auftrag
+ * @freq_hz: Frequenz in Hz, 0 = Pause
+ * @duration_ms: Dauer in Millisekunden
+ *
+ * Non-blocking: Ton wird vom One-Shot-Timer auf die µs genau gestoppt.
+ * Verdrängte Musik geht danach mit dem Rest ihrer Note weiter.
+ */
+void PlayTone(seq_prio_t prio, uint32_t freq_hz, uint32_t duration_ms)
+{
+    seq_post(&(seq_cmd_t){.type = SEQ_CMD_TONE, .prio = prio, .freq_hz = freq_hz,
+                          .duration_ms = duration_ms});
+}
+
+/**
+ * PlayToneSequence - spielt einen gepackten Song ab
+ * @prio: Klasse, ersetzt deren laufenden Auftrag
+ * @song: wird kopiert, @song->data muss bis zum Ende gültig bleiben (Flash)
+ *
+ * Kopiert keine Noten: der Sequenzer dekodiert die Schritte beim Abspielen.
+ * Bringt der Song keine Hüllkurve mit, gilt die von buzzer_set_envelope().
+ */
+void PlayToneSequence(seq_prio_t prio, const song_t *song)
+{
+    seq_post(&(seq_cmd_t){.type = SEQ_CMD_SONG, .prio = prio, .song = *song});
+}
+
+/**
+ * ChainToneSequence - Song an die Klasse @prio anhängen
+ *
+ * Beginnt an der letzten Notengrenze des laufenden Auftrags der Klasse,
+ * ohne Lücke; ist die Klasse frei, wie PlayToneSequence(). Es wartet
+ * höchstens ein Song, ein weiterer ersetzt ihn.
+ */
+void ChainToneSequence(seq_prio_t prio, const song_t *song)
+{
+    seq_post(&(seq_cmd_t){.type = SEQ_CMD_SONG, .prio = prio, .chain = true, .song = *song});
+}
+
+/**
+ * PlayMidiFile - spielt ein Standard MIDI File einstimmig ab
+ * @prio: Klasse, ersetzt deren laufenden Auftrag
+ * @data: SMF-Datei, muss bis zum Ende gültig bleiben (gemappter Flash)
+ * @size: Bytes ab @data, die Datei darf kürzer sein
+ *
+ * Wie PlayToneSequence(): gestreamt, der Parser hält nur die Lesezeiger.
+ */
+void PlayMidiFile(seq_prio_t prio, const uint8_t *data, size_t size)
+{
+    seq_post(&(seq_cmd_t){.type = SEQ_CMD_MIDI, .prio = prio, .midi = data, .midi_size = size});
+}
+
+/* Beendet den Auftrag der Klasse @prio; klingt er, mit der Release seiner Hüllkurve */
+void StopToneSequence(seq_prio_t prio)
+{
+    seq_post(&(seq_cmd_t){.type = SEQ_CMD_STOP, .prio = prio});
+}
+
+void buzzer_set_volume(uint8_t percent)
+{
+    seq_post(&(seq_cmd_t){.type = SEQ_CMD_VOLUME, .volume = percent});
+}
+
+void buzzer_set_envelope(const tone_env_t *env)
+{
+    seq_post(&(seq_cmd_t){.type = SEQ_CMD_ENVELOPE, .env = *env});
+}
+
+const tone_timing_t *Tone_timing_stats(void)
+{
+    return &tone_timing;
+}
+
+uint32_t sequencer_dropped(void)
+{
+    return cmd_dropped;
+}
+
+TaskHandle_t sequencer_task(void)
+{
+    return seq_task;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/ledc.h"
+
+#include "songfmt.h"
+
+/*
+ * Buzzer-Sequenzer in einem eigenen Task auf Core 1.
+ *
+ * Der Task besitzt den Ton- und Sequenzzustand allein. PlayTone(),
+ * PlayToneSequence() und StopToneSequence() legen nur ein Kommando in eine
+ * lock-freie SPSC-Queue (spsc.h) und wecken den Task; sie dürfen deshalb
+ * nur aus einem Task aufgerufen werden, dem UI-Task (app_main). Die
+ * Notengrenzen kommen vom esp_timer, der den Task ebenfalls nur weckt.
+ *
+ * Jeder Auftrag gehört zu einer Prioritätsklasse (seq_prio_t), pro Klasse
+ * gibt es eine Stimme. Es klingt immer die höchste belegte Klasse:
+ *  - Ein Auftrag ersetzt die Stimme seiner Klasse. Ist eine höhere Klasse
+ *    belegt, wartet er, bis sie frei wird.
+ *  - Eine höhere Klasse verdrängt die klingende. Musik setzt danach mit dem
+ *    Rest der unterbrochenen Note fort, ein Effekt wird verworfen.
+ *  - Wird eine Klasse frei, übernimmt die nächstniedrigere ohne Lücke an
+ *    der Notengrenze. ChainToneSequence() hängt genauso an die eigene
+ *    Klasse an: das Intro läuft direkt in das Lied.
+ * Alles entscheidet der Sequenzer-Task an Notengrenzen und Kommandos,
+ * deterministisch und im Host-Simulator nachprüfbar.
+ *
+ * Jeder Ton bekommt eine ADSR-Hüllkurve aus LEDC-Hardware-Rampen
+ * (envelope.h): kein Knacken an den Notengrenzen, und der Task startet pro
+ * Ton nur bis zu drei Rampen statt die Duty selbst zu stufen.
+ */
+
+/* Buzzer-PWM, siehe init_buzzer_pins() in playbox.c. Jeder Ton stellt
+ * Teiler und Auflösung neu (note_timer.h); Duty-Werte hier gelten für
+ * BUZZER_PWM_RES */
+#define BUZZER_PWM_FREQ_HZ 2000
+#define BUZZER_PWM_RES LEDC_TIMER_10_BIT
+#define BUZZER_LEDC_MODE LEDC_HIGH_SPEED_MODE // APB-Takt, unabhängig vom RTC8M der LEDs
+#define BUZZER_LEDC_CHANNEL LEDC_CHANNEL_0
+#define BUZZER_LEDC_TIMER LEDC_TIMER_0
+
+#define BUZZER_DUTY_MAX 512      // 50 % Duty: lautester Rechteckton
+#define BUZZER_VOLUME_DEFAULT 50 // Prozent, ergibt die frühere feste Duty von 128
+
+/* Für PlayTone(), SMF und Songs ohne eigene Hüllkurve: nur entknacken. Eine
+ * Rampe braucht einige Schwingungen, bei C4 (262 Hz) sind das ~4 ms pro Stufe */
+#define BUZZER_ENV_DEFAULT ((tone_env_t){.attack_ms = 8, .decay_ms = 0, .sustain = 255, .release_ms = 16})
+
+typedef enum
+{
+    SEQ_PRIO_MUSIC = 0, // Lieder, MIDI-Dateien, Live-Noten; verdrängt: fortsetzen
+    SEQ_PRIO_SFX,       // Tasten, Quiz-Gewinner; verdrängt: verworfen
+    SEQ_PRIO_CHIME,     // Start- und Mode-Melodien, werden nie verdrängt
+    SEQ_PRIO_COUNT
+} seq_prio_t;
+
+/* Abweichung der tatsächlichen von den geplanten Notengrenzen */
+typedef struct
+{
+    uint32_t boundaries;      // gemessene Notengrenzen
+    int64_t total_abs_err_us; // Summe |ist - soll|
+    int64_t max_abs_err_us;
+} tone_timing_t;
+
+/* Sequenzer-Task starten; vor dem ersten PlayTone() aufrufen */
+void buzzer_init(void);
+
+void PlayTone(seq_prio_t prio, uint32_t freq_hz, uint32_t duration_ms);
+void PlayToneSequence(seq_prio_t prio, const song_t *song);
+void ChainToneSequence(seq_prio_t prio, const song_t *song);
+void PlayMidiFile(seq_prio_t prio, const uint8_t *data, size_t size);
+void StopToneSequence(seq_prio_t prio);
+
+/* Lautstärke 0..100 %, gilt ab dem nächsten Ton */
+void buzzer_set_volume(uint8_t percent);
+
+/* Hüllkurve für PlayTone(), PlayMidiFile() und Songs ohne eigene */
+void buzzer_set_envelope(const tone_env_t *env);
+
+/* Gemessen im Sequenzer-Task: enthält also auch dessen Aufweck-Latenz */
+const tone_timing_t *Tone_timing_stats(void);
+
+/* Verworfene Kommandos, weil die Queue voll war */
+uint32_t sequencer_dropped(void);
+
+/* Für uxTaskGetStackHighWaterMark() */
+TaskHandle_t sequencer_task(void);
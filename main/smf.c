@@ -0,0 +1,376 @@
+#include <string.h>
+
+#include "smf.h"
+#include "songfmt.h"
+
+static uint32_t be16(const uint8_t *p)
+{
+    return (uint32_t)p[0] << 8 | p[1];
+}
+
+static uint32_t be32(const uint8_t *p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+/* Variable-Length Quantity, höchstens 4 Bytes (28 Bit) */
+static bool smf_vlq(const uint8_t **pos, const uint8_t *end, uint32_t *out)
+{
+    uint32_t v = 0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (*pos >= end)
+            return false;
+
+        uint8_t b = *(*pos)++;
+        v = (v << 7) | (b & 0x7f);
+        if (!(b & 0x80))
+        {
+            *out = v;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t smf_size(const uint8_t *data, size_t avail)
+{
+    if (avail < 14 || memcmp(data, "MThd", 4) != 0)
+        return 0;
+
+    uint32_t hlen = be32(data + 4);
+    uint32_t ntracks = be16(data + 10);
+
+    if (hlen < 6 || hlen > avail - 8)
+        return 0;
+
+    size_t off = 8 + (size_t)hlen;
+
+    // Unbekannte Chunks sind erlaubt und zählen nicht als Track
+    while (ntracks > 0)
+    {
+        if (off + 8 > avail)
+            return 0;
+
+        uint32_t len = be32(data + off + 4);
+        if (len > avail - off - 8) // ohne Überlauf auf 32 Bit
+            return 0;
+
+        if (memcmp(data + off, "MTrk", 4) == 0)
+            ntracks--;
+
+        off += 8 + (size_t)len;
+    }
+
+    return off;
+}
+
+/* Delta bis zum nächsten Event lesen; Trackende oder Fehler beendet den Track */
+static void smf_track_advance(smf_track_t *tr)
+{
+    uint32_t delta;
+
+    if (tr->pos >= tr->end || !smf_vlq(&tr->pos, tr->end, &delta))
+    {
+        tr->done = true;
+        return;
+    }
+
+    tr->tick += delta;
+}
+
+/* Trackname am Anfang des ersten Tracks suchen (nur Meta-Events bei Tick 0) */
+static void smf_find_name(smf_t *smf)
+{
+    const uint8_t *p = smf->tracks[0].pos;
+    const uint8_t *end = smf->tracks[0].end;
+
+    smf->name = NULL;
+    smf->name_len = 0;
+
+    if (smf->tracks[0].done || smf->tracks[0].tick != 0)
+        return;
+
+    while (end - p >= 2 && p[0] == 0xff)
+    {
+        uint8_t type = p[1];
+        uint32_t len;
+
+        p += 2;
+        if (!smf_vlq(&p, end, &len) || len > (uint32_t)(end - p))
+            return;
+
+        if (type == 0x03)
+        {
+            smf->name = (const char *)p;
+            smf->name_len = len > 255 ? 255 : (uint8_t)len;
+            return;
+        }
+
+        p += len;
+
+        uint32_t delta;
+        if (!smf_vlq(&p, end, &delta) || delta != 0)
+            return;
+    }
+}
+
+bool smf_open(smf_t *smf, const uint8_t *data, size_t size)
+{
+    size_t total = smf_size(data, size);
+    if (total == 0)
+        return false;
+
+    uint32_t hlen = be32(data + 4);
+    smf->format = (uint16_t)be16(data + 8);
+    smf->ntracks = (uint16_t)be16(data + 10);
+    smf->division = (uint16_t)be16(data + 12);
+
+    // Format 2 (unabhängige Sequenzen) und SMPTE-Zeitbasis nicht unterstützt
+    if (smf->format > 1 || (smf->division & 0x8000) || smf->division == 0 ||
+        smf->ntracks == 0 || smf->ntracks > SMF_MAX_TRACKS)
+        return false;
+
+    size_t off = 8 + (size_t)hlen;
+    for (int t = 0; t < smf->ntracks; off += 8 + be32(data + off + 4))
+    {
+        if (memcmp(data + off, "MTrk", 4) != 0)
+            continue;
+
+        smf_track_t *tr = &smf->tracks[t++];
+        tr->pos = data + off + 8;
+        tr->end = tr->pos + be32(data + off + 4);
+        tr->tick = 0;
+        tr->running = 0;
+        tr->done = false;
+        smf_track_advance(tr);
+    }
+
+    smf->tempo_us = SMF_DEFAULT_TEMPO_US;
+    smf->tempo_tick = 0;
+    smf->tempo_base_us = 0;
+    smf_find_name(smf);
+    return true;
+}
+
+/**
+ * smf_track_read - ein Event des Tracks lesen
+ *
+ * Gibt true zurück, wenn @ev ein für die Wiedergabe relevantes Event ist;
+ * alles andere wird überlesen. Fehlerhafte Daten beenden den Track.
+ */
+static bool smf_track_read(smf_track_t *tr, smf_event_t *ev)
+{
+    uint8_t status;
+    bool relevant = false;
+    uint32_t len;
+
+    ev->tick = tr->tick;
+
+    if (tr->pos >= tr->end)
+        goto bad; // Delta ohne Event
+
+    status = *tr->pos;
+    if (status & 0x80)
+        tr->pos++;
+    else if (tr->running)
+        status = tr->running; // Running Status: Datenbyte folgt direkt
+    else
+        goto bad;
+
+    if (status == 0xff)
+    {
+        if (tr->pos >= tr->end)
+            goto bad;
+
+        uint8_t type = *tr->pos++;
+        if (!smf_vlq(&tr->pos, tr->end, &len) || len > (uint32_t)(tr->end - tr->pos))
+            goto bad;
+
+        if (type == 0x51 && len == 3)
+        {
+            ev->type = SMF_EV_TEMPO;
+            ev->tempo_us = (uint32_t)tr->pos[0] << 16 | (uint32_t)tr->pos[1] << 8 | tr->pos[2];
+            relevant = ev->tempo_us > 0;
+        }
+        else if (type == 0x2f)
+        {
+            ev->type = SMF_EV_END;
+            tr->done = true;
+            return true;
+        }
+
+        tr->pos += len;
+        tr->running = 0;
+    }
+    else if (status == 0xf0 || status == 0xf7)
+    {
+        // Sysex: nur überspringen
+        if (!smf_vlq(&tr->pos, tr->end, &len) || len > (uint32_t)(tr->end - tr->pos))
+            goto bad;
+
+        tr->pos += len;
+        tr->running = 0;
+    }
+    else if (status >= 0xf0)
+    {
+        goto bad; // System-Common/Realtime gibt es in SMF nicht
+    }
+    else
+    {
+        int n = (status & 0xe0) == 0xc0 ? 1 : 2; // Program Change/Channel Pressure: ein Datenbyte
+        if (tr->end - tr->pos < n)
+            goto bad;
+
+        uint8_t d1 = tr->pos[0];
+        uint8_t d2 = n == 2 ? tr->pos[1] : 0;
+        tr->pos += n;
+        tr->running = status;
+
+        uint8_t kind = status & 0xf0;
+        if (kind == 0x90 || kind == 0x80)
+        {
+            ev->type = kind == 0x90 && d2 > 0 ? SMF_EV_NOTE_ON : SMF_EV_NOTE_OFF;
+            ev->channel = status & 0x0f;
+            ev->note = d1 & 0x7f;
+            ev->velocity = d2 & 0x7f;
+            relevant = true;
+        }
+    }
+
+    smf_track_advance(tr);
+    return relevant;
+
+bad:
+    tr->done = true;
+    return false;
+}
+
+bool smf_next_event(smf_t *smf, smf_event_t *ev)
+{
+    for (;;)
+    {
+        smf_track_t *next = NULL;
+
+        for (int t = 0; t < smf->ntracks; t++)
+        {
+            smf_track_t *tr = &smf->tracks[t];
+            if (!tr->done && (!next || tr->tick < next->tick))
+                next = tr;
+        }
+
+        if (!next)
+            return false;
+
+        if (!smf_track_read(next, ev))
+            continue;
+
+        if (ev->type == SMF_EV_TEMPO)
+        {
+            smf->tempo_base_us = smf_tick_us(smf, ev->tick);
+            smf->tempo_tick = ev->tick;
+            smf->tempo_us = ev->tempo_us;
+        }
+
+        return true;
+    }
+}
+
+uint64_t smf_tick_us(const smf_t *smf, uint32_t tick)
+{
+    return smf->tempo_base_us + (uint64_t)(tick - smf->tempo_tick) * smf->tempo_us / smf->division;
+}
+
+/* ===================== Einstimmig ===================== */
+
+static int smf_mono_top(const smf_mono_t *mono)
+{
+    for (int w = 3; w >= 0; w--)
+    {
+        if (mono->held[w])
+            return w * 32 + 31 - __builtin_clz(mono->held[w]);
+    }
+
+    return -1;
+}
+
+bool smf_mono_init(smf_mono_t *mono, const uint8_t *data, size_t size)
+{
+    if (!smf_open(&mono->smf, data, size))
+        return false;
+
+    memset(mono->held, 0, sizeof(mono->held));
+    mono->note = -1;
+    mono->start_us = 0;
+    mono->last_us = 0;
+    mono->have_next = smf_next_event(&mono->smf, &mono->next);
+    return true;
+}
+
+static void smf_mono_step(const smf_mono_t *mono, uint64_t end_us, tone_step_t *step)
+{
+    step->freq_hz = mono->note < 0 ? 0 : song_note_hz((uint8_t)mono->note);
+    step->duration_ms = (uint32_t)((end_us + 500) / 1000 - (mono->start_us + 500) / 1000);
+}
+
+bool smf_mono_next(smf_mono_t *mono, tone_step_t *step)
+{
+    while (mono->have_next)
+    {
+        uint32_t tick = mono->next.tick;
+        uint32_t struck[4] = {0}; // in diesem Tick angeschlagen
+
+        // Vor dem Weiterlesen: ein vorausgelesenes Tempo-Event gilt erst später
+        uint64_t now_us = smf_tick_us(&mono->smf, tick);
+
+        // Alle Events eines Ticks zusammen anwenden (Note-Off + Note-On = Tonwechsel)
+        do
+        {
+            const smf_event_t *ev = &mono->next;
+            uint32_t bit = 1u << (ev->note & 31);
+
+            if (ev->type == SMF_EV_NOTE_ON && ev->channel != SMF_DRUM_CHANNEL)
+            {
+                mono->held[ev->note >> 5] |= bit;
+                struck[ev->note >> 5] |= bit;
+            }
+            else if (ev->type == SMF_EV_NOTE_OFF && ev->channel != SMF_DRUM_CHANNEL)
+            {
+                mono->held[ev->note >> 5] &= ~bit;
+            }
+
+            mono->have_next = smf_next_event(&mono->smf, &mono->next);
+        } while (mono->have_next && mono->next.tick == tick);
+
+        int top = smf_mono_top(mono);
+        bool retrigger = top >= 0 && (struck[top >> 5] >> (top & 31) & 1);
+
+        mono->last_us = now_us;
+
+        if (now_us == mono->start_us)
+        {
+            mono->note = top; // Beginn des Stücks oder gleichzeitige Events
+            continue;
+        }
+
+        if (top == mono->note && !retrigger)
+            continue;
+
+        smf_mono_step(mono, now_us, step);
+        mono->note = top;
+        mono->start_us = now_us;
+        return true;
+    }
+
+    // Dateiende: offenen Schritt bis zum letzten Event ausgeben
+    if (mono->last_us > mono->start_us)
+    {
+        smf_mono_step(mono, mono->last_us, step);
+        mono->start_us = mono->last_us;
+        return true;
+    }
+
+    return false;
+}
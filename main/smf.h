@@ -0,0 +1,117 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "songs.h"
+
+/*
+ * Streaming-Parser für Standard MIDI Files (Format 0 und 1).
+ *
+ * Reine Logik ohne Hardwarezugriff: liest direkt aus dem gemappten Flash
+ * (esp_partition_mmap) bzw. auf dem Host aus einem Puffer. Pro Track wird
+ * nur ein Lesezeiger, der nächste Tick und der Running Status gehalten,
+ * der RAM-Bedarf hängt also nur von SMF_MAX_TRACKS ab, nicht von der
+ * Dateigröße.
+ *
+ * Unterstützt: variable Delta-Zeiten, Running Status, Tempo-Meta-Events
+ * (auch mitten im Stück), Note-On mit Velocity 0 als Note-Off. Sysex und
+ * übrige Meta-Events werden übersprungen, SMPTE-Zeitbasis abgelehnt.
+ */
+
+#define SMF_MAX_TRACKS 16
+#define SMF_DEFAULT_TEMPO_US 500000 // 120 BPM, bis zum ersten Tempo-Event
+#define SMF_DRUM_CHANNEL 9          // Kanal 10: Schlagzeug, kein Ton für den Buzzer
+
+typedef enum
+{
+    SMF_EV_NOTE_ON,
+    SMF_EV_NOTE_OFF,
+    SMF_EV_TEMPO,
+    SMF_EV_END, // Track-Ende (Meta 0x2F), tick = Länge des Tracks
+} smf_event_type_t;
+
+typedef struct
+{
+    uint32_t tick; // absolut
+    smf_event_type_t type;
+    uint8_t channel;
+    uint8_t note;
+    uint8_t velocity;
+    uint32_t tempo_us; // SMF_EV_TEMPO: µs pro Viertel
+} smf_event_t;
+
+typedef struct
+{
+    const uint8_t *pos;
+    const uint8_t *end;
+    uint32_t tick;   // Zeitpunkt des nächsten Events
+    uint8_t running; // Running Status, 0 = keiner
+    bool done;
+} smf_track_t;
+
+typedef struct
+{
+    uint16_t format;
+    uint16_t ntracks;
+    uint16_t division; // Ticks pro Viertel
+    const char *name;  // Trackname (Meta 0x03) des ersten Tracks, nicht nullterminiert
+    uint8_t name_len;
+    smf_track_t tracks[SMF_MAX_TRACKS];
+
+    // Tempo-Segment: Zeit von Tick tempo_tick, ab dort gilt tempo_us
+    uint32_t tempo_us;
+    uint32_t tempo_tick;
+    uint64_t tempo_base_us;
+} smf_t;
+
+/**
+ * smf_size - Länge einer SMF-Datei am Anfang von @data
+ * @avail: Bytes bis zum Ende des Speichers
+ *
+ * Läuft nur über die Chunk-Header. Gibt 0 zurück, wenn dort keine
+ * vollständige SMF-Datei beginnt; so lassen sich hintereinander abgelegte
+ * Dateien durchlaufen.
+ */
+size_t smf_size(const uint8_t *data, size_t avail);
+
+/* Header prüfen und alle Tracks auf ihr erstes Event setzen */
+bool smf_open(smf_t *smf, const uint8_t *data, size_t size);
+
+/**
+ * smf_next_event - nächstes Event über alle Tracks in Zeitreihenfolge
+ *
+ * Bei gleichem Tick kommt der Track mit dem kleineren Index zuerst, damit
+ * Tempo-Events der Dirigentenspur vor den Noten gelten. Tempo-Events
+ * werden schon hier übernommen. false am Ende aller Tracks.
+ */
+bool smf_next_event(smf_t *smf, smf_event_t *ev);
+
+/* Absolute Zeit von @tick in µs; @tick darf nicht vor dem letzten Tempo-Event liegen */
+uint64_t smf_tick_us(const smf_t *smf, uint32_t tick);
+
+/*
+ * Einstimmige Wiedergabe für den Buzzer: zu jedem Zeitpunkt klingt die
+ * höchste gehaltene Note, ein erneuter Anschlag beginnt einen neuen Schritt.
+ */
+typedef struct
+{
+    smf_t smf;
+    uint32_t held[4];  // 128 Bit: gehaltene Noten
+    int note;          // aktuelle Note, -1 = Pause
+    uint64_t start_us; // Beginn des aktuellen Schritts
+    uint64_t last_us;  // Zeit des zuletzt verarbeiteten Ticks
+    smf_event_t next;  // vorausgelesenes Event
+    bool have_next;
+} smf_mono_t;
+
+bool smf_mono_init(smf_mono_t *mono, const uint8_t *data, size_t size);
+
+/**
+ * smf_mono_next - nächsten Schritt (Ton oder Pause) für den Sequenzer
+ *
+ * Dauern werden aus absoluten Zeiten gerundet, Rundungsfehler summieren
+ * sich also nicht. Gibt false zurück, wenn die Datei zu Ende ist.
+ */
+bool smf_mono_next(smf_mono_t *mono, tone_step_t *step);
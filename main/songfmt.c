@@ -0,0 +1,91 @@
+#include "songfmt.h"
+
+/* round(440 * 2^((n - 69) / 12)), muss zu tools/songpack.py passen */
+static const uint16_t note_hz[128] = {
+        8,     9,     9,    10,    10,    11,    12,    12,    13,    14,    15,    15,
+       16,    17,    18,    19,    21,    22,    23,    24,    26,    28,    29,    31,
+       33,    35,    37,    39,    41,    44,    46,    49,    52,    55,    58,    62,
+       65,    69,    73,    78,    82,    87,    92,    98,   104,   110,   117,   123,
+      131,   139,   147,   156,   165,   175,   185,   196,   208,   220,   233,   247,
+      262,   277,   294,   311,   330,   349,   370,   392,   415,   440,   466,   494,
+      523,   554,   587,   622,   659,   698,   740,   784,   831,   880,   932,   988,
+     1047,  1109,  1175,  1245,  1319,  1397,  1480,  1568,  1661,  1760,  1865,  1976,
+     2093,  2217,  2349,  2489,  2637,  2794,  2960,  3136,  3322,  3520,  3729,  3951,
+     4186,  4435,  4699,  4978,  5274,  5588,  5920,  6272,  6645,  7040,  7459,  7902,
+     8372,  8870,  9397,  9956, 10548, 11175, 11840, 12544,
+};
+
+uint16_t song_note_hz(uint8_t note)
+{
+    if (note == SONG_NOTE_REST || note >= 128)
+        return 0;
+
+    return note_hz[note];
+}
+
+uint8_t song_hz_note(uint32_t hz)
+{
+    int lo = 1;
+    int hi = 127;
+
+    // Erste Note mit note_hz >= hz, die Tabelle steigt monoton
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (note_hz[mid] < hz)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return note_hz[lo] == hz ? (uint8_t)lo : 0;
+}
+
+static bool song_has_env(const song_t *song)
+{
+    return song->words > SONG_ENV_WORDS && (song->data[0] & SONG_HDR_ENV);
+}
+
+void song_cursor_init(song_cursor_t *cur, const song_t *song)
+{
+    cur->pos = song->data + 1 + (song_has_env(song) ? SONG_ENV_WORDS : 0);
+    cur->end = song->data + song->words;
+    cur->unit_ms = song->words > 0 ? song->data[0] & SONG_HDR_UNIT_MASK : 0;
+}
+
+bool song_envelope(const song_t *song, tone_env_t *env)
+{
+    if (!song_has_env(song))
+        return false;
+
+    env->attack_ms = song->data[1] >> 8;
+    env->decay_ms = song->data[1] & 0xff;
+    env->sustain = song->data[2] >> 8;
+    env->release_ms = song->data[2] & 0xff;
+    return true;
+}
+
+bool song_cursor_next(song_cursor_t *cur, tone_step_t *step)
+{
+    if (cur->pos >= cur->end)
+        return false;
+
+    uint16_t word = *cur->pos++;
+    uint8_t note = word >> SONG_NOTE_SHIFT;
+
+    step->duration_ms = (uint32_t)(word & SONG_DUR_MASK) * cur->unit_ms;
+
+    if (note == SONG_NOTE_RAW_HZ)
+    {
+        if (cur->pos >= cur->end)
+            return false; // abgeschnittener Song
+
+        step->freq_hz = *cur->pos++;
+    }
+    else
+    {
+        step->freq_hz = song_note_hz(note);
+    }
+
+    return true;
+}
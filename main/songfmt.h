@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "songs.h"
+
+/*
+ * Gepacktes Songformat, 16 Bit pro Schritt.
+ *
+ *   data[0]        Tempo-Header: Bit 11..0 Länge einer Dauer-Einheit in ms,
+ *                  Bit 15 (SONG_HDR_ENV): Hüllkurve folgt
+ *   [data[1..2]]   Hüllkurve: Attack << 8 | Decay, Sustain << 8 | Release
+ *   data[..n]      Schritte: Bit 15..9 Note, Bit 8..0 Dauer in Einheiten
+ *
+ * Note 1..126 ist die MIDI-Notennummer (A4 = 69 = 440 Hz, gleichstufig),
+ * SONG_NOTE_REST ist eine Pause, SONG_NOTE_RAW_HZ kündigt ein zusätzliches
+ * Wort mit der Frequenz in Hz an (für Töne neben dem Halbtonraster).
+ *
+ * Erzeugt wird das Format zur Build-Zeit von tools/songpack.py aus songs.c,
+ * die Hüllkurve aus einem tone_env_t NAME_env neben der Tabelle NAME.
+ */
+
+#define SONG_NOTE_SHIFT 9
+#define SONG_DUR_MASK 0x1ff
+#define SONG_NOTE_REST 0
+#define SONG_NOTE_RAW_HZ 127
+
+#define SONG_HDR_ENV 0x8000
+#define SONG_HDR_UNIT_MASK 0x0fff
+#define SONG_ENV_WORDS 2
+
+#define SONG_STEP(note, units) ((uint16_t)(((note) << SONG_NOTE_SHIFT) | (units)))
+
+typedef struct
+{
+    const uint16_t *data; // Header + Schritte, liegt im Flash
+    uint16_t words;       // Länge von data inkl. Header
+} song_t;
+
+/* Lesezeiger in einen gepackten Song; dekodiert einen Schritt pro Aufruf */
+typedef struct
+{
+    const uint16_t *pos;
+    const uint16_t *end;
+    uint16_t unit_ms;
+} song_cursor_t;
+
+/* Frequenz einer MIDI-Note in Hz (gerundet), 0 für Note 0 */
+uint16_t song_note_hz(uint8_t note);
+
+/**
+ * song_hz_note - MIDI-Note zu einer Frequenz aus song_note_hz()
+ *
+ * Gibt 0 zurück, wenn @hz keine gerundete Notenfrequenz ist. Unter ~20 Hz
+ * runden Nachbarnoten auf dieselbe Frequenz, dann gilt die tiefere.
+ */
+uint8_t song_hz_note(uint32_t hz);
+
+void song_cursor_init(song_cursor_t *cur, const song_t *song);
+
+/* Hüllkurve aus dem Header, false wenn der Song keine mitbringt */
+bool song_envelope(const song_t *song, tone_env_t *env);
+
+/**
+ * song_cursor_next - nächsten Schritt dekodieren
+ * @step: Ausgabe, freq_hz 0 = Pause
+ *
+ * Gibt false zurück, wenn der Song zu Ende ist.
+ */
+bool song_cursor_next(song_cursor_t *cur, tone_step_t *step);
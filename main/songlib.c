@@ -0,0 +1,96 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+
+#include "songlib.h"
+
+static const char *TAG = "SONGLIB";
+
+static const uint8_t *image = NULL;
+static const songlib_index_t *lib_index = NULL;
+static int lib_count = 0;
+
+/* Einmal beim Start: danach wird jedem Indexeintrag vertraut */
+static bool songlib_check(const uint8_t *base, uint32_t part_size)
+{
+    const songlib_header_t *hdr = (const songlib_header_t *)base;
+
+    if (hdr->magic != SONGLIB_MAGIC || hdr->version != SONGLIB_VERSION)
+        return false;
+
+    if (hdr->size > part_size || hdr->index_off % 4 != 0 ||
+        hdr->index_off + (uint32_t)hdr->count * sizeof(songlib_index_t) > hdr->size)
+        return false;
+
+    const songlib_index_t *idx = (const songlib_index_t *)(base + hdr->index_off);
+    for (int i = 0; i < hdr->count; i++)
+    {
+        if (idx[i].offset % 4 != 0 || idx[i].offset > hdr->size ||
+            idx[i].length > hdr->size - idx[i].offset || idx[i].name_len > SONGLIB_NAME_LEN ||
+            idx[i].kind > SONGLIB_KIND_SMF)
+            return false;
+
+        // song_t zählt 16-Bit-Wörter in einem uint16_t
+        if (idx[i].kind == SONGLIB_KIND_PACKED && (idx[i].length % 2 != 0 || idx[i].length / 2 > UINT16_MAX))
+            return false;
+    }
+
+    return true;
+}
+
+void songlib_init(void)
+{
+    const esp_partition_t *part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, SONGLIB_PARTITION_SUBTYPE, SONGLIB_PARTITION_LABEL);
+    if (!part)
+    {
+        ESP_LOGW(TAG, "no \"%s\" partition", SONGLIB_PARTITION_LABEL);
+        return;
+    }
+
+    // Bleibt für die ganze Laufzeit gemappt, das Handle wird nicht gebraucht
+    const void *ptr;
+    spi_flash_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &ptr, &handle);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "mmap failed: %s", esp_err_to_name(err));
+        return;
+    }
+
+    if (!songlib_check(ptr, part->size))
+    {
+        ESP_LOGW(TAG, "no valid library in \"%s\"", SONGLIB_PARTITION_LABEL);
+        return;
+    }
+
+    const songlib_header_t *hdr = ptr;
+    image = ptr;
+    lib_index = (const songlib_index_t *)(image + hdr->index_off);
+    lib_count = hdr->count;
+
+    ESP_LOGI(TAG, "%d songs, %u of %u bytes", lib_count, (unsigned)hdr->size, (unsigned)part->size);
+}
+
+int songlib_count(void)
+{
+    return lib_count;
+}
+
+bool songlib_get(int id, songlib_entry_t *entry)
+{
+    if (id < 0 || id >= lib_count)
+        return false;
+
+    const songlib_index_t *e = &lib_index[id];
+    entry->kind = (songlib_kind_t)e->kind;
+    entry->name = e->name;
+    entry->name_len = e->name_len;
+    entry->data = image + e->offset;
+    entry->length = e->length;
+    return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Liederbibliothek in der Datenpartition "songs" (siehe partitionTable.csv).
+ *
+ * Die Partition wird einmal in den Adressraum gemappt, Lieder werden direkt
+ * aus dem Flash gespielt: weder Index noch Notendaten belegen App-RAM.
+ * Erzeugt wird das Image von tools/songlib.py. Layout, little endian:
+ *
+ *   0x00  Header     songlib_header_t
+ *   0x10  Index      count x songlib_index_t, Eintrag i bei 0x10 + 36 * i
+ *   ...   Daten      je Lied, 4-Byte-ausgerichtet
+ *
+ * Ein Eintrag ist entweder ein gepackter Song (songfmt.h, 16-Bit-Wörter)
+ * oder ein Standard MIDI File (smf.h). Zugriff per Nummer ist O(1).
+ */
+
+#define SONGLIB_PARTITION_LABEL "songs"
+#define SONGLIB_PARTITION_SUBTYPE 0x40
+
+#define SONGLIB_MAGIC 0x4c534250 // "PBSL"
+#define SONGLIB_VERSION 1
+#define SONGLIB_NAME_LEN 24
+
+typedef enum
+{
+    SONGLIB_KIND_PACKED = 0,
+    SONGLIB_KIND_SMF = 1,
+} songlib_kind_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t index_off;
+    uint32_t size; // Bytes des ganzen Images
+} songlib_header_t;
+
+typedef struct
+{
+    uint32_t offset; // ab Anfang des Images
+    uint32_t length; // Bytes
+    uint8_t kind;    // songlib_kind_t
+    uint8_t name_len;
+    uint16_t reserved;
+    char name[SONGLIB_NAME_LEN]; // nicht nullterminiert
+} songlib_index_t;
+
+_Static_assert(sizeof(songlib_header_t) == 16, "songlib header layout");
+_Static_assert(sizeof(songlib_index_t) == 36, "songlib index layout");
+
+typedef struct
+{
+    songlib_kind_t kind;
+    const char *name;
+    uint8_t name_len;
+    const void *data; // im gemappten Flash
+    uint32_t length;
+} songlib_entry_t;
+
+/* Partition mappen und Header/Index prüfen; ohne gültige Bibliothek bleibt sie leer */
+void songlib_init(void);
+
+int songlib_count(void);
+
+/* Lied @id (0..songlib_count()-1) nachschlagen, O(1) */
+bool songlib_get(int id, songlib_entry_t *entry);
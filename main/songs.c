@@ -159,6 +159,9 @@ const tone_step_t ode_an_die_freude[] = {
 const int ode_an_die_freude_len =
     sizeof(ode_an_die_freude) / sizeof(tone_step_t);
 
+/* Getragen: weicher Einsatz, langes Ausklingen */
+const tone_env_t ode_an_die_freude_env = { 12, 80, 150, 60 };
+
 /* ================= Happy Birthday ================= */
 
 const tone_step_t melody_happy_birthday[] = {
@@ -178,6 +181,9 @@ const tone_step_t melody_happy_birthday[] = {
 const int melody_happy_birthday_len =
     sizeof(melody_happy_birthday) / sizeof(tone_step_t);
 
+/* Gesungen: kurzer Einsatz, kaum Abklingen */
+const tone_env_t melody_happy_birthday_env = { 8, 40, 200, 40 };
+
 /* ================= Hallelujah (Motiv) ================= */
 
 const tone_step_t melody_hallelujah_motif[] = {
@@ -195,6 +201,9 @@ const tone_step_t melody_hallelujah_motif[] = {
 const int melody_hallelujah_motif_len =
     sizeof(melody_hallelujah_motif) / sizeof(tone_step_t);
 
+/* Orgelartig: voller Ton bis zum Loslassen */
+const tone_env_t melody_hallelujah_motif_env = { 20, 0, 255, 80 };
+
     /* ==================== Alle meine Entchen ==================== */
 
 const tone_step_t alle_meine_entchen[] = {
@@ -218,3 +227,6 @@ const tone_step_t alle_meine_entchen[] = {
 
 const int alle_meine_entchen_len =
     sizeof(alle_meine_entchen) / sizeof(tone_step_t);
+
+/* Gezupft: knapper Einsatz (zwei Schwingungen bei E4), schnell auf halbe Lautstärke */
+const tone_env_t alle_meine_entchen_env = { 7, 120, 110, 30 };
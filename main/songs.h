@@ -8,6 +8,14 @@ typedef struct {
     uint32_t duration_ms;
 } tone_step_t;
 
+/* Hüllkurve eines Lieds für den Buzzer (envelope.h), Zeiten in ms */
+typedef struct {
+    uint8_t attack_ms;
+    uint8_t decay_ms;
+    uint8_t sustain;    // Pegel nach dem Decay, 255 = Spitze
+    uint8_t release_ms;
+} tone_env_t;
+
 /* ===== Mode Tones ===== */
 extern const tone_step_t beep_mode_tones[];
 extern const int beep_mode_len;
@@ -49,12 +57,16 @@ extern const int custom_boot_len;
 /* ===== Songs ===== */
 extern const tone_step_t ode_an_die_freude[];
 extern const int ode_an_die_freude_len;
+extern const tone_env_t ode_an_die_freude_env;
 
 extern const tone_step_t melody_happy_birthday[];
 extern const int melody_happy_birthday_len;
+extern const tone_env_t melody_happy_birthday_env;
 
 extern const tone_step_t melody_hallelujah_motif[];
 extern const int melody_hallelujah_motif_len;
+extern const tone_env_t melody_hallelujah_motif_env;
 
 extern const tone_step_t alle_meine_entchen[];
 extern const int alle_meine_entchen_len;
+extern const tone_env_t alle_meine_entchen_env;
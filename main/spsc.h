@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+
+/*
+ * Lock-freie Queue für genau einen Producer und einen Consumer.
+ *
+ * Für Kommandos zwischen Tasks auf verschiedenen Kernen: kein Mutex, kein
+ * kritischer Abschnitt, nur je ein atomarer Index pro Seite. head schreibt
+ * nur der Producer, tail nur der Consumer. Die Release-/Acquire-Paare sorgen
+ * dafür, dass der Inhalt eines Slots sichtbar ist, bevor der Index es ist.
+ *
+ * Blockiert nie: Aufwecken des Consumers (z.B. xTaskNotifyGive) ist Sache
+ * des Aufrufers.
+ */
+
+typedef struct
+{
+    uint8_t *buf;
+    size_t item_size;
+    uint32_t mask;     // Kapazität - 1, Kapazität ist eine Zweierpotenz
+    atomic_uint head;  // nächster Schreibplatz (Producer)
+    atomic_uint tail;  // nächster Leseplatz (Consumer)
+} spsc_t;
+
+/**
+ * spsc_init - Queue über @storage anlegen
+ * @storage: @capacity Einträge zu je @item_size Bytes
+ * @capacity: Zweierpotenz
+ *
+ * Nicht nebenläufig zu push/pop aufrufen.
+ */
+static inline void spsc_init(spsc_t *q, void *storage, size_t item_size, uint32_t capacity)
+{
+    q->buf = storage;
+    q->item_size = item_size;
+    q->mask = capacity - 1;
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+}
+
+/* Producer: false, wenn die Queue voll ist */
+static inline bool spsc_push(spsc_t *q, const void *item)
+{
+    unsigned head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+
+    if (head - tail > q->mask)
+        return false;
+
+    memcpy(q->buf + (head & q->mask) * q->item_size, item, q->item_size);
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return true;
+}
+
+/* Consumer: false, wenn die Queue leer ist */
+static inline bool spsc_pop(spsc_t *q, void *item)
+{
+    unsigned tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&q->head, memory_order_acquire);
+
+    if (head == tail)
+        return false;
+
+    memcpy(item, q->buf + (tail & q->mask) * q->item_size, q->item_size);
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+/* Von beiden Seiten aufrufbar, Momentaufnahme */
+static inline bool spsc_empty(spsc_t *q)
+{
+    return atomic_load_explicit(&q->head, memory_order_acquire) ==
+           atomic_load_explicit(&q->tail, memory_order_acquire);
+}
@@ -0,0 +1,249 @@
+#include <math.h>
+#include <string.h>
+
+#include "synth.h"
+#include "synth_kernel.h"
+#include "spsc.h"
+
+#define SYNTH_CMD_QUEUE_LEN 16
+
+typedef enum
+{
+    SYNTH_CMD_PLAY,
+    SYNTH_CMD_RELEASE,
+    SYNTH_CMD_STOP_ALL,
+} synth_cmd_type_t;
+
+typedef struct
+{
+    synth_cmd_type_t type;
+    synth_wave_t wave;
+    uint8_t level;
+    uint8_t key; // 0 = ohne Note-Off
+    uint32_t phase_inc;
+    uint32_t samples;
+} synth_cmd_t;
+
+typedef struct
+{
+    const int16_t *wave;
+    uint32_t phase;     // 32-Bit-Phasenakkumulator, obere Bits = Tabellenindex
+    uint32_t phase_inc; // freq * 2^32 / SYNTH_SAMPLE_RATE
+    uint32_t remaining; // Samples bis zum Ausblenden
+    int32_t env;        // aktuelle Hüllkurve, Q15
+    int32_t level;      // Ziel-Lautstärke, Q15
+    int32_t env_step;
+    uint8_t key;
+    bool active;
+} synth_voice_t;
+
+static int16_t wavetables[SYNTH_WAVE_COUNT][SYNTH_WAVE_LEN];
+static synth_voice_t voices[SYNTH_VOICES];
+static int32_t mix[SYNTH_BLOCK];
+static synth_cmd_t cmd_buf[SYNTH_CMD_QUEUE_LEN];
+static spsc_t synth_cmds;
+static void (*synth_wake)(void) = NULL;
+
+void synth_init(void)
+{
+    for (int i = 0; i < SYNTH_WAVE_LEN; i++)
+    {
+        float x = (float)i / SYNTH_WAVE_LEN;
+
+        wavetables[SYNTH_WAVE_SINE][i] = (int16_t)(32767.0f * sinf(2.0f * (float)M_PI * x));
+        wavetables[SYNTH_WAVE_SQUARE][i] = i < SYNTH_WAVE_LEN / 2 ? 32767 : -32767;
+        wavetables[SYNTH_WAVE_SAW][i] = (int16_t)(65535 * i / SYNTH_WAVE_LEN - 32767);
+        wavetables[SYNTH_WAVE_TRIANGLE][i] =
+            (int16_t)(i < SYNTH_WAVE_LEN / 2 ? 4 * 32767 * i / SYNTH_WAVE_LEN - 32767
+                                             : 3 * 32767 - 4 * 32767 * i / SYNTH_WAVE_LEN);
+    }
+
+    memset(voices, 0, sizeof(voices));
+    spsc_init(&synth_cmds, cmd_buf, sizeof(cmd_buf[0]), SYNTH_CMD_QUEUE_LEN);
+}
+
+static bool synth_post(const synth_cmd_t *cmd)
+{
+    bool ok = spsc_push(&synth_cmds, cmd);
+    if (ok && synth_wake)
+        synth_wake();
+    return ok;
+}
+
+bool synth_play(uint32_t freq_hz, uint32_t duration_ms, synth_wave_t wave, uint8_t level)
+{
+    return synth_note_on(0, freq_hz, duration_ms, wave, level);
+}
+
+bool synth_note_on(uint8_t key, uint32_t freq_hz, uint32_t max_ms, synth_wave_t wave, uint8_t level)
+{
+    synth_cmd_t cmd = {
+        .type = SYNTH_CMD_PLAY,
+        .wave = wave,
+        .level = level,
+        .key = key,
+        .phase_inc = (uint32_t)(((uint64_t)freq_hz << 32) / SYNTH_SAMPLE_RATE),
+        .samples = (uint32_t)((uint64_t)max_ms * SYNTH_SAMPLE_RATE / 1000),
+    };
+
+    return synth_post(&cmd);
+}
+
+bool synth_note_off(uint8_t key)
+{
+    synth_cmd_t cmd = {.type = SYNTH_CMD_RELEASE, .key = key};
+    return synth_post(&cmd);
+}
+
+void synth_stop_all(void)
+{
+    synth_cmd_t cmd = {.type = SYNTH_CMD_STOP_ALL};
+    synth_post(&cmd);
+}
+
+bool synth_pending(void)
+{
+    return !spsc_empty(&synth_cmds);
+}
+
+void synth_set_wake(void (*cb)(void))
+{
+    synth_wake = cb;
+}
+
+static synth_voice_t *synth_alloc_voice(void)
+{
+    synth_voice_t *victim = &voices[0];
+
+    for (int v = 0; v < SYNTH_VOICES; v++)
+    {
+        if (!voices[v].active)
+            return &voices[v];
+        if (voices[v].remaining < victim->remaining)
+            victim = &voices[v];
+    }
+
+    return victim;
+}
+
+static void synth_apply(const synth_cmd_t *cmd)
+{
+    if (cmd->type == SYNTH_CMD_STOP_ALL)
+    {
+        for (int v = 0; v < SYNTH_VOICES; v++)
+            voices[v].remaining = 0;
+        return;
+    }
+
+    if (cmd->type == SYNTH_CMD_RELEASE)
+    {
+        for (int v = 0; v < SYNTH_VOICES; v++)
+        {
+            if (voices[v].active && voices[v].key == cmd->key)
+                voices[v].remaining = 0;
+        }
+        return;
+    }
+
+    synth_voice_t *voice = synth_alloc_voice();
+
+    // Gestohlene Stimme nicht auf 0 springen lassen: Hüllkurve läuft weiter
+    if (!voice->active)
+    {
+        voice->env = 0;
+        voice->phase = 0;
+    }
+
+    voice->wave = synth_wavetable(cmd->wave);
+    voice->phase_inc = cmd->phase_inc;
+    voice->remaining = cmd->samples;
+    voice->key = cmd->key;
+    voice->level = (int32_t)cmd->level * 32767 / 255;
+    voice->env_step = voice->level / SYNTH_RAMP_SAMPLES + 1;
+    voice->active = true;
+}
+
+const int16_t *synth_wavetable(synth_wave_t wave)
+{
+    return wavetables[wave < SYNTH_WAVE_COUNT ? wave : SYNTH_WAVE_SINE];
+}
+
+/* Samples bis @dist bei Schrittweite @step, aufgerundet */
+static int synth_ramp_len(int32_t dist, int32_t step, int limit)
+{
+    int32_t len = (dist + step - 1) / step;
+    return len < limit ? (int)len : limit;
+}
+
+/*
+ * Eine Stimme in Abschnitten konstanter Steigung rendern: Einblenden,
+ * Halten, Ausblenden. Innerhalb eines Abschnitts läuft der Kernel ohne
+ * Verzweigung; die Hüllkurve wird nur an den Abschnittsgrenzen geprüft.
+ */
+static void synth_render_voice(synth_voice_t *voice, int n)
+{
+    int i = 0;
+
+    while (i < n && voice->active)
+    {
+        int len;
+        int32_t step;
+        int32_t target;
+
+        if (voice->remaining > 0)
+        {
+            int limit = voice->remaining < (uint32_t)(n - i) ? (int)voice->remaining : n - i;
+
+            // Auf die Ziel-Lautstärke rampen; gestohlene Stimmen können darüber liegen
+            target = voice->level;
+            step = voice->env < target ? voice->env_step : voice->env > target ? -voice->env_step : 0;
+            len = step ? synth_ramp_len(step > 0 ? target - voice->env : voice->env - target,
+                                        voice->env_step, limit)
+                       : limit;
+            voice->remaining -= (uint32_t)len;
+        }
+        else
+        {
+            target = 0;
+            step = -voice->env_step;
+            len = synth_ramp_len(voice->env, voice->env_step, n - i);
+        }
+
+        synth_osc_block(&mix[i], len, voice->wave, SYNTH_WAVE_BITS,
+                        &voice->phase, voice->phase_inc, voice->env, step);
+
+        voice->env += step * len;
+        if ((step > 0 && voice->env > target) || (step < 0 && voice->env < target))
+            voice->env = target;
+        if (voice->env == 0 && target == 0)
+            voice->active = false;
+        i += len;
+    }
+}
+
+int synth_render(int16_t *out, int n)
+{
+    synth_cmd_t cmd;
+    int active = 0;
+
+    while (spsc_pop(&synth_cmds, &cmd))
+        synth_apply(&cmd);
+
+    if (n > SYNTH_BLOCK)
+        n = SYNTH_BLOCK;
+
+    memset(mix, 0, (size_t)n * sizeof(mix[0]));
+
+    for (int v = 0; v < SYNTH_VOICES; v++)
+    {
+        if (!voices[v].active)
+            continue;
+
+        active++;
+        synth_render_voice(&voices[v], n);
+    }
+
+    synth_mix_block(out, mix, n);
+
+    return active;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Polyphoner Wavetable-Synth für den eingebauten DAC.
+ *
+ * Reiner Mixer ohne Hardwarezugriff: synth_play() legt nur ein Kommando in
+ * eine lock-freie SPSC-Queue (spsc.h) und darf deshalb nur aus einem Task
+ * aufgerufen werden (UI-Task). synth_render() läuft im Audio-Task (audio.c)
+ * bzw. auf dem Host im Simulator.
+ */
+
+#define SYNTH_SAMPLE_RATE 22050
+#define SYNTH_VOICES 8
+#define SYNTH_BLOCK 256 // Samples pro DMA-Puffer (11.6 ms)
+
+#define SYNTH_WAVE_BITS 8
+#define SYNTH_WAVE_LEN (1 << SYNTH_WAVE_BITS)
+
+/* Ein-/Ausblenden gegen Knackser, ~3 ms */
+#define SYNTH_RAMP_SAMPLES 64
+
+typedef enum
+{
+    SYNTH_WAVE_SINE = 0,
+    SYNTH_WAVE_SQUARE,
+    SYNTH_WAVE_SAW,
+    SYNTH_WAVE_TRIANGLE,
+    SYNTH_WAVE_COUNT
+} synth_wave_t;
+
+void synth_init(void);
+
+/**
+ * synth_play - Note auf einer freien Stimme starten
+ * @freq_hz: Frequenz in Hz
+ * @duration_ms: Dauer, danach wird ausgeblendet
+ * @wave: Wellenform
+ * @level: Lautstärke 0..255
+ *
+ * Ist keine Stimme frei, wird die mit der kürzesten Restdauer übernommen.
+ * Gibt false zurück, wenn die Kommando-Queue voll ist.
+ */
+bool synth_play(uint32_t freq_hz, uint32_t duration_ms, synth_wave_t wave, uint8_t level);
+
+/**
+ * synth_note_on - Note bis zum passenden synth_note_off() halten
+ * @key: Kennung der Note, z.B. MIDI-Notennummer + 1; nicht 0
+ * @max_ms: Sicherheitsgrenze, falls das Note-Off ausbleibt
+ *
+ * Sonst wie synth_play().
+ */
+bool synth_note_on(uint8_t key, uint32_t freq_hz, uint32_t max_ms, synth_wave_t wave, uint8_t level);
+
+/* Alle mit @key gestarteten Stimmen ausblenden */
+bool synth_note_off(uint8_t key);
+
+/* Wartet ein Kommando auf synth_render()? (Audio-Task im Leerlauf) */
+bool synth_pending(void);
+
+/**
+ * synth_set_wake - Rückruf nach jedem synth_play()/synth_stop_all()
+ *
+ * Weckt das Audio-Backend, z.B. per Task-Notification. Läuft im Kontext
+ * des Aufrufers.
+ */
+void synth_set_wake(void (*cb)(void));
+
+/* Wavetable mit SYNTH_WAVE_LEN Q15-Samples, gültig nach synth_init() */
+const int16_t *synth_wavetable(synth_wave_t wave);
+
+/* Alle Stimmen ausblenden */
+void synth_stop_all(void);
+
+/**
+ * synth_render - @n Samples mischen (Audio-Kontext)
+ * @out: vorzeichenbehaftete 16-Bit-Samples, mono
+ *
+ * Wendet zuerst alle wartenden Kommandos an. Gibt die Anzahl der Stimmen
+ * zurück, die in diesem Block aktiv waren.
+ */
+int synth_render(int16_t *out, int n);
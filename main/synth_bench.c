@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#include "synth.h"
+#include "synth_kernel.h"
+#include "synth_bench.h"
+
+#ifdef PLAYBOX_HOST
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "tsc"
+static inline uint64_t bench_cycles(void) { return __rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t bench_cycles(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif
+static uint64_t bench_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#else
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#define BENCH_UNIT "cyc"
+/* ccount läuft nach ~27 s bei 160 MHz über, ein Lauf ist deutlich kürzer */
+static inline uint64_t bench_cycles(void) { return esp_cpu_get_ccount(); }
+static uint64_t bench_ns(void) { return (uint64_t)esp_timer_get_time() * 1000ULL; }
+#endif
+
+static int32_t bench_acc[SYNTH_BLOCK];
+static int16_t bench_out[SYNTH_BLOCK];
+
+/* Verhindert, dass der Compiler die Ausgabe wegoptimiert */
+volatile int32_t synth_bench_sink;
+
+static void bench_voices(int voices)
+{
+    static const synth_wave_t waves[3] = {SYNTH_WAVE_SINE, SYNTH_WAVE_SQUARE, SYNTH_WAVE_SAW};
+    uint32_t phase[SYNTH_VOICES];
+    uint32_t inc[SYNTH_VOICES];
+
+    for (int v = 0; v < voices; v++)
+    {
+        phase[v] = 0;
+        inc[v] = (uint32_t)(((uint64_t)(220 + 110 * v) << 32) / SYNTH_SAMPLE_RATE);
+    }
+
+    uint64_t ns0 = bench_ns();
+    uint32_t c0 = (uint32_t)bench_cycles();
+    uint64_t cycles = 0;
+
+    for (int b = 0; b < SYNTH_BENCH_BLOCKS; b++)
+    {
+        for (int i = 0; i < SYNTH_BLOCK; i++)
+            bench_acc[i] = 0;
+
+        for (int v = 0; v < voices; v++)
+        {
+            // Jede dritte Stimme mit Rampe, damit beide Kernel-Pfade zählen
+            synth_osc_block(bench_acc, SYNTH_BLOCK, synth_wavetable(waves[v % 3]), SYNTH_WAVE_BITS,
+                            &phase[v], inc[v], 8000, v % 3 == 2 ? 1 : 0);
+        }
+
+        synth_mix_block(bench_out, bench_acc, SYNTH_BLOCK);
+        synth_bench_sink += bench_out[b % SYNTH_BLOCK];
+
+        // In kurzen Stücken aufsummieren, 32-Bit-ccount darf nicht überlaufen
+        uint32_t c1 = (uint32_t)bench_cycles();
+        cycles += (uint32_t)(c1 - c0);
+        c0 = c1;
+    }
+
+    uint64_t ns = bench_ns() - ns0;
+    uint64_t samples = (uint64_t)SYNTH_BENCH_BLOCKS * SYNTH_BLOCK;
+    double per_sample = (double)cycles / (double)samples;
+
+    printf("synth_bench voices=%d samples=%llu samples_per_s=%.0f " BENCH_UNIT "_per_sample=%.2f "
+           BENCH_UNIT "_per_voice_sample=%.2f realtime_x=%.1f\n",
+           voices, (unsigned long long)samples,
+           ns ? (double)samples * 1e9 / (double)ns : 0.0,
+           per_sample, per_sample / voices,
+           ns ? (double)samples * 1e9 / (double)ns / SYNTH_SAMPLE_RATE : 0.0);
+}
+
+void synth_bench_run(void)
+{
+    synth_init();
+
+    for (int voices = 1; voices <= SYNTH_VOICES; voices *= 2)
+        bench_voices(voices);
+}
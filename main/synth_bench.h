@@ -0,0 +1,15 @@
+#pragma once
+
+/*
+ * Durchsatz-Benchmark für den Synth-Kernel (synth_kernel.h).
+ *
+ * Rendert für 1, 2, 4 und 8 Stimmen jeweils SYNTH_BENCH_BLOCKS Blöcke und
+ * gibt Samples pro Sekunde sowie Zyklen pro Sample und pro Stimme aus.
+ * Auf dem Target zählt esp_cpu_get_ccount(), auf dem Host der TSC (x86)
+ * bzw. Nanosekunden. Host: Programm synth_bench. Target: mit
+ * -DPLAYBOX_SYNTH_BENCH=1 bauen, dann läuft er einmal beim Start.
+ */
+
+#define SYNTH_BENCH_BLOCKS 2000
+
+void synth_bench_run(void);
@@ -0,0 +1,37 @@
+#include "esp_attr.h"
+
+#include "synth_kernel.h"
+
+/* Im IRAM, damit Flash-Cache-Misses den Audio-Task nicht ausbremsen */
+IRAM_ATTR void synth_osc_block(int32_t *restrict acc, int n, const int16_t *restrict table, int wave_bits,
+                               uint32_t *phase, uint32_t inc, int32_t gain, int32_t gain_step)
+{
+    const int shift = 32 - wave_bits;
+    uint32_t p = *phase;
+
+    if (gain_step == 0)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            acc[i] += (table[p >> shift] * gain) >> 15;
+            p += inc;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < n; i++)
+        {
+            acc[i] += (table[p >> shift] * gain) >> 15;
+            p += inc;
+            gain += gain_step;
+        }
+    }
+
+    *phase = p;
+}
+
+IRAM_ATTR void synth_mix_block(int16_t *restrict out, const int32_t *restrict acc, int n)
+{
+    for (int i = 0; i < n; i++)
+        out[i] = synth_sat16(acc[i]);
+}
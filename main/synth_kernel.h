@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Block-Kernel des Synths: reine Schleifen ohne Verzweigungen im Inneren,
+ * damit der Compiler sie abrollen kann (Xtensa: Zero-Overhead-Loops,
+ * MULL/CLAMPS; Host: SIMD).
+ *
+ * Formate:
+ *   Phase   32 Bit, Tabellenindex in den oberen SYNTH_WAVE_BITS Bits
+ *   Samples Q15
+ *   Gain    Q15, pro Sample um gain_step verändert (Hüllkurven-Rampe)
+ *   Akku    int32, erst beim Mischen auf 16 Bit gesättigt
+ */
+
+/**
+ * synth_osc_block - eine Stimme auf den Akku addieren
+ * @acc: Mischakku, @n Werte
+ * @table: Wavetable mit (1 << @wave_bits) Einträgen
+ * @phase: Phasenakkumulator, wird fortgeschrieben
+ * @inc: Phaseninkrement pro Sample
+ * @gain: Gain des ersten Samples (Q15)
+ * @gain_step: Änderung pro Sample, 0 für konstante Lautstärke
+ */
+void synth_osc_block(int32_t *restrict acc, int n, const int16_t *restrict table, int wave_bits,
+                     uint32_t *phase, uint32_t inc, int32_t gain, int32_t gain_step);
+
+/**
+ * synth_mix_block - Akku gesättigt nach 16 Bit schreiben
+ */
+void synth_mix_block(int16_t *restrict out, const int32_t *restrict acc, int n);
+
+/* Sättigung auf int16 ohne Sprung (Xtensa: CLAMPS) */
+static inline int16_t synth_sat16(int32_t s)
+{
+    s = s < -32768 ? -32768 : s;
+    s = s > 32767 ? 32767 : s;
+    return (int16_t)s;
+}
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""Generate the LEDC timer settings for all 128 MIDI notes.
+
+Usage: notetable.py OUT_C
+
+For every note (A4 = 69 = 440 Hz, equal temperament) pick the duty
+resolution and the 10.8 fixed-point clock divider of the buzzer timer that
+come closest to the exact pitch. See main/note_timer.h for the layout and
+the limits; note_timer_calc() applies the same rule at runtime for other
+frequencies.
+"""
+
+import argparse
+import math
+import sys
+
+# Muss zu main/note_timer.h passen
+CLK_HZ = 80000000
+RES_MIN = 10
+RES_MAX = 15
+DIV_MIN = 0x100
+DIV_MAX = 0x3FFFF
+NOTES = 128
+
+
+def note_freq(note):
+    return 440.0 * 2.0 ** ((note - 69) / 12.0)
+
+
+def timer_freq(div, res):
+    return CLK_HZ * 256.0 / (div * (1 << res))
+
+
+def cents(a, b):
+    return 1200.0 * math.log2(a / b)
+
+
+def best_timer(freq):
+    """Return (div, res, pitch error in cents); ties go to the lower resolution."""
+    best = None
+    for res in range(RES_MIN, RES_MAX + 1):
+        div = int(math.floor(CLK_HZ * 256.0 / (freq * (1 << res)) + 0.5))
+        if div < DIV_MIN or div > DIV_MAX:
+            continue
+        err = cents(timer_freq(div, res), freq)
+        if best is None or abs(err) < abs(best[2]):
+            best = (div, res, err)
+    if best is None:
+        raise ValueError("%.3f Hz has no valid divider" % freq)
+    return best
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("out_c")
+    args = ap.parse_args()
+
+    rows = []
+    for note in range(NOTES):
+        try:
+            rows.append((note,) + best_timer(note_freq(note)))
+        except ValueError as e:
+            sys.exit("notetable: note %d: %s" % (note, e))
+
+    worst = max(abs(err) for _, _, _, err in rows)
+    with open(args.out_c, "w", encoding="utf-8") as c:
+        c.write("/* Generated by tools/notetable.py - do not edit */\n")
+        c.write("/* max pitch error %.3f cents */\n\n" % worst)
+        c.write("#include \"note_timer.h\"\n\n")
+        c.write("const note_timer_t note_timers[NOTE_TIMER_NOTES] = {\n")
+        for note, div, res, err in rows:
+            c.write("    {0x%05x, %5d, %2d}, /* %3d: %10.3f Hz, %+.3f cents */\n"
+                    % (div, int(timer_freq(div, res)), res, note, note_freq(note), err))
+        c.write("};\n")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
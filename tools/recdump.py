@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+"""Extract the last BeepMode recording from an NVS partition dump.
+
+Usage: recdump.py NVS_BIN [-o OUT_BIN] [--list]
+
+NVS_BIN is the raw "nvs" partition, e.g. from
+
+  parttool.py read_partition --partition-name nvs --output nvs.bin
+
+OUT_BIN receives the recording image of main/recorder.h (header plus
+events), which playbox_sim --rec replays as button presses in the record
+scenario. --list prints the presses with their time since the recording
+started.
+
+Only the parts of the NVS page format (ESP-IDF v4, multi-page blobs) that
+main/recorder.c writes are understood: blob data chunks plus their index,
+and the namespace table.
+"""
+
+import argparse
+import struct
+import sys
+
+# Muss zu main/recorder.h passen
+NAMESPACE = b"rec"
+MAGIC = 0x43455250
+VERSION = 1
+HEADER = struct.Struct("<IHHII")
+BUTTONS = 16
+BUTTON_NAMES = ["P1 top", "P1 down", "P1 left", "P1 right", "P1 fire",
+                "P2 top", "P2 down", "P2 left", "P2 right", "P2 fire",
+                "P3 buzzer", "P4 buzzer", "P5 buzzer", "P6 buzzer",
+                "P7 buzzer", "P8 buzzer"]
+
+# NVS-Seitenformat
+PAGE_SIZE = 4096
+ENTRY_SIZE = 32
+ENTRIES = 126
+ENTRIES_OFF = 64
+PAGE_ACTIVE = 0xFFFFFFFE
+PAGE_FULL = 0xFFFFFFFC
+PAGE_FREEING = 0xFFFFFFF8
+ENTRY_WRITTEN = 2
+TYPE_U8 = 0x01
+TYPE_BLOB_DATA = 0x42
+TYPE_BLOB_IDX = 0x48
+
+
+def entry_state(page, i):
+    return (page[32 + i // 4] >> ((i % 4) * 2)) & 3
+
+
+def read_items(data):
+    """Yield (ns, type, chunk, key, payload) of all written items, oldest page first."""
+    pages = []
+    for off in range(0, len(data) - PAGE_SIZE + 1, PAGE_SIZE):
+        page = data[off:off + PAGE_SIZE]
+        state, seq = struct.unpack_from("<II", page, 0)
+        if state in (PAGE_ACTIVE, PAGE_FULL, PAGE_FREEING):
+            pages.append((seq, page))
+
+    for _, page in sorted(pages, key=lambda p: p[0]):
+        i = 0
+        while i < ENTRIES:
+            if entry_state(page, i) != ENTRY_WRITTEN:
+                i += 1
+                continue
+            item = page[ENTRIES_OFF + i * ENTRY_SIZE:ENTRIES_OFF + (i + 1) * ENTRY_SIZE]
+            ns, typ, span, chunk = item[0], item[1], item[2], item[3]
+            key = item[8:24].split(b"\0", 1)[0]
+            span = max(span, 1)
+            payload = item[24:32]
+            if typ == TYPE_BLOB_DATA:
+                size = struct.unpack_from("<H", payload, 0)[0]
+                start = ENTRIES_OFF + (i + 1) * ENTRY_SIZE
+                payload = page[start:start + size]
+            yield ns, typ, chunk, key, payload
+            i += span
+
+
+def read_blobs(data, namespace):
+    """Return {key: bytes} of all blobs in NAMESPACE."""
+    items = list(read_items(data))
+    ns_index = None
+    for ns, typ, _, key, payload in items:
+        if ns == 0 and typ == TYPE_U8 and key == namespace:
+            ns_index = payload[0]
+    if ns_index is None:
+        return {}
+
+    index = {}
+    chunks = {}
+    for ns, typ, chunk, key, payload in items:
+        if ns != ns_index:
+            continue
+        if typ == TYPE_BLOB_IDX:
+            size, count, start = struct.unpack_from("<IBB", payload, 0)
+            index[key] = (size, count, start)
+        elif typ == TYPE_BLOB_DATA:
+            chunks[(key, chunk)] = payload
+
+    blobs = {}
+    for key, (size, count, start) in index.items():
+        parts = [chunks.get((key, start + c)) for c in range(count)]
+        if None not in parts:
+            blob = b"".join(parts)
+            if len(blob) == size:
+                blobs[key] = blob
+    return blobs
+
+
+def decode(events):
+    """Yield (delta_ticks, button) from the LEB128 event bytes."""
+    pos = 0
+    while pos < len(events):
+        value = shift = 0
+        while True:
+            if pos >= len(events) or shift > 28:
+                raise ValueError("truncated event at byte %d" % pos)
+            b = events[pos]
+            pos += 1
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                break
+        if value & 15 >= BUTTONS:
+            raise ValueError("bad button %d" % (value & 15))
+        yield value >> 4, value & 15
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("nvs_bin")
+    ap.add_argument("-o", "--out")
+    ap.add_argument("--list", action="store_true")
+    args = ap.parse_args()
+
+    with open(args.nvs_bin, "rb") as f:
+        blobs = read_blobs(f.read(), NAMESPACE)
+
+    hdr = blobs.get(b"hdr")
+    if hdr is None or len(hdr) != HEADER.size:
+        sys.exit("recdump: no recording in %s" % args.nvs_bin)
+    magic, version, count, size, tick_us = HEADER.unpack(hdr)
+    if magic != MAGIC or version != VERSION:
+        sys.exit("recdump: unknown recording format")
+
+    events = b""
+    c = 0
+    while len(events) < size:
+        chunk = blobs.get(b"c%d" % c)
+        if chunk is None:
+            sys.exit("recdump: chunk c%d missing" % c)
+        events += chunk
+        c += 1
+    events = events[:size]
+
+    try:
+        presses = list(decode(events))
+    except ValueError as e:
+        sys.exit("recdump: %s" % e)
+    if len(presses) != count:
+        sys.exit("recdump: %d events, header says %d" % (len(presses), count))
+
+    print("recording: %d presses, %d bytes (%.2f B/press), tick %d us"
+          % (count, size, size / count if count else 0.0, tick_us))
+
+    if args.list:
+        t = 0
+        for delta, button in presses:
+            t += delta * tick_us
+            print("%10.3f ms  %s" % (t / 1000.0, BUTTON_NAMES[button]))
+
+    if args.out:
+        with open(args.out, "wb") as f:
+            f.write(hdr + events)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
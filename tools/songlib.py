@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+"""Build the song library image for the "songs" flash partition.
+
+Usage: songlib.py OUT_BIN --songs SONGS_C [--song NAME ...] [--smf NAME ...]
+                  [--max-size N] [FILE.mid ...]
+
+Layout (little endian, see main/songlib.h):
+
+  0x00  header  magic "PBSL", u16 version, u16 count, u32 index_off, u32 size
+  0x10  index   count x 36 bytes: u32 offset, u32 length, u8 kind,
+                u8 name_len, u16 reserved, char name[24]
+  ...   data    one blob per song, 4-byte aligned
+
+--song NAME stores the tone_step_t table NAME from songs.c in the packed
+16-bit format of tools/songpack.py (kind 0), with NAME_env as its envelope
+if songs.c defines one. FILE.mid is validated and
+stored as is (kind 1), named after the file.
+
+--smf NAME converts the table NAME into a Standard MIDI File (kind 1), for
+testing the SMF player against the original table. The generated files
+alternate between two shapes:
+
+  even index: format 1, separate conductor track whose tempo switches
+              between 480000 and 240000 us/quarter every 8 steps,
+              note-off as note-on with velocity 0 under running status
+  odd index:  format 0, constant tempo, explicit 0x80 note-offs, plus a
+              program change, a GM-on sysex and a drum-channel hit that
+              the player has to skip
+
+Division is 480, so one tick is exactly 1 ms (or 0.5 ms) and the durations
+of songs.c survive the round trip unchanged. Pitches are rounded to the
+nearest MIDI note.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+from songpack import MAX_CENTS_DEFAULT, STEP_RE, TABLE_RE, note_hz, pack, read_envelopes
+
+MAGIC = 0x4C534250  # "PBSL"
+VERSION = 1
+HEADER = struct.Struct("<IHHII")
+INDEX = struct.Struct("<IIBBH24s")
+KIND_PACKED = 0
+KIND_SMF = 1
+
+DIVISION = 480
+TEMPO_SLOW = 480000  # 1 tick = 1 ms
+TEMPO_FAST = 240000  # 1 tick = 0.5 ms
+TEMPO_EVERY = 8      # Schritte pro Tempo-Abschnitt (Format 1)
+VELOCITY = 100
+DRUM_CHANNEL = 9
+
+
+def vlq(n):
+    out = [n & 0x7F]
+    n >>= 7
+    while n:
+        out.append(0x80 | (n & 0x7F))
+        n >>= 7
+    return bytes(reversed(out))
+
+
+def meta(kind, data):
+    return bytes([0xFF, kind]) + vlq(len(data)) + data
+
+
+def tempo_meta(us):
+    return meta(0x51, struct.pack(">I", us)[1:])
+
+
+def chunk(kind, data):
+    return kind + struct.pack(">I", len(data)) + data
+
+
+def track(events, end):
+    """events: (tick, bytes) in time order; End-of-Track at tick @end."""
+    out = bytearray()
+    now = 0
+    for tick, data in events:
+        out += vlq(tick - now) + data
+        now = tick
+    return chunk(b"MTrk", bytes(out) + vlq(end - now) + meta(0x2F, b""))
+
+
+def smf(fmt, tracks):
+    return chunk(b"MThd", struct.pack(">HHH", fmt, len(tracks), DIVISION)) + b"".join(tracks)
+
+
+def nearest_note(hz):
+    return min(range(1, 128), key=lambda n: abs(note_hz(n) - hz))
+
+
+def song_to_smf(name, steps, index):
+    steps = [(hz, ms) for hz, ms in steps if ms > 0]
+
+    if index % 2 == 0:
+        conductor = [(0, meta(0x03, name.encode()))]
+        notes = []
+        tick = 0
+        for i, (hz, ms) in enumerate(steps):
+            tempo = TEMPO_SLOW if (i // TEMPO_EVERY) % 2 == 0 else TEMPO_FAST
+            if i % TEMPO_EVERY == 0:
+                conductor.append((tick, tempo_meta(tempo)))
+            end = tick + ms * TEMPO_SLOW // tempo
+            if hz:
+                n = nearest_note(hz)
+                # Erstes Note-On mit Statusbyte, danach Running Status
+                notes.append((tick, (b"" if notes else b"\x90") + bytes([n, VELOCITY])))
+                notes.append((end, bytes([n, 0])))
+            tick = end
+        return smf(1, [track(conductor, tick), track(notes, tick)])
+
+    events = [
+        (0, meta(0x03, name.encode())),
+        (0, tempo_meta(TEMPO_SLOW)),
+        (0, b"\xC0\x00"),                                   # Program Change
+        (0, b"\xF0" + vlq(5) + b"\x7E\x7F\x09\x01\xF7"),    # GM On, wird übersprungen
+        (0, bytes([0x90 | DRUM_CHANNEL, 36, VELOCITY])),
+        (10, bytes([0x80 | DRUM_CHANNEL, 36, 64])),
+    ]
+    tick = 0
+    for hz, ms in steps:
+        if hz:
+            n = nearest_note(hz)
+            events.append((tick, bytes([0x90, n, VELOCITY])))
+            events.append((tick + ms, bytes([0x80, n, 64])))
+        tick += ms
+    events.sort(key=lambda e: e[0])  # stabil: Note-Off vor Note-On am selben Tick
+    return smf(0, [track(events, tick)])
+
+
+def read_tables(path):
+    with open(path, encoding="utf-8") as f:
+        src = f.read()
+    tables = {}
+    for name, body in TABLE_RE.findall(src):
+        body = re.sub(r"//[^\n]*|/\*.*?\*/", "", body, flags=re.S)
+        tables[name] = [(int(hz), int(ms)) for hz, ms in STEP_RE.findall(body)]
+    return tables, read_envelopes(src)
+
+
+def check_smf(data, path):
+    if len(data) < 14 or data[:4] != b"MThd":
+        sys.exit("songlib: %s is not a Standard MIDI File" % path)
+    fmt, ntracks, division = struct.unpack(">HHH", data[8:14])
+    if fmt > 1 or division & 0x8000:
+        sys.exit("songlib: %s: format %d / SMPTE timing not supported" % (path, fmt))
+    if ntracks > 16:
+        sys.exit("songlib: %s: %d tracks, the player handles 16" % (path, ntracks))
+
+
+def build(entries):
+    """entries: (name, kind, blob) -> image bytes"""
+    index_off = HEADER.size
+    offset = index_off + INDEX.size * len(entries)
+    index = bytearray()
+    data = bytearray()
+
+    for name, kind, blob in entries:
+        raw = name.encode()[:24]
+        pad = (-(offset + len(data))) % 4
+        data += b"\0" * pad
+        index += INDEX.pack(offset + len(data), len(blob), kind, len(raw), 0, raw)
+        data += blob
+
+    size = offset + len(data)
+    return HEADER.pack(MAGIC, VERSION, len(entries), index_off, size) + bytes(index) + bytes(data)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("out_bin")
+    ap.add_argument("files", nargs="*")
+    ap.add_argument("--songs", help="songs.c with the tone_step_t tables")
+    ap.add_argument("--song", action="append", default=[], help="table to store packed")
+    ap.add_argument("--smf", action="append", default=[], help="table to store as SMF")
+    ap.add_argument("--max-size", type=lambda s: int(s, 0), default=512 * 1024)
+    args = ap.parse_args()
+
+    entries = []
+
+    if args.song or args.smf:
+        if not args.songs:
+            sys.exit("songlib: --song/--smf need --songs")
+        tables, envs = read_tables(args.songs)
+        for name in args.song + args.smf:
+            if name not in tables:
+                sys.exit("songlib: no table %s in %s" % (name, args.songs))
+
+        for name in args.song:
+            try:
+                words, _ = pack(tables[name], MAX_CENTS_DEFAULT, envs.get(name))
+            except ValueError as e:
+                sys.exit("songlib: %s: %s" % (name, e))
+            if len(words) > 0xFFFF:
+                sys.exit("songlib: %s: more than 65535 words" % name)
+            entries.append((name, KIND_PACKED, struct.pack("<%dH" % len(words), *words)))
+
+        for i, name in enumerate(args.smf):
+            entries.append((name, KIND_SMF, song_to_smf(name, tables[name], i)))
+
+    for path in sorted(args.files):
+        with open(path, "rb") as f:
+            data = f.read()
+        check_smf(data, path)
+        entries.append((os.path.splitext(os.path.basename(path))[0], KIND_SMF, data))
+
+    if len(entries) > 0xFFFF:
+        sys.exit("songlib: too many songs")
+
+    image = build(entries)
+    if len(image) > args.max_size:
+        sys.exit("songlib: image is %d bytes, partition has %d" % (len(image), args.max_size))
+
+    with open(args.out_bin, "wb") as f:
+        f.write(image)
+
+    print("songlib: %d songs, %d bytes" % (len(entries), len(image)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
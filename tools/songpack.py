@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""Convert the tone_step_t tables in main/songs.c into the packed song format.
+
+Usage: songpack.py SONGS_C OUT_C OUT_H [--max-cents N]
+
+Every `const tone_step_t NAME[] = { {hz, ms}, ... };` becomes
+`const song_t NAME_song` in OUT_C/OUT_H. See main/songfmt.h for the format:
+one 16-bit word per step (7-bit MIDI note, 9-bit duration in units) after a
+one-word tempo header holding the unit length in ms.
+
+A `const tone_env_t NAME_env = { attack, decay, sustain, release };` next to
+table NAME adds the buzzer envelope: header bit 15 set, two words follow.
+
+Frequencies within --max-cents (default 5, below what the ear can tell
+from the table) of an equal-tempered note are stored as that note; anything
+further off keeps its exact Hz via the raw escape word, so packing does not
+change how a song sounds. A larger --max-cents snaps more notes and saves the
+escape words, at the cost of moving authored pitches: opt in explicitly.
+"""
+
+import argparse
+import math
+import re
+import sys
+from functools import reduce
+
+NOTE_SHIFT = 9
+DUR_MAX = 0x1FF
+NOTE_REST = 0
+NOTE_RAW_HZ = 127
+HDR_ENV = 0x8000
+HDR_UNIT_MAX = 0x0FFF
+MAX_CENTS_DEFAULT = 5.0  # wie im Docstring, auch für tools/songlib.py
+
+TABLE_RE = re.compile(r"const\s+tone_step_t\s+(\w+)\s*\[\s*\]\s*=\s*\{(.*?)\};", re.S)
+STEP_RE = re.compile(r"\{\s*(\d+)\s*,\s*(\d+)\s*\}")
+ENV_RE = re.compile(r"const\s+tone_env_t\s+(\w+)_env\s*=\s*"
+                    r"\{\s*(\d+)\s*,\s*(\d+)\s*,\s*(\d+)\s*,\s*(\d+)\s*\}\s*;")
+
+
+def note_hz(note):
+    # Muss zu note_hz[] in main/songfmt.c passen
+    return int(math.floor(440.0 * 2.0 ** ((note - 69) / 12.0) + 0.5))
+
+
+def cents(a, b):
+    return abs(1200.0 * math.log2(a / b))
+
+
+def encode_pitch(hz, max_cents):
+    """Return (note, raw_hz or None, pitch error in cents)."""
+    if hz == 0:
+        return NOTE_REST, None, 0.0
+
+    best = min(range(1, NOTE_RAW_HZ), key=lambda n: abs(note_hz(n) - hz))
+    err = cents(hz, note_hz(best))
+    if err <= max_cents:
+        return best, None, err
+
+    if hz > 0xFFFF:
+        raise ValueError("frequency %d Hz does not fit the raw escape" % hz)
+    return NOTE_RAW_HZ, hz, 0.0
+
+
+def read_envelopes(src):
+    """NAME -> (attack, decay, sustain, release) aus den tone_env_t NAME_env"""
+    envs = {}
+    for name, *values in ENV_RE.findall(src):
+        values = tuple(int(v) for v in values)
+        if max(values) > 255:
+            sys.exit("songpack: %s_env: values must fit 8 bits" % name)
+        envs[name] = values
+    return envs
+
+
+def pack(steps, max_cents, env=None):
+    unit = reduce(math.gcd, (ms for _, ms in steps if ms), 0) or 1
+    if max(ms for _, ms in steps) // unit > DUR_MAX:
+        raise ValueError("duration does not fit %d units of %d ms" % (DUR_MAX, unit))
+    if unit > HDR_UNIT_MAX:
+        raise ValueError("unit %d ms does not fit the header" % unit)
+
+    words = [unit]
+    if env is not None:
+        attack, decay, sustain, release = env
+        words = [unit | HDR_ENV, (attack << 8) | decay, (sustain << 8) | release]
+    worst = 0.0
+    for hz, ms in steps:
+        note, raw, err = encode_pitch(hz, max_cents)
+        worst = max(worst, err)
+        words.append((note << NOTE_SHIFT) | (ms // unit))
+        if raw is not None:
+            words.append(raw)
+
+    return words, worst
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("songs_c")
+    ap.add_argument("out_c")
+    ap.add_argument("out_h")
+    ap.add_argument("--max-cents", type=float, default=MAX_CENTS_DEFAULT)
+    args = ap.parse_args()
+
+    with open(args.songs_c, encoding="utf-8") as f:
+        src = f.read()
+
+    envs = read_envelopes(src)
+    tables = []
+    for name, body in TABLE_RE.findall(src):
+        # Kommentare entfernen, damit "{ 0, 150 }" in Kommentaren nicht zählt
+        body = re.sub(r"//[^\n]*|/\*.*?\*/", "", body, flags=re.S)
+        steps = [(int(hz), int(ms)) for hz, ms in STEP_RE.findall(body)]
+        if not steps:
+            sys.exit("songpack: %s has no steps" % name)
+        try:
+            words, worst = pack(steps, args.max_cents, envs.get(name))
+        except ValueError as e:
+            sys.exit("songpack: %s: %s" % (name, e))
+        tables.append((name, steps, words, worst))
+
+    if not tables:
+        sys.exit("songpack: no tone_step_t tables found in %s" % args.songs_c)
+
+    raw_bytes = sum(8 * len(steps) for _, steps, _, _ in tables)
+    packed_bytes = sum(2 * len(words) for _, _, words, _ in tables)
+
+    with open(args.out_h, "w", encoding="utf-8") as h:
+        h.write("/* Generated by tools/songpack.py from songs.c - do not edit */\n")
+        h.write("#pragma once\n\n#include \"songfmt.h\"\n\n")
+        for name, _, _, _ in tables:
+            h.write("extern const song_t %s_song;\n" % name)
+
+    with open(args.out_c, "w", encoding="utf-8") as c:
+        c.write("/* Generated by tools/songpack.py from songs.c - do not edit */\n")
+        c.write("/* tone_step_t: %d bytes, packed: %d bytes */\n\n" % (raw_bytes, packed_bytes))
+        c.write("#include \"songs_packed.h\"\n")
+        for name, steps, words, worst in tables:
+            c.write("\n/* %s: %d steps, %d ms unit, max pitch error %.1f cents%s */\n"
+                    % (name, len(steps), words[0] & HDR_UNIT_MAX, worst,
+                       ", envelope %d/%d/%d/%d" % envs[name] if name in envs else ""))
+            c.write("static const uint16_t %s_data[] = {\n" % name)
+            for i in range(0, len(words), 8):
+                c.write("    " + ", ".join("0x%04x" % w for w in words[i:i + 8]) + ",\n")
+            c.write("};\n")
+            c.write("const song_t %s_song = {%s_data, %d};\n" % (name, name, len(words)))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())